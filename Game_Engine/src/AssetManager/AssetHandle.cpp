@@ -0,0 +1,37 @@
+#include "AssetHandle.h"
+#include "../Logger/Logger.h"
+#include <unordered_map>
+
+// Never cleared, an asset ID takes a few bytes and a level uses a few dozen of them
+static std::unordered_map<AssetHandle, std::string>& GetAssetIDs() {
+	static std::unordered_map<AssetHandle, std::string> assetIDs;
+	return assetIDs;
+}
+
+AssetHandle GetAssetHandle(const std::string& assetID) {
+	// the components that are resized or default constructed have no asset, they don't go through the table
+	if (assetID.empty()) {
+		return NO_ASSET_HANDLE;
+	}
+
+	AssetHandle assetHandle = 14695981039346656037ULL;
+	for (char c : assetID) {
+		assetHandle = (assetHandle ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+	}
+
+	auto& assetIDs = GetAssetIDs();
+	const auto assetIDFound = assetIDs.find(assetHandle);
+	if (assetIDFound == assetIDs.end()) {
+		assetIDs.emplace(assetHandle, assetID);
+	} else if (assetIDFound->second != assetID) {
+		Logger::Err("The asset IDs " + assetIDFound->second + " and " + assetID + " have the same handle, rename one of them");
+	}
+	return assetHandle;
+}
+
+const std::string& GetAssetID(AssetHandle assetHandle) {
+	static const std::string noAssetID;
+	const auto& assetIDs = GetAssetIDs();
+	const auto assetIDFound = assetIDs.find(assetHandle);
+	return assetIDFound != assetIDs.end() ? assetIDFound->second : noAssetID;
+}
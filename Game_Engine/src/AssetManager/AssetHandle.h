@@ -0,0 +1,19 @@
+#ifndef ASSETHANDLE_H
+#define ASSETHANDLE_H
+
+#include <cstdint>
+#include <string>
+
+// An asset ID interned as the FNV-1a hash of its name. Components store it instead of the string,
+// so they stay plain data, and it is the same in every run, so the saved snapshots and replays keep working.
+typedef uint64_t AssetHandle;
+// The handle of the empty asset ID
+const AssetHandle NO_ASSET_HANDLE = 0;
+
+// Remembers the name of the handle, the textures and the sprites call it when they are created
+AssetHandle GetAssetHandle(const std::string& assetID);
+
+// The asset ID that the handle was interned from, empty when it never was
+const std::string& GetAssetID(AssetHandle assetHandle);
+
+#endif // !ASSETHANDLE_H
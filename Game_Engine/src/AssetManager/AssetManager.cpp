@@ -1,5 +1,7 @@
 #include "AssetManager.h"
+#include "AssetHandle.h"
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 #include "SDL_image.h"
 
 AssetManager::AssetManager() {
@@ -16,6 +18,29 @@ void AssetManager::ClearAssets() {
 		SDL_DestroyTexture(texture.second);
 	}
 	textures.clear();
+	texturePaths.clear();
+
+	// the atlases keep a pointer to their font, so they go first
+	glyphAtlases.clear();
+	for (auto font : fonts) {
+		TTF_CloseFont(font.second);
+	}
+	fonts.clear();
+
+	for (auto soundEffect : soundEffects) {
+		Mix_FreeChunk(soundEffect.second);
+	}
+	soundEffects.clear();
+
+	for (auto track : music) {
+		Mix_FreeMusic(track.second);
+	}
+	music.clear();
+
+	for (auto& reloadedAsset : pendingReloads) {
+		SDL_FreeSurface(reloadedAsset.surface);
+	}
+	pendingReloads.clear();
 }
 
 void AssetManager::AddTexture(SDL_Renderer* renderer, const std::string& assetID, const std::string& filePath) {
@@ -23,12 +48,125 @@ void AssetManager::AddTexture(SDL_Renderer* renderer, const std::string& assetID
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
 
-	// add the texture to the map
+	// add the texture to the map, its ID is interned so the sprites of a snapshot from another run find it
 	textures.emplace(assetID, texture);
+	GetAssetHandle(assetID);
+	texturePaths.emplace(assetID, AssetWatcher::NormalizePath(filePath));
 
 	Logger::Log("New texture added to the Asset Manager with ID = " + assetID);
 }
 
 SDL_Texture* AssetManager::GetTexture(const std::string& assetID) {
 	return textures[assetID];
-}
\ No newline at end of file
+}
+
+void AssetManager::AddFont(const std::string& assetID, const std::string& filePath, int fontSize) {
+	TTF_Font* font = TTF_OpenFont(filePath.c_str(), fontSize);
+	if (!font) {
+		Logger::Err("Failed to open font " + filePath + ": " + TTF_GetError());
+		return;
+	}
+
+	// add the font to the map, and rasterize its glyphs once for this size
+	fonts.emplace(assetID, font);
+	glyphAtlases.emplace(assetID, std::make_unique<GlyphAtlas>(font));
+
+	Logger::Log("New font added to the Asset Manager with ID = " + assetID);
+}
+
+TTF_Font* AssetManager::GetFont(const std::string& assetID) {
+	return fonts[assetID];
+}
+
+GlyphAtlas* AssetManager::GetGlyphAtlas(const std::string& assetID) {
+	auto glyphAtlas = glyphAtlases.find(assetID);
+	if (glyphAtlas == glyphAtlases.end()) {
+		return nullptr;
+	}
+	return glyphAtlas->second.get();
+}
+
+void AssetManager::AddSoundEffect(const std::string& assetID, const std::string& filePath) {
+	Mix_Chunk* soundEffect = Mix_LoadWAV(filePath.c_str());
+	if (!soundEffect) {
+		Logger::Err("Failed to load sound effect " + filePath + ": " + Mix_GetError());
+		return;
+	}
+
+	soundEffects.emplace(assetID, soundEffect);
+
+	Logger::Log("New sound effect added to the Asset Manager with ID = " + assetID);
+}
+
+Mix_Chunk* AssetManager::GetSoundEffect(const std::string& assetID) {
+	return soundEffects[assetID];
+}
+
+void AssetManager::AddMusic(const std::string& assetID, const std::string& filePath) {
+	Mix_Music* track = Mix_LoadMUS(filePath.c_str());
+	if (!track) {
+		Logger::Err("Failed to load music " + filePath + ": " + Mix_GetError());
+		return;
+	}
+
+	music.emplace(assetID, track);
+
+	Logger::Log("New music added to the Asset Manager with ID = " + assetID);
+}
+
+Mix_Music* AssetManager::GetMusic(const std::string& assetID) {
+	return music[assetID];
+}
+
+void AssetManager::EnableHotReload(const std::string& folderPath) {
+	assetWatcher.Start(folderPath);
+}
+
+void AssetManager::DisableHotReload() {
+	assetWatcher.Stop();
+}
+
+void AssetManager::ProcessReloads(SDL_Renderer* renderer, double maxMilliseconds) {
+	assetWatcher.CollectReloadedAssets(pendingReloads);
+	if (pendingReloads.empty()) {
+		return;
+	}
+
+	PROFILE_FUNCTION();
+
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	const double millisecsPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+
+	// Upload at least one texture per call, the remaining ones wait for the next frame once the budget is spent
+	size_t numProcessed = 0;
+	while (numProcessed < pendingReloads.size()) {
+		ReloadTexture(renderer, pendingReloads[numProcessed++]);
+
+		double elapsedMilliseconds = (SDL_GetPerformanceCounter() - startCounter) * millisecsPerCount;
+		if (elapsedMilliseconds >= maxMilliseconds) {
+			break;
+		}
+	}
+	pendingReloads.erase(pendingReloads.begin(), pendingReloads.begin() + numProcessed);
+}
+
+void AssetManager::ReloadTexture(SDL_Renderer* renderer, const ReloadedAsset& reloadedAsset) {
+	// swap the texture behind every asset ID that was loaded from that file
+	for (const auto& texturePath : texturePaths) {
+		if (texturePath.second != reloadedAsset.filePath) {
+			continue;
+		}
+
+		SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, reloadedAsset.surface);
+		if (!texture) {
+			Logger::Err("Failed to reload texture with ID = " + texturePath.first);
+			continue;
+		}
+
+		SDL_DestroyTexture(textures[texturePath.first]);
+		textures[texturePath.first] = texture;
+
+		Logger::Log("Texture reloaded with ID = " + texturePath.first);
+	}
+	SDL_FreeSurface(reloadedAsset.surface);
+}
@@ -1,15 +1,31 @@
 #ifndef ASSETMANAGER_H
 #define ASSETMANAGER_H
 
+#include "AssetWatcher.h"
+#include "GlyphAtlas.h"
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <SDL.h>
+#include <SDL_ttf.h>
+#include <SDL_mixer.h>
 
 class AssetManager {
 private:
 	std::map<std::string, SDL_Texture*> textures;
-	// TODO: create a map for fonts
-	// TODO: create a map for audio
+	std::map<std::string, std::string> texturePaths;
+	std::map<std::string, TTF_Font*> fonts;
+	std::map<std::string, std::unique_ptr<GlyphAtlas>> glyphAtlases;
+
+	// Sound effects are fully decoded to PCM when loaded, music is streamed from disk
+	std::map<std::string, Mix_Chunk*> soundEffects;
+	std::map<std::string, Mix_Music*> music;
+
+	// Hot reload of the assets that are modified on disk while the game is running
+	AssetWatcher assetWatcher;
+	std::vector<ReloadedAsset> pendingReloads;
+	void ReloadTexture(SDL_Renderer* renderer, const ReloadedAsset& reloadedAsset);
 
 public:
 	AssetManager();
@@ -18,6 +34,22 @@ public:
 	void ClearAssets();
 	void AddTexture(SDL_Renderer* renderer, const std::string& assetID, const std::string& filePath);
 	SDL_Texture* GetTexture(const std::string& assetID);
+
+	// Each font asset is a font file opened at a given size, with its own glyph atlas
+	void AddFont(const std::string& assetID, const std::string& filePath, int fontSize);
+	TTF_Font* GetFont(const std::string& assetID);
+	GlyphAtlas* GetGlyphAtlas(const std::string& assetID);
+
+	void AddSoundEffect(const std::string& assetID, const std::string& filePath);
+	Mix_Chunk* GetSoundEffect(const std::string& assetID);
+	void AddMusic(const std::string& assetID, const std::string& filePath);
+	Mix_Music* GetMusic(const std::string& assetID);
+
+	void EnableHotReload(const std::string& folderPath);
+	void DisableHotReload();
+
+	// Swaps the textures that changed on disk, spending at most maxMilliseconds per call
+	void ProcessReloads(SDL_Renderer* renderer, double maxMilliseconds);
 };
 
 #endif // !ASSETMANAGER_H
@@ -0,0 +1,211 @@
+#include "AssetWatcher.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+AssetWatcher::AssetWatcher() {
+	isRunning = false;
+}
+
+AssetWatcher::~AssetWatcher() {
+	Stop();
+}
+
+void AssetWatcher::Start(const std::string& folderPath) {
+	if (isRunning) {
+		return;
+	}
+
+	this->folderPath = folderPath;
+	isRunning = true;
+	watcherThread = std::thread(&AssetWatcher::Watch, this);
+
+	Logger::Log("Asset watcher started on folder " + folderPath);
+}
+
+void AssetWatcher::Stop() {
+	isRunning = false;
+	if (watcherThread.joinable()) {
+		watcherThread.join();
+	}
+
+	// free the images that were never collected by the main thread
+	std::lock_guard<std::mutex> lock(reloadedAssetsMutex);
+	for (auto& asset : reloadedAssets) {
+		SDL_FreeSurface(asset.surface);
+	}
+	reloadedAssets.clear();
+}
+
+bool AssetWatcher::IsRunning() const {
+	return isRunning;
+}
+
+void AssetWatcher::CollectReloadedAssets(std::vector<ReloadedAsset>& output) {
+	std::unique_lock<std::mutex> lock(reloadedAssetsMutex, std::try_to_lock);
+	if (!lock.owns_lock() || reloadedAssets.empty()) {
+		return;
+	}
+
+	output.insert(output.end(), reloadedAssets.begin(), reloadedAssets.end());
+	reloadedAssets.clear();
+}
+
+std::string AssetWatcher::NormalizePath(const std::string& filePath) {
+	return std::filesystem::path(filePath).lexically_normal().generic_string();
+}
+
+void AssetWatcher::DecodeFile(const std::string& filePath) {
+	// only images can be reloaded for now
+	std::string extension = std::filesystem::path(filePath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".bmp") {
+		return;
+	}
+
+	// the expensive part of the reload (disk + decoding) happens here, outside the game loop
+	PROFILE_FUNCTION();
+	SDL_Surface* surface = IMG_Load(filePath.c_str());
+	if (!surface) {
+		Logger::Err("Asset watcher failed to decode " + filePath + ": " + IMG_GetError());
+		return;
+	}
+
+	const std::string normalizedPath = NormalizePath(filePath);
+
+	std::lock_guard<std::mutex> lock(reloadedAssetsMutex);
+
+	// if the file was saved again before the main thread collected it, keep only the latest version
+	for (auto& asset : reloadedAssets) {
+		if (asset.filePath == normalizedPath) {
+			SDL_FreeSurface(asset.surface);
+			asset.surface = surface;
+			return;
+		}
+	}
+	reloadedAssets.push_back({ normalizedPath, surface });
+}
+
+#ifdef __linux__
+
+void AssetWatcher::Watch() {
+	Profiler::SetThreadName("Asset watcher");
+
+	int inotifyFd = inotify_init1(IN_NONBLOCK);
+	if (inotifyFd < 0) {
+		Logger::Err("Asset watcher could not initialize inotify.");
+		isRunning = false;
+		return;
+	}
+
+	// inotify is not recursive, so every sub folder needs its own watch
+	std::unordered_map<int, std::string> watchedFolders;
+	const uint32_t watchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+	auto addWatch = [&](const std::string& path) {
+		int watchDescriptor = inotify_add_watch(inotifyFd, path.c_str(), watchMask);
+		if (watchDescriptor >= 0) {
+			watchedFolders[watchDescriptor] = path;
+		}
+	};
+
+	addWatch(folderPath);
+	std::error_code error;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(folderPath, error)) {
+		if (entry.is_directory()) {
+			addWatch(entry.path().generic_string());
+		}
+	}
+
+	alignas(inotify_event) char buffer[4096];
+
+	while (isRunning) {
+		pollfd pollFd = { inotifyFd, POLLIN, 0 };
+		if (poll(&pollFd, 1, MILLISECS_WATCH_INTERVAL) <= 0) {
+			continue;
+		}
+
+		// editors usually fire several events per save, only decode each file once
+		std::set<std::string> changedFiles;
+		ssize_t length;
+		while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+			for (char* ptr = buffer; ptr < buffer + length;) {
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+				ptr += sizeof(inotify_event) + event->len;
+
+				if (event->len == 0) {
+					continue;
+				}
+
+				const std::string path = watchedFolders[event->wd] + "/" + event->name;
+				if (event->mask & IN_ISDIR) {
+					if (event->mask & IN_CREATE) {
+						addWatch(path);
+					}
+				}
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+					changedFiles.insert(path);
+				}
+			}
+		}
+
+		for (const auto& filePath : changedFiles) {
+			DecodeFile(filePath);
+		}
+	}
+
+	close(inotifyFd);
+}
+
+#else
+
+void AssetWatcher::Watch() {
+	Profiler::SetThreadName("Asset watcher");
+
+	// No inotify on this platform, so compare the modification time of every file periodically
+	std::map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+	bool isFirstScan = true;
+
+	while (isRunning) {
+		std::error_code error;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(folderPath, error)) {
+			if (!entry.is_regular_file(error)) {
+				continue;
+			}
+
+			const std::string path = entry.path().generic_string();
+			const auto writeTime = entry.last_write_time(error);
+			if (error) {
+				continue;
+			}
+
+			auto lastWriteTime = lastWriteTimes.find(path);
+			if (lastWriteTime == lastWriteTimes.end()) {
+				lastWriteTimes.emplace(path, writeTime);
+				if (!isFirstScan) {
+					DecodeFile(path);
+				}
+			}
+			else if (lastWriteTime->second != writeTime) {
+				lastWriteTime->second = writeTime;
+				DecodeFile(path);
+			}
+		}
+		isFirstScan = false;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(MILLISECS_WATCH_INTERVAL));
+	}
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+
+#include <SDL.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// How often the watcher thread wakes up to check if it should stop (or rescan the files)
+const int MILLISECS_WATCH_INTERVAL = 250;
+
+/// <summary>
+/// An image that changed on disk and was already decoded by the watcher thread,
+/// it only needs to be uploaded as a texture by the main thread.
+/// </summary>
+struct ReloadedAsset {
+	std::string filePath;
+	SDL_Surface* surface;
+};
+
+/// <summary>
+/// The asset watcher runs a background thread that detects modified files inside a folder
+/// (inotify on Linux, polling of the file modification times on other platforms)
+/// and decodes the changed images so the main loop never waits on the disk.
+/// </summary>
+class AssetWatcher {
+private:
+	std::string folderPath;
+	std::thread watcherThread;
+	std::atomic<bool> isRunning;
+
+	// Decoded images waiting to be collected by the main thread
+	std::mutex reloadedAssetsMutex;
+	std::vector<ReloadedAsset> reloadedAssets;
+
+	void Watch();
+	void DecodeFile(const std::string& filePath);
+
+public:
+	AssetWatcher();
+	~AssetWatcher();
+
+	void Start(const std::string& folderPath);
+	void Stop();
+	bool IsRunning() const;
+
+	// Moves the decoded images to the output vector, it never blocks:
+	// if the watcher thread is busy pushing an image, they are collected next frame
+	void CollectReloadedAssets(std::vector<ReloadedAsset>& output);
+
+	// Returns the path in the same format for the watcher and the asset manager
+	static std::string NormalizePath(const std::string& filePath);
+};
+
+#endif // !ASSETWATCHER_H
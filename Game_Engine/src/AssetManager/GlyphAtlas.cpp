@@ -0,0 +1,222 @@
+#include "GlyphAtlas.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+
+// Decodes the next UTF-8 codepoint of the text and moves the index past it
+static Uint32 NextCodepoint(const std::string& text, size_t& index) {
+	const unsigned char ch = text[index++];
+	if (ch < 0x80) {
+		return ch;
+	}
+
+	int numContinuationBytes;
+	Uint32 codepoint;
+	if ((ch & 0xE0) == 0xC0) {
+		numContinuationBytes = 1;
+		codepoint = ch & 0x1F;
+	}
+	else if ((ch & 0xF0) == 0xE0) {
+		numContinuationBytes = 2;
+		codepoint = ch & 0x0F;
+	}
+	else if ((ch & 0xF8) == 0xF0) {
+		numContinuationBytes = 3;
+		codepoint = ch & 0x07;
+	}
+	else {
+		return '?';
+	}
+
+	for (int i = 0; i < numContinuationBytes; i++) {
+		if (index >= text.size() || (text[index] & 0xC0) != 0x80) {
+			return '?';
+		}
+		codepoint = (codepoint << 6) | (text[index++] & 0x3F);
+	}
+	return codepoint;
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font* font) {
+	this->font = font;
+	this->atlasTexture = nullptr;
+	this->atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, GLYPH_ATLAS_WIDTH, 32, SDL_PIXELFORMAT_ARGB8888);
+	this->shelfX = 0;
+	this->shelfY = 0;
+	this->shelfHeight = 0;
+	this->dirtyRect = { 0, 0, 0, 0 };
+	this->isTextureOutdated = true;
+
+	// Most of the labels are plain ASCII, so rasterize those glyphs upfront
+	for (Uint32 codepoint = 32; codepoint < 127; codepoint++) {
+		GetGlyph(codepoint);
+	}
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	SDL_DestroyTexture(atlasTexture);
+	SDL_FreeSurface(atlasSurface);
+}
+
+int GlyphAtlas::GetWidth() const {
+	return atlasSurface->w;
+}
+
+int GlyphAtlas::GetHeight() const {
+	return atlasSurface->h;
+}
+
+const Glyph* GlyphAtlas::GetGlyph(Uint32 codepoint) {
+	auto glyph = glyphs.find(codepoint);
+	if (glyph != glyphs.end()) {
+		return &glyph->second;
+	}
+	return RasterizeGlyph(codepoint);
+}
+
+const Glyph* GlyphAtlas::RasterizeGlyph(Uint32 codepoint) {
+	if (!atlasSurface || !TTF_GlyphIsProvided32(font, codepoint)) {
+		return nullptr;
+	}
+
+	int advance;
+	if (TTF_GlyphMetrics32(font, codepoint, nullptr, nullptr, nullptr, nullptr, &advance) != 0) {
+		return nullptr;
+	}
+
+	// Glyphs are rasterized in white, the label color is applied by the vertex color
+	SDL_Surface* glyphSurface = TTF_RenderGlyph32_Blended(font, codepoint, { 255, 255, 255, 255 });
+	if (!glyphSurface) {
+		return nullptr;
+	}
+
+	// Find a spot in the current shelf, or open a new one below it
+	if (shelfX + glyphSurface->w + GLYPH_PADDING > atlasSurface->w) {
+		shelfX = 0;
+		shelfY += shelfHeight + GLYPH_PADDING;
+		shelfHeight = 0;
+	}
+	while (shelfY + glyphSurface->h + GLYPH_PADDING > atlasSurface->h) {
+		if (!Grow()) {
+			Logger::Err("Glyph atlas is full, could not add glyph " + std::to_string(codepoint));
+			SDL_FreeSurface(glyphSurface);
+			return nullptr;
+		}
+	}
+
+	SDL_Rect srcRect = { shelfX, shelfY, glyphSurface->w, glyphSurface->h };
+
+	// Copy the pixels (alpha included) instead of blending them over the atlas
+	SDL_SetSurfaceBlendMode(glyphSurface, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(glyphSurface, nullptr, atlasSurface, &srcRect);
+	SDL_FreeSurface(glyphSurface);
+
+	shelfX += srcRect.w + GLYPH_PADDING;
+	shelfHeight = std::max(shelfHeight, srcRect.h);
+
+	// Expand the region of the atlas that has to be uploaded to the texture
+	if (dirtyRect.w == 0 || dirtyRect.h == 0) {
+		dirtyRect = srcRect;
+	}
+	else {
+		int right = std::max(dirtyRect.x + dirtyRect.w, srcRect.x + srcRect.w);
+		int bottom = std::max(dirtyRect.y + dirtyRect.h, srcRect.y + srcRect.h);
+		dirtyRect.x = std::min(dirtyRect.x, srcRect.x);
+		dirtyRect.y = std::min(dirtyRect.y, srcRect.y);
+		dirtyRect.w = right - dirtyRect.x;
+		dirtyRect.h = bottom - dirtyRect.y;
+	}
+
+	Glyph& glyph = glyphs[codepoint];
+	glyph.srcRect = srcRect;
+	glyph.advance = advance;
+	return &glyph;
+}
+
+bool GlyphAtlas::Grow() {
+	const int newHeight = atlasSurface->h * 2;
+	if (newHeight > GLYPH_ATLAS_MAX_HEIGHT) {
+		return false;
+	}
+
+	// The glyphs keep their pixel position, only the texture has to be created again
+	SDL_Surface* newSurface = SDL_CreateRGBSurfaceWithFormat(0, atlasSurface->w, newHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (!newSurface) {
+		return false;
+	}
+	SDL_SetSurfaceBlendMode(atlasSurface, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(atlasSurface, nullptr, newSurface, nullptr);
+	SDL_FreeSurface(atlasSurface);
+	atlasSurface = newSurface;
+	isTextureOutdated = true;
+
+	Logger::Log("Glyph atlas grown to " + std::to_string(atlasSurface->w) + "x" + std::to_string(atlasSurface->h));
+	return true;
+}
+
+const TextLayout& GlyphAtlas::GetLayout(const std::string& text) {
+	auto cachedLayout = layouts.find(text);
+	if (cachedLayout != layouts.end()) {
+		return cachedLayout->second;
+	}
+
+	if (layouts.size() >= MAX_CACHED_LAYOUTS) {
+		layouts.clear();
+	}
+
+	TextLayout& layout = layouts[text];
+	const int lineHeight = TTF_FontLineSkip(font);
+	int penX = 0;
+	int penY = 0;
+	layout.width = 0;
+	layout.height = text.empty() ? 0 : TTF_FontHeight(font);
+
+	size_t index = 0;
+	while (index < text.size()) {
+		const Uint32 codepoint = NextCodepoint(text, index);
+		if (codepoint == '\n') {
+			penX = 0;
+			penY += lineHeight;
+			layout.height = penY + TTF_FontHeight(font);
+			continue;
+		}
+
+		const Glyph* glyph = GetGlyph(codepoint);
+		if (!glyph) {
+			continue;
+		}
+
+		GlyphQuad quad;
+		quad.x = static_cast<float>(penX);
+		quad.y = static_cast<float>(penY);
+		quad.width = static_cast<float>(glyph->srcRect.w);
+		quad.height = static_cast<float>(glyph->srcRect.h);
+		quad.srcRect = glyph->srcRect;
+		layout.quads.push_back(quad);
+
+		penX += glyph->advance;
+		layout.width = std::max(layout.width, penX);
+	}
+	return layout;
+}
+
+SDL_Texture* GlyphAtlas::GetTexture(SDL_Renderer* renderer) {
+	if (!atlasSurface) {
+		return nullptr;
+	}
+
+	if (isTextureOutdated) {
+		SDL_DestroyTexture(atlasTexture);
+		atlasTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, atlasSurface->w, atlasSurface->h);
+		SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+		SDL_UpdateTexture(atlasTexture, nullptr, atlasSurface->pixels, atlasSurface->pitch);
+		isTextureOutdated = false;
+		dirtyRect = { 0, 0, 0, 0 };
+	}
+	else if (dirtyRect.w > 0 && dirtyRect.h > 0) {
+		// Only upload the rows/columns where new glyphs were rasterized
+		const Uint8* pixels = static_cast<const Uint8*>(atlasSurface->pixels) + dirtyRect.y * atlasSurface->pitch + dirtyRect.x * 4;
+		SDL_UpdateTexture(atlasTexture, &dirtyRect, pixels, atlasSurface->pitch);
+		dirtyRect = { 0, 0, 0, 0 };
+	}
+	return atlasTexture;
+}
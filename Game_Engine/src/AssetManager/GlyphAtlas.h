@@ -0,0 +1,83 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const int GLYPH_ATLAS_WIDTH = 512;
+const int GLYPH_ATLAS_MAX_HEIGHT = 4096;
+const int GLYPH_PADDING = 1;
+
+// Past this number of different strings the layout cache is flushed
+const size_t MAX_CACHED_LAYOUTS = 8192;
+
+/// <summary>
+/// A glyph that was rasterized in the atlas, and how much the pen moves after drawing it
+/// </summary>
+struct Glyph {
+	SDL_Rect srcRect;
+	int advance;
+};
+
+/// <summary>
+/// One glyph of a laid out string, relative to the top-left corner of the text
+/// </summary>
+struct GlyphQuad {
+	float x;
+	float y;
+	float width;
+	float height;
+	SDL_Rect srcRect;
+};
+
+struct TextLayout {
+	std::vector<GlyphQuad> quads;
+	int width;
+	int height;
+};
+
+/// <summary>
+/// The glyph atlas rasterizes each glyph of a font (at a given size) only once
+/// into a single texture, and caches the layout of the strings already seen,
+/// so the text can be drawn as a batch of textured quads.
+/// </summary>
+class GlyphAtlas {
+private:
+	TTF_Font* font;
+	SDL_Surface* atlasSurface;
+	SDL_Texture* atlasTexture;
+
+	// Shelf packing: glyphs are placed left to right in rows of the atlas
+	int shelfX;
+	int shelfY;
+	int shelfHeight;
+
+	// Region of the surface that still needs to be uploaded to the texture
+	SDL_Rect dirtyRect;
+	bool isTextureOutdated;
+
+	std::unordered_map<Uint32, Glyph> glyphs;
+	std::unordered_map<std::string, TextLayout> layouts;
+
+	const Glyph* GetGlyph(Uint32 codepoint);
+	const Glyph* RasterizeGlyph(Uint32 codepoint);
+	bool Grow();
+
+public:
+	GlyphAtlas(TTF_Font* font);
+	~GlyphAtlas();
+
+	// Returns the cached layout of the text, laying it out the first time it is seen
+	const TextLayout& GetLayout(const std::string& text);
+
+	// Returns the atlas texture, after uploading the glyphs rasterized since the last call
+	SDL_Texture* GetTexture(SDL_Renderer* renderer);
+
+	int GetWidth() const;
+	int GetHeight() const;
+};
+
+#endif // !GLYPHATLAS_H
@@ -0,0 +1,278 @@
+#include "AudioManager.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+
+// The mixer reports finished channels through a callback without user data,
+// so the busy flags live at file scope. Written by the SDL audio thread, read by ours.
+static std::atomic<bool> channelsBusy[MAX_VOICES];
+
+static void OnChannelFinished(int channel) {
+	if (channel >= 0 && channel < MAX_VOICES) {
+		channelsBusy[channel].store(false, std::memory_order_release);
+	}
+}
+
+AudioManager::AudioManager() {
+	isRunning = false;
+	commandSignal = nullptr;
+	nextVoiceID = 0;
+	numDroppedCommands = 0;
+	numEffectsStarted = 0;
+	numVoicesStolen = 0;
+	numEffectsRejected = 0;
+	numVoicesStarted = 0;
+	nextFreeChannel = 0;
+	Logger::Log("AudioManager constructor called!");
+}
+
+AudioManager::~AudioManager() {
+	Stop();
+	Logger::Log("AudioManager destructor called!");
+}
+
+bool AudioManager::Start() {
+	if (isRunning) {
+		return true;
+	}
+
+	if ((Mix_Init(MIX_INIT_OGG | MIX_INIT_MP3) & (MIX_INIT_OGG | MIX_INIT_MP3)) == 0) {
+		Logger::Err(std::string("SDL mixer could not load the OGG/MP3 decoders: ") + Mix_GetError());
+	}
+
+	if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, 2, 1024) != 0) {
+		Logger::Err(std::string("Error opening the audio device: ") + Mix_GetError());
+		Mix_Quit();
+		return false;
+	}
+
+	Mix_AllocateChannels(MAX_VOICES);
+	for (int channel = 0; channel < MAX_VOICES; channel++) {
+		channelsBusy[channel].store(false);
+	}
+	Mix_ChannelFinished(OnChannelFinished);
+	voices.assign(MAX_VOICES, { -1, 0, 0 });
+
+	commandSignal = SDL_CreateSemaphore(0);
+	isRunning = true;
+	audioThread = std::thread(&AudioManager::ProcessCommands, this);
+
+	Logger::Log("Audio started with " + std::to_string(MAX_VOICES) + " voices");
+	return true;
+}
+
+void AudioManager::Stop() {
+	if (!isRunning) {
+		return;
+	}
+
+	isRunning = false;
+	SDL_SemPost(commandSignal);
+	audioThread.join();
+	SDL_DestroySemaphore(commandSignal);
+	commandSignal = nullptr;
+
+	Mix_ChannelFinished(nullptr);
+	Mix_HaltChannel(-1);
+	Mix_HaltMusic();
+	Mix_CloseAudio();
+	Mix_Quit();
+}
+
+bool AudioManager::Send(const AudioCommand& command) {
+	if (!isRunning) {
+		return false;
+	}
+
+	if (!commands.Push(command)) {
+		numDroppedCommands++;
+		return false;
+	}
+	SDL_SemPost(commandSignal);
+	return true;
+}
+
+int AudioManager::PlayEffect(Mix_Chunk* effect, int priority, int volume, int loops) {
+	if (!isRunning || !effect) {
+		return -1;
+	}
+
+	// the voice ID is given right away, so the caller can stop the sound before it even starts
+	const int voiceID = nextVoiceID++;
+	if (!Send({ AUDIO_PLAY_EFFECT, voiceID, priority, volume, loops, 0, effect, nullptr })) {
+		return -1;
+	}
+	return voiceID;
+}
+
+void AudioManager::StopEffect(int voiceID) {
+	Send({ AUDIO_STOP_EFFECT, voiceID, 0, 0, 0, 0, nullptr, nullptr });
+}
+
+void AudioManager::SetEffectVolume(int voiceID, int volume) {
+	Send({ AUDIO_SET_EFFECT_VOLUME, voiceID, 0, volume, 0, 0, nullptr, nullptr });
+}
+
+void AudioManager::PlayMusic(Mix_Music* music, int loops, int fadeMilliseconds) {
+	Send({ AUDIO_PLAY_MUSIC, -1, 0, 0, loops, fadeMilliseconds, nullptr, music });
+}
+
+void AudioManager::StopMusic(int fadeMilliseconds) {
+	Send({ AUDIO_STOP_MUSIC, -1, 0, 0, 0, fadeMilliseconds, nullptr, nullptr });
+}
+
+void AudioManager::SetMusicVolume(int volume) {
+	Send({ AUDIO_SET_MUSIC_VOLUME, -1, 0, volume, 0, 0, nullptr, nullptr });
+}
+
+void AudioManager::SetMasterVolume(int volume) {
+	Send({ AUDIO_SET_MASTER_VOLUME, -1, 0, volume, 0, 0, nullptr, nullptr });
+}
+
+void AudioManager::StopAll() {
+	Send({ AUDIO_STOP_ALL, -1, 0, 0, 0, 0, nullptr, nullptr });
+}
+
+int AudioManager::GetNumDroppedCommands() const {
+	return numDroppedCommands;
+}
+
+int AudioManager::GetNumEffectsStarted() const {
+	return numEffectsStarted;
+}
+
+int AudioManager::GetNumVoicesStolen() const {
+	return numVoicesStolen;
+}
+
+int AudioManager::GetNumEffectsRejected() const {
+	return numEffectsRejected;
+}
+
+void AudioManager::ProcessCommands() {
+	Profiler::SetThreadName("Audio");
+
+	while (isRunning) {
+		SDL_SemWaitTimeout(commandSignal, 100);
+
+		PROFILE_SCOPE("AudioManager::ProcessCommands");
+		AudioCommand command;
+		while (commands.Pop(command)) {
+			Execute(command);
+		}
+	}
+}
+
+void AudioManager::Execute(const AudioCommand& command) {
+	switch (command.type) {
+		case AUDIO_PLAY_EFFECT:
+			StartVoice(command);
+			break;
+		case AUDIO_STOP_EFFECT: {
+			int channel = FindChannel(command.voiceID);
+			if (channel >= 0) {
+				Mix_HaltChannel(channel);
+			}
+			break;
+		}
+		case AUDIO_SET_EFFECT_VOLUME: {
+			int channel = FindChannel(command.voiceID);
+			if (channel >= 0) {
+				Mix_Volume(channel, command.volume);
+			}
+			break;
+		}
+		case AUDIO_PLAY_MUSIC:
+			// music is streamed from disk by the mixer, it is never fully decoded in memory
+			if (command.fadeMilliseconds > 0) {
+				Mix_FadeInMusic(command.music, command.loops, command.fadeMilliseconds);
+			}
+			else {
+				Mix_PlayMusic(command.music, command.loops);
+			}
+			break;
+		case AUDIO_STOP_MUSIC:
+			if (command.fadeMilliseconds > 0) {
+				Mix_FadeOutMusic(command.fadeMilliseconds);
+			}
+			else {
+				Mix_HaltMusic();
+			}
+			break;
+		case AUDIO_SET_MUSIC_VOLUME:
+			Mix_VolumeMusic(command.volume);
+			break;
+		case AUDIO_SET_MASTER_VOLUME:
+			Mix_MasterVolume(command.volume);
+			break;
+		case AUDIO_STOP_ALL:
+			Mix_HaltChannel(-1);
+			Mix_HaltMusic();
+			break;
+	}
+}
+
+void AudioManager::StartVoice(const AudioCommand& command) {
+	int channel = FindFreeChannel();
+
+	// every voice is busy: steal the least important one, or drop the new sound
+	if (channel < 0) {
+		channel = FindVoiceToSteal(command.priority);
+		if (channel < 0) {
+			numEffectsRejected++;
+			return;
+		}
+		Mix_HaltChannel(channel);
+		numVoicesStolen++;
+	}
+
+	// set the volume before starting, so the first samples are not mixed at full volume
+	channelsBusy[channel].store(true, std::memory_order_relaxed);
+	Mix_Volume(channel, command.volume);
+	if (Mix_PlayChannel(channel, command.effect, command.loops) < 0) {
+		channelsBusy[channel].store(false, std::memory_order_relaxed);
+		numEffectsRejected++;
+		return;
+	}
+	numEffectsStarted++;
+
+	voices[channel].voiceID = command.voiceID;
+	voices[channel].priority = command.priority;
+	voices[channel].startOrder = numVoicesStarted++;
+}
+
+int AudioManager::FindFreeChannel() {
+	for (int i = 0; i < MAX_VOICES; i++) {
+		int channel = (nextFreeChannel + i) % MAX_VOICES;
+		if (!channelsBusy[channel].load(std::memory_order_acquire)) {
+			nextFreeChannel = (channel + 1) % MAX_VOICES;
+			return channel;
+		}
+	}
+	return -1;
+}
+
+int AudioManager::FindVoiceToSteal(int priority) const {
+	int channelToSteal = -1;
+	for (int channel = 0; channel < MAX_VOICES; channel++) {
+		const Voice& voice = voices[channel];
+		if (voice.priority > priority) {
+			continue;
+		}
+
+		if (channelToSteal < 0
+			|| voice.priority < voices[channelToSteal].priority
+			|| (voice.priority == voices[channelToSteal].priority && voice.startOrder < voices[channelToSteal].startOrder)) {
+			channelToSteal = channel;
+		}
+	}
+	return channelToSteal;
+}
+
+int AudioManager::FindChannel(int voiceID) const {
+	for (int channel = 0; channel < MAX_VOICES; channel++) {
+		if (voices[channel].voiceID == voiceID && channelsBusy[channel].load(std::memory_order_acquire)) {
+			return channel;
+		}
+	}
+	return -1;
+}
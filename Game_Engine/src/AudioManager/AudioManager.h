@@ -0,0 +1,104 @@
+#ifndef AUDIOMANAGER_H
+#define AUDIOMANAGER_H
+
+#include "../Utils/LockFreeQueue.h"
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+const int MAX_VOICES = 256;
+const size_t AUDIO_COMMAND_CAPACITY = 4096;
+
+enum AudioCommandType {
+	AUDIO_PLAY_EFFECT,
+	AUDIO_STOP_EFFECT,
+	AUDIO_SET_EFFECT_VOLUME,
+	AUDIO_PLAY_MUSIC,
+	AUDIO_STOP_MUSIC,
+	AUDIO_SET_MUSIC_VOLUME,
+	AUDIO_SET_MASTER_VOLUME,
+	AUDIO_STOP_ALL
+};
+
+struct AudioCommand {
+	AudioCommandType type;
+	int voiceID;
+	int priority;
+	int volume;
+	int loops;
+	int fadeMilliseconds;
+	Mix_Chunk* effect;
+	Mix_Music* music;
+};
+
+/// <summary>
+/// A sound effect playing on one of the mixer channels
+/// </summary>
+struct Voice {
+	int voiceID;
+	int priority;
+	Uint64 startOrder;
+};
+
+/// <summary>
+/// The audio manager owns every call to SDL_mixer from a dedicated thread.
+/// Gameplay code (from any thread) only pushes commands to a lock-free queue, so it never
+/// blocks on the mixer. When all the voices are busy, a new sound effect steals the voice
+/// with the lowest priority (the oldest one when priorities are equal).
+/// </summary>
+class AudioManager {
+private:
+	LockFreeQueue<AudioCommand, AUDIO_COMMAND_CAPACITY> commands;
+	std::thread audioThread;
+	std::atomic<bool> isRunning;
+	SDL_sem* commandSignal;
+	std::atomic<int> nextVoiceID;
+	std::atomic<int> numDroppedCommands;
+	std::atomic<int> numEffectsStarted;
+	std::atomic<int> numVoicesStolen;
+	std::atomic<int> numEffectsRejected;
+
+	// Only touched by the audio thread, [vector index = mixer channel]
+	std::vector<Voice> voices;
+	Uint64 numVoicesStarted;
+	int nextFreeChannel;
+
+	void ProcessCommands();
+	void Execute(const AudioCommand& command);
+	void StartVoice(const AudioCommand& command);
+	int FindFreeChannel();
+	int FindVoiceToSteal(int priority) const;
+	int FindChannel(int voiceID) const;
+	// False if the command was dropped because the queue is full
+	bool Send(const AudioCommand& command);
+
+public:
+	AudioManager();
+	~AudioManager();
+
+	bool Start();
+	void Stop();
+
+	// These functions can be called from any thread, and return immediately.
+	// PlayEffect returns -1 if the effect could not be queued.
+	int PlayEffect(Mix_Chunk* effect, int priority = 0, int volume = MIX_MAX_VOLUME, int loops = 0);
+	void StopEffect(int voiceID);
+	void SetEffectVolume(int voiceID, int volume);
+	void PlayMusic(Mix_Music* music, int loops = -1, int fadeMilliseconds = 0);
+	void StopMusic(int fadeMilliseconds = 0);
+	void SetMusicVolume(int volume);
+	void SetMasterVolume(int volume);
+	void StopAll();
+
+	// Number of commands lost because the queue was full
+	int GetNumDroppedCommands() const;
+	// Effects the mixer played, the ones that took the voice of another effect, and the ones
+	// that found every voice busy with more important effects
+	int GetNumEffectsStarted() const;
+	int GetNumVoicesStolen() const;
+	int GetNumEffectsRejected() const;
+};
+
+#endif // !AUDIOMANAGER_H
@@ -0,0 +1,95 @@
+#include "Benchmarks.h"
+#include "../AudioManager/AudioManager.h"
+#include "../Logger/Logger.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Threads playing effects at the same time, like gameplay code on the job system would
+const int AUDIO_STRESS_NUM_THREADS = 4;
+// Effects are more or less important, the less important ones lose their voice first
+const int AUDIO_STRESS_NUM_PRIORITIES = 4;
+
+bool RunAudioStressTest(int numEffects) {
+	if (SDL_Init(SDL_INIT_AUDIO) != 0) {
+		Logger::Err("Error initializing the SDL audio.");
+		return false;
+	}
+	AudioManager audioManager;
+	if (!audioManager.Start()) {
+		return false;
+	}
+
+	// A half second beep made in memory, so the test doesn't depend on the assets
+	std::vector<Sint16> samples(MIX_DEFAULT_FREQUENCY / 2 * 2);
+	for (size_t i = 0; i < samples.size(); i += 2) {
+		const double time = static_cast<double>(i / 2) / MIX_DEFAULT_FREQUENCY;
+		samples[i] = samples[i + 1] = static_cast<Sint16>(4000.0 * std::sin(2.0 * 3.14159265 * 440.0 * time));
+	}
+	Mix_Chunk* beep = Mix_QuickLoad_RAW(reinterpret_cast<Uint8*>(samples.data()), static_cast<Uint32>(samples.size() * sizeof(Sint16)));
+	if (!beep) {
+		Logger::Err(std::string("Can't create the effect of the audio test: ") + Mix_GetError());
+		return false;
+	}
+
+	std::atomic<int> numEffectsQueued(0);
+	std::atomic<int> numEffectsNotQueued(0);
+	std::vector<double> callMicroseconds(AUDIO_STRESS_NUM_THREADS, 0.0);
+	std::vector<double> maxCallMicroseconds(AUDIO_STRESS_NUM_THREADS, 0.0);
+	std::vector<std::thread> threads;
+	const double countsPerMicrosecond = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000000.0;
+	for (int thread = 0; thread < AUDIO_STRESS_NUM_THREADS; thread++) {
+		threads.emplace_back([&, thread]() {
+			Random random(static_cast<uint64_t>(thread + 1));
+			for (int i = thread; i < numEffects; i += AUDIO_STRESS_NUM_THREADS) {
+				const Uint64 callCounter = SDL_GetPerformanceCounter();
+				const int voiceID = audioManager.PlayEffect(beep, random.Range(0, AUDIO_STRESS_NUM_PRIORITIES - 1), MIX_MAX_VOLUME / 4);
+				const double microseconds = (SDL_GetPerformanceCounter() - callCounter) / countsPerMicrosecond;
+				callMicroseconds[thread] += microseconds;
+				maxCallMicroseconds[thread] = std::max(maxCallMicroseconds[thread], microseconds);
+				if (voiceID >= 0) {
+					numEffectsQueued++;
+				}
+				else {
+					numEffectsNotQueued++;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	double sendMicroseconds = 0.0;
+	for (double microseconds : callMicroseconds) {
+		sendMicroseconds += microseconds;
+	}
+
+	// Every queued effect ends up started or rejected by the audio thread
+	const Uint32 startTicks = SDL_GetTicks();
+	while (audioManager.GetNumEffectsStarted() + audioManager.GetNumEffectsRejected() < numEffectsQueued && SDL_GetTicks() - startTicks < 5000) {
+		SDL_Delay(1);
+	}
+	const int numEffectsStarted = audioManager.GetNumEffectsStarted();
+	const int numEffectsRejected = audioManager.GetNumEffectsRejected();
+
+	Logger::Log(std::to_string(numEffects) + " effects from " + std::to_string(AUDIO_STRESS_NUM_THREADS) + " threads on " + std::to_string(MAX_VOICES) + " voices: "
+		+ std::to_string(numEffectsStarted) + " started, " + std::to_string(audioManager.GetNumVoicesStolen()) + " stole a voice, "
+		+ std::to_string(numEffectsRejected) + " rejected, " + std::to_string(numEffectsNotQueued) + " not queued, "
+		+ std::to_string(sendMicroseconds / numEffects) + " us per PlayEffect (at most "
+		+ std::to_string(*std::max_element(maxCallMicroseconds.begin(), maxCallMicroseconds.end())) + " us)");
+
+	audioManager.Stop();
+	Mix_FreeChunk(beep);
+
+	if (numEffectsNotQueued != audioManager.GetNumDroppedCommands() || numEffectsStarted + numEffectsRejected != numEffectsQueued) {
+		Logger::Err("The audio manager lost track of some effects");
+		return false;
+	}
+	return true;
+}
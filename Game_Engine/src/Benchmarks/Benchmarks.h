@@ -0,0 +1,43 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Command line modes that measure one part of the engine on its own, without a window.
+// Each one builds its own data, logs what it measured and returns false if something went wrong.
+
+// Threads that play effects as fast as they can on the audio manager, so hundreds of voices
+// are busy at once and the new effects steal them
+bool RunAudioStressTest(int numEffects);
+
+// Boxes of sprite sizes moving over a world that keeps a few neighbours around each of them,
+// with every broadphase. Logs the overlapping pairs found per second.
+bool RunBroadphaseBenchmark(int numBoxes);
+
+// Rotated boxes and circles tested exactly on the pairs found by the broadphase, on one core.
+// Logs the pair tests per second.
+bool RunNarrowphaseBenchmark(int numShapes);
+
+// Bodies moving through the collision system with none, 1% and 10% of them fast enough to be swept.
+// Logs the cost of the collision pass for each share of fast movers.
+bool RunContinuousCollisionBenchmark(int numBodies);
+
+// Entities created in random places, then given IDs in the Morton order of their position.
+// Logs the collision pass and a culled render pass in both orders.
+bool RunReorderBenchmark(int numEntities);
+
+// Boids of a few flocks spread over a world where each one has about a dozen neighbours.
+// Logs the time of a flocking tick, grid build included.
+bool RunFlockingBenchmark(int numAgents);
+
+// Path queries between random cells of a large map with blocks, answered over the cluster graph.
+// Logs the time per query against flat A*, then how the graph is rebuilt within the frame budget.
+bool RunPathfindingBenchmark(int numQueries);
+
+// Collision events emitted every frame from the main thread and from the jobs, then dispatched.
+// Logs the time of each way to emit them and of the dispatch.
+bool RunEventBenchmark(int numEvents);
+
+// Entities that are all drawn, half of them moving and colliding, saved and restored like a rollback does.
+// Logs the size of the snapshot and the time to save and to restore it.
+bool RunSnapshotBenchmark(int numEntities);
+
+#endif // !BENCHMARKS_H
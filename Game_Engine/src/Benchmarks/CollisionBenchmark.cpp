@@ -0,0 +1,208 @@
+#include "Benchmarks.h"
+#include "../Collision/Narrowphase.h"
+#include "../Collision/SpatialHashBroadphase.h"
+#include "../Collision/SweepAndPruneBroadphase.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementSystem.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Frames simulated by the collision benchmarks, at the rate of the physics
+const int COLLISION_BENCHMARK_FRAMES = 60;
+const float COLLISION_BENCHMARK_DELTA_TIME = 1.0f / 60.0f;
+
+// Each box gets this much of the world on average, a few other boxes overlap it
+const float COLLISION_BENCHMARK_AREA_PER_BOX = 200.0f * 200.0f;
+
+// The narrowphase tests the same pairs again and again, until it ran for long enough to be timed
+const int NARROWPHASE_BENCHMARK_ROUNDS = 50;
+// Share of the shapes that are circles, the others are boxes
+const float NARROWPHASE_BENCHMARK_CIRCLE_RATE = 0.2f;
+
+// Shares of the bodies that move by more than their half size in one tick
+const float CONTINUOUS_COLLISION_BENCHMARK_FAST_RATES[] = { 0.0f, 0.01f, 0.1f };
+// The fast bodies cross 40 to 80 pixels per tick, the boxes are at most 64 pixels wide
+const float CONTINUOUS_COLLISION_BENCHMARK_FAST_SPEED = 2400.0f;
+
+struct BenchmarkBox {
+	AABB bounds;
+	glm::vec2 velocity;
+};
+
+// Boxes from 32 to 160 pixels (the sprites scaled up to 5 times) moving at up to 100 pixels per second
+static std::vector<BenchmarkBox> CreateBenchmarkBoxes(int numBoxes, float worldSize, uint64_t seed) {
+	Random random(seed);
+	std::vector<BenchmarkBox> boxes(numBoxes);
+	for (auto& box : boxes) {
+		const glm::vec2 size(random.Range(32.0f, 160.0f), random.Range(32.0f, 160.0f));
+		box.bounds.min = glm::vec2(random.Range(0.0f, worldSize - size.x), random.Range(0.0f, worldSize - size.y));
+		box.bounds.max = box.bounds.min + size;
+		box.velocity = glm::vec2(random.Range(-100.0f, 100.0f), random.Range(-100.0f, 100.0f));
+	}
+	return boxes;
+}
+
+// The boxes bounce on the sides of the world
+static void MoveBenchmarkBoxes(std::vector<BenchmarkBox>& boxes, float worldSize, float deltaTime) {
+	for (auto& box : boxes) {
+		const glm::vec2 offset = box.velocity * deltaTime;
+		box.bounds.min += offset;
+		box.bounds.max += offset;
+		for (int axis = 0; axis < 2; axis++) {
+			if ((box.bounds.min[axis] < 0.0f && box.velocity[axis] < 0.0f) || (box.bounds.max[axis] > worldSize && box.velocity[axis] > 0.0f)) {
+				box.velocity[axis] = -box.velocity[axis];
+			}
+		}
+	}
+}
+
+bool RunBroadphaseBenchmark(int numBoxes) {
+	const float worldSize = std::sqrt(numBoxes * COLLISION_BENCHMARK_AREA_PER_BOX);
+	const BroadphaseType types[] = { BROADPHASE_SPATIAL_HASH, BROADPHASE_SWEEP_AND_PRUNE };
+	const std::string typeNames[] = { "Spatial hash", "Sweep and prune" };
+	std::vector<size_t> numPairsPerType;
+
+	for (int type = 0; type < 2; type++) {
+		std::unique_ptr<Broadphase> broadphase;
+		if (types[type] == BROADPHASE_SWEEP_AND_PRUNE) {
+			broadphase = std::make_unique<SweepAndPruneBroadphase>();
+		}
+		else {
+			broadphase = std::make_unique<SpatialHashBroadphase>();
+		}
+
+		// Every broadphase sees the same boxes, the first frame only fills it and isn't timed
+		std::vector<BenchmarkBox> boxes = CreateBenchmarkBoxes(numBoxes, worldSize, 1);
+		std::vector<CollisionPair> addedPairs;
+		std::vector<CollisionPair> removedPairs;
+		for (int i = 0; i < numBoxes; i++) {
+			broadphase->UpdateProxy(i, boxes[i].bounds);
+		}
+		broadphase->UpdatePairs(addedPairs, removedPairs);
+
+		Uint64 counter = 0;
+		size_t numPairs = 0;
+		size_t numPairChanges = 0;
+		for (int frame = 0; frame < COLLISION_BENCHMARK_FRAMES; frame++) {
+			MoveBenchmarkBoxes(boxes, worldSize, COLLISION_BENCHMARK_DELTA_TIME);
+			const Uint64 startCounter = SDL_GetPerformanceCounter();
+			for (int i = 0; i < numBoxes; i++) {
+				broadphase->UpdateProxy(i, boxes[i].bounds);
+			}
+			broadphase->UpdatePairs(addedPairs, removedPairs);
+			counter += SDL_GetPerformanceCounter() - startCounter;
+			numPairs += broadphase->GetPairs().size();
+			numPairChanges += addedPairs.size() + removedPairs.size();
+		}
+
+		numPairsPerType.push_back(numPairs);
+
+		const double seconds = static_cast<double>(counter) / static_cast<double>(SDL_GetPerformanceFrequency());
+		Logger::Log(typeNames[type] + ", " + std::to_string(numBoxes) + " moving boxes: " + std::to_string(seconds * 1000.0 / COLLISION_BENCHMARK_FRAMES) + " ms per frame, "
+			+ std::to_string(numPairs / COLLISION_BENCHMARK_FRAMES) + " pairs and " + std::to_string(numPairChanges / COLLISION_BENCHMARK_FRAMES) + " pair changes per frame, "
+			+ std::to_string(static_cast<double>(numPairs) / seconds / 1000000.0) + " million pairs per second");
+	}
+
+	// Both follow the same rule for the proxies that only touch, so they find the same pairs
+	if (numPairsPerType[0] != numPairsPerType[1]) {
+		Logger::Err("The broadphases don't find the same pairs");
+		return false;
+	}
+	return true;
+}
+
+bool RunNarrowphaseBenchmark(int numShapes) {
+	const float worldSize = std::sqrt(numShapes * COLLISION_BENCHMARK_AREA_PER_BOX);
+	Random random(1);
+	Narrowphase narrowphase;
+	SpatialHashBroadphase broadphase;
+	for (int i = 0; i < numShapes; i++) {
+		CollisionShape shape;
+		const float angle = random.Range(0.0f, 6.2831853f);
+		shape.center = glm::vec2(random.Range(0.0f, worldSize), random.Range(0.0f, worldSize));
+		if (random.NextFloat() < NARROWPHASE_BENCHMARK_CIRCLE_RATE) {
+			shape.type = SHAPE_CIRCLE;
+			shape.radius = random.Range(16.0f, 80.0f);
+			shape.axisX = glm::vec2(1, 0);
+			shape.halfExtents = glm::vec2(shape.radius);
+		}
+		else {
+			shape.type = SHAPE_BOX;
+			shape.radius = 0.0f;
+			shape.axisX = glm::vec2(std::cos(angle), std::sin(angle));
+			shape.halfExtents = glm::vec2(random.Range(16.0f, 80.0f), random.Range(16.0f, 80.0f));
+		}
+		narrowphase.SetShape(i, shape);
+		broadphase.UpdateProxy(i, shape.GetBounds());
+	}
+	std::vector<CollisionPair> addedPairs;
+	std::vector<CollisionPair> removedPairs;
+	broadphase.UpdatePairs(addedPairs, removedPairs);
+	const std::vector<CollisionPair>& pairs = broadphase.GetPairs();
+
+	std::vector<ContactManifold> contacts;
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	for (int round = 0; round < NARROWPHASE_BENCHMARK_ROUNDS; round++) {
+		narrowphase.Collide(pairs, contacts);
+	}
+	const double seconds = static_cast<double>(SDL_GetPerformanceCounter() - startCounter) / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	Logger::Log(std::to_string(numShapes) + " boxes and circles: " + std::to_string(pairs.size()) + " candidate pairs, " + std::to_string(contacts.size()) + " collide, "
+		+ std::to_string(seconds * 1000.0 / NARROWPHASE_BENCHMARK_ROUNDS) + " ms per frame, "
+		+ std::to_string(static_cast<double>(pairs.size()) * NARROWPHASE_BENCHMARK_ROUNDS / seconds / 1000000.0) + " million tests per second on one core");
+	return true;
+}
+
+bool RunContinuousCollisionBenchmark(int numBodies) {
+	const float worldSize = std::sqrt(numBodies * COLLISION_BENCHMARK_AREA_PER_BOX);
+	double baseMilliseconds = 0.0;
+	for (float fastRate : CONTINUOUS_COLLISION_BENCHMARK_FAST_RATES) {
+		// The same bodies every time, only the share of fast ones changes
+		Random random(1);
+		auto registry = std::make_unique<Registry>();
+		registry->AddSystem<MovementSystem>();
+		registry->AddSystem<CollisionSystem>();
+		for (int i = 0; i < numBodies; i++) {
+			const glm::vec2 position(random.Range(0.0f, worldSize), random.Range(0.0f, worldSize));
+			const float angle = random.Range(0.0f, 6.2831853f);
+			const float speed = random.NextFloat() < fastRate ? random.Range(1.0f, 2.0f) * CONTINUOUS_COLLISION_BENCHMARK_FAST_SPEED : random.Range(0.0f, 100.0f);
+
+			Entity body = registry->CreateEntity();
+			body.AddComponent<TransformComponent>(position);
+			body.AddComponent<BoxColliderComponent>(random.Range(32, 64), random.Range(32, 64));
+			body.AddComponent<RigidBodyComponent>(glm::vec2(std::cos(angle), std::sin(angle)) * speed);
+		}
+		registry->Update();
+
+		auto& movementSystem = registry->GetSystem<MovementSystem>();
+		auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+		Uint64 collisionCounter = 0;
+		size_t numCollisions = 0;
+		for (int frame = 0; frame < COLLISION_BENCHMARK_FRAMES; frame++) {
+			movementSystem.Update(COLLISION_BENCHMARK_DELTA_TIME);
+			const Uint64 startCounter = SDL_GetPerformanceCounter();
+			collisionSystem.Update(movementSystem);
+			collisionCounter += SDL_GetPerformanceCounter() - startCounter;
+			numCollisions += collisionSystem.GetCollisions().size();
+		}
+
+		const double milliseconds = static_cast<double>(collisionCounter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()) / COLLISION_BENCHMARK_FRAMES;
+		if (fastRate == 0.0f) {
+			baseMilliseconds = milliseconds;
+		}
+		Logger::Log(std::to_string(numBodies) + " bodies, " + std::to_string(static_cast<int>(fastRate * 100.0f + 0.5f)) + "% fast movers: "
+			+ std::to_string(milliseconds) + " ms per collision pass (+" + std::to_string(milliseconds - baseMilliseconds) + " ms for the sweeps), "
+			+ std::to_string(numCollisions / COLLISION_BENCHMARK_FRAMES) + " collisions per frame");
+	}
+	return true;
+}
@@ -0,0 +1,115 @@
+#include "Benchmarks.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/CollisionEvent.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Logger/Logger.h"
+#include <SDL.h>
+#include <algorithm>
+#include <string>
+
+const int EVENT_BENCHMARK_FRAMES = 10;
+// The dispatch swaps the queue's buffers, so the first two frames grow both of them. They are run but not timed.
+const int EVENT_BENCHMARK_WARMUP_FRAMES = 2;
+// Events emitted by each job of the parallel loop, which is also its producer
+const int EVENT_BENCHMARK_BATCH_SIZE = 16384;
+
+// Counts what it receives, so the handlers can't be optimized away
+class EventBenchmarkListener {
+private:
+	size_t numEvents;
+	int entitySum;
+
+public:
+	EventBenchmarkListener() {
+		numEvents = 0;
+		entitySum = 0;
+	}
+
+	void OnCollision(const CollisionEvent& event) {
+		numEvents++;
+		entitySum += event.entityA;
+	}
+
+	void OnCollisions(const CollisionEvent* events, size_t numEvents) {
+		this->numEvents += numEvents;
+		for (size_t i = 0; i < numEvents; i++) {
+			entitySum += events[i].entityB;
+		}
+	}
+
+	size_t GetNumEvents() const {
+		return numEvents;
+	}
+};
+
+static double GetMillisecondsPerFrame(Uint64 counter) {
+	return static_cast<double>(counter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency()) / EVENT_BENCHMARK_FRAMES;
+}
+
+bool RunEventBenchmark(int numEvents) {
+	JobSystem jobSystem;
+	EventBus eventBus;
+	EventBenchmarkListener listener;
+	EventBenchmarkListener batchListener;
+	eventBus.SubscribeToEvent<CollisionEvent>(&listener, &EventBenchmarkListener::OnCollision);
+	eventBus.SubscribeToEventBatch<CollisionEvent>(&batchListener, &EventBenchmarkListener::OnCollisions);
+
+	const int numProducers = (numEvents + EVENT_BENCHMARK_BATCH_SIZE - 1) / EVENT_BENCHMARK_BATCH_SIZE;
+	Uint64 emitCounter = 0;
+	Uint64 queueEmitCounter = 0;
+	Uint64 producerEmitCounter = 0;
+	Uint64 dispatchCounter = 0;
+	for (int frame = 0; frame < EVENT_BENCHMARK_WARMUP_FRAMES + EVENT_BENCHMARK_FRAMES; frame++) {
+		if (frame == EVENT_BENCHMARK_WARMUP_FRAMES) {
+			emitCounter = 0;
+			queueEmitCounter = 0;
+			producerEmitCounter = 0;
+			dispatchCounter = 0;
+		}
+
+		// The same events three ways: looked up for every event, through a kept queue, and from the jobs
+		Uint64 startCounter = SDL_GetPerformanceCounter();
+		for (int i = 0; i < numEvents; i++) {
+			eventBus.EmitEvent<CollisionEvent>(i, i + 1, true);
+		}
+		emitCounter += SDL_GetPerformanceCounter() - startCounter;
+		eventBus.ClearEvents();
+
+		startCounter = SDL_GetPerformanceCounter();
+		auto& eventQueue = eventBus.GetEventQueue<CollisionEvent>();
+		for (int i = 0; i < numEvents; i++) {
+			eventQueue.Emit(CollisionEvent(i, i + 1, true));
+		}
+		queueEmitCounter += SDL_GetPerformanceCounter() - startCounter;
+		eventBus.ClearEvents();
+
+		startCounter = SDL_GetPerformanceCounter();
+		eventBus.ReserveEventProducers<CollisionEvent>(numProducers);
+		jobSystem.ParallelFor(numEvents, EVENT_BENCHMARK_BATCH_SIZE, [&eventBus](int first, int last) {
+			const int producer = first / EVENT_BENCHMARK_BATCH_SIZE;
+			for (int i = first; i < last; i++) {
+				eventBus.EmitEventFrom<CollisionEvent>(producer, i, i + 1, true);
+			}
+		});
+		producerEmitCounter += SDL_GetPerformanceCounter() - startCounter;
+
+		// The producers are merged by the dispatch, both handlers receive every event
+		startCounter = SDL_GetPerformanceCounter();
+		eventBus.DispatchEvents();
+		dispatchCounter += SDL_GetPerformanceCounter() - startCounter;
+	}
+
+	const size_t numExpectedEvents = static_cast<size_t>(numEvents) * (EVENT_BENCHMARK_WARMUP_FRAMES + EVENT_BENCHMARK_FRAMES);
+	Logger::Log(std::to_string(numEvents) + " events per frame: " + std::to_string(GetMillisecondsPerFrame(emitCounter)) + " ms to emit with EmitEvent(), "
+		+ std::to_string(GetMillisecondsPerFrame(queueEmitCounter)) + " ms through a kept queue, "
+		+ std::to_string(GetMillisecondsPerFrame(producerEmitCounter)) + " ms from " + std::to_string(numProducers) + " producers on " + std::to_string(jobSystem.GetNumThreads()) + " threads");
+	Logger::Log(std::to_string(numEvents) + " events per frame: " + std::to_string(GetMillisecondsPerFrame(dispatchCounter)) + " ms to dispatch to a per-event and a batch handler, "
+		+ std::to_string(numEvents / GetMillisecondsPerFrame(dispatchCounter) / 1000.0) + " million events per second");
+
+	if (listener.GetNumEvents() != numExpectedEvents || batchListener.GetNumEvents() != numExpectedEvents) {
+		Logger::Err("The handlers received " + std::to_string(listener.GetNumEvents()) + " and " + std::to_string(batchListener.GetNumEvents())
+			+ " events instead of " + std::to_string(numExpectedEvents));
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#include "Benchmarks.h"
+#include "../Components/BoidComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Logger/Logger.h"
+#include "../Systems/FlockingSystem.h"
+#include "../Systems/MovementSystem.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+
+const int FLOCKING_BENCHMARK_TICKS = 60;
+const float FLOCKING_BENCHMARK_DELTA_TIME = 1.0f / 60.0f;
+// Each agent gets this much of the world, so an agent has about a dozen others in its neighbour radius
+const float FLOCKING_BENCHMARK_AREA_PER_AGENT = 32.0f * 32.0f;
+const int FLOCKING_BENCHMARK_FLOCKS = 4;
+
+bool RunFlockingBenchmark(int numAgents) {
+	const float worldSize = std::sqrt(numAgents * FLOCKING_BENCHMARK_AREA_PER_AGENT);
+
+	JobSystem jobSystem;
+	auto registry = std::make_unique<Registry>();
+	registry->AddSystem<MovementSystem>();
+	registry->AddSystem<FlockingSystem>();
+
+	Random random(1);
+	for (int i = 0; i < numAgents; i++) {
+		const glm::vec2 position(random.Range(0.0f, worldSize), random.Range(0.0f, worldSize));
+		const glm::vec2 velocity(random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f));
+
+		Entity agent = registry->CreateEntity();
+		agent.AddComponent<TransformComponent>(position);
+		agent.AddComponent<RigidBodyComponent>(velocity);
+		agent.AddComponent<BoidComponent>(random.Range(0, FLOCKING_BENCHMARK_FLOCKS - 1));
+	}
+	registry->Update();
+
+	auto& movementSystem = registry->GetSystem<MovementSystem>();
+	auto& flockingSystem = registry->GetSystem<FlockingSystem>();
+	Uint64 flockingCounter = 0;
+	Uint64 maxFlockingCounter = 0;
+	for (int tick = 0; tick < FLOCKING_BENCHMARK_TICKS; tick++) {
+		const Uint64 startCounter = SDL_GetPerformanceCounter();
+		flockingSystem.Update(FLOCKING_BENCHMARK_DELTA_TIME, jobSystem, movementSystem);
+		const Uint64 tickCounter = SDL_GetPerformanceCounter() - startCounter;
+		flockingCounter += tickCounter;
+		maxFlockingCounter = std::max(maxFlockingCounter, tickCounter);
+		movementSystem.Update(FLOCKING_BENCHMARK_DELTA_TIME);
+	}
+
+	const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	Logger::Log(std::to_string(numAgents) + " agents on " + std::to_string(jobSystem.GetNumThreads()) + " threads: "
+		+ std::to_string(static_cast<double>(flockingCounter) * 1000.0 / frequency / FLOCKING_BENCHMARK_TICKS) + " ms per flocking tick, "
+		+ std::to_string(static_cast<double>(maxFlockingCounter) * 1000.0 / frequency) + " ms for the slowest one");
+	return true;
+}
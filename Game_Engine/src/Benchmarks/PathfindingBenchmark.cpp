@@ -0,0 +1,140 @@
+#include "Benchmarks.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Logger/Logger.h"
+#include "../Navigation/HierarchicalGraph.h"
+#include "../Navigation/HierarchicalPathSearch.h"
+#include "../Navigation/NavGrid.h"
+#include "../Navigation/PathSearch.h"
+#include "../Navigation/PathfindingService.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+const int PATHFINDING_BENCHMARK_MAP_SIZE = 2048;
+const float PATHFINDING_BENCHMARK_CELL_SIZE = 32.0f;
+// Share of the map covered by blocks of 1 to 8 tiles a side, 4.5 on average
+const float PATHFINDING_BENCHMARK_BLOCKED_RATE = 0.25f;
+const float PATHFINDING_BENCHMARK_BLOCK_AREA = 4.5f * 4.5f;
+// Flat A* is far slower on a map this size, it only searches the first queries to compare
+const int PATHFINDING_BENCHMARK_FLAT_QUERIES = 20;
+const int PATHFINDING_BENCHMARK_TILE_CHANGES = 100;
+// Same budget as the game gives the pathfinding every frame
+const double PATHFINDING_BENCHMARK_BUDGET = 2.0;
+
+static double GetMilliseconds(Uint64 counter) {
+	return static_cast<double>(counter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+// The map has a single cost, so the cost of a path is its length
+static float GetPathLength(const std::vector<glm::ivec2>& waypoints) {
+	float length = 0.0f;
+	for (size_t i = 1; i < waypoints.size(); i++) {
+		length += GetOctileDistance(waypoints[i].x - waypoints[i - 1].x, waypoints[i].y - waypoints[i - 1].y);
+	}
+	return length;
+}
+
+static glm::ivec2 GetRandomWalkableCell(const NavGrid& grid, Random& random) {
+	glm::ivec2 cell;
+	do {
+		cell = glm::ivec2(random.Range(0, grid.GetNumCols() - 1), random.Range(0, grid.GetNumRows() - 1));
+	} while (!grid.IsWalkable(cell.x, cell.y));
+	return cell;
+}
+
+bool RunPathfindingBenchmark(int numQueries) {
+	const int mapSize = PATHFINDING_BENCHMARK_MAP_SIZE;
+	Random random(1);
+	NavGrid grid;
+	grid.Build(mapSize, mapSize, PATHFINDING_BENCHMARK_CELL_SIZE);
+	const int numBlocks = static_cast<int>(mapSize * mapSize * PATHFINDING_BENCHMARK_BLOCKED_RATE / PATHFINDING_BENCHMARK_BLOCK_AREA);
+	for (int i = 0; i < numBlocks; i++) {
+		const int col = random.Range(0, mapSize - 1);
+		const int row = random.Range(0, mapSize - 1);
+		const int width = random.Range(1, 8);
+		const int height = random.Range(1, 8);
+		for (int y = row; y < std::min(row + height, mapSize); y++) {
+			for (int x = col; x < std::min(col + width, mapSize); x++) {
+				grid.SetCost(x, y, NAV_BLOCKED);
+			}
+		}
+	}
+
+	JobSystem jobSystem;
+	HierarchicalGraph graph;
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	graph.Build(grid, &jobSystem);
+	const double buildMilliseconds = GetMilliseconds(SDL_GetPerformanceCounter() - startCounter);
+	Logger::Log(std::to_string(mapSize) + "x" + std::to_string(mapSize) + " map: the graph of " + std::to_string(graph.GetNumClusters()) + " clusters and "
+		+ std::to_string(graph.GetNumNodes()) + " nodes was built in " + std::to_string(buildMilliseconds) + " ms on " + std::to_string(jobSystem.GetNumThreads()) + " threads");
+
+	std::vector<glm::ivec2> starts(numQueries);
+	std::vector<glm::ivec2> goals(numQueries);
+	for (int i = 0; i < numQueries; i++) {
+		starts[i] = GetRandomWalkableCell(grid, random);
+		goals[i] = GetRandomWalkableCell(grid, random);
+	}
+
+	HierarchicalPathSearch hierarchicalSearch;
+	std::vector<glm::ivec2> waypoints;
+	std::vector<float> lengths(numQueries, 0.0f);
+	int numFound = 0;
+	startCounter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numQueries; i++) {
+		if (hierarchicalSearch.FindPath(grid, graph, starts[i], goals[i], waypoints)) {
+			lengths[i] = GetPathLength(waypoints);
+			numFound++;
+		}
+	}
+	const double hierarchicalMilliseconds = GetMilliseconds(SDL_GetPerformanceCounter() - startCounter);
+	Logger::Log(std::to_string(numQueries) + " hierarchical queries: " + std::to_string(hierarchicalMilliseconds / numQueries) + " ms per query, "
+		+ std::to_string(numFound) + " paths found");
+
+	// Flat A* finds the shortest paths, the hierarchical ones are compared to them
+	PathSearch search;
+	const int numFlatQueries = std::min(numQueries, PATHFINDING_BENCHMARK_FLAT_QUERIES);
+	float flatLength = 0.0f;
+	float hierarchicalLength = 0.0f;
+	startCounter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numFlatQueries; i++) {
+		if (search.FindPathAStar(grid, starts[i], goals[i], waypoints)) {
+			flatLength += GetPathLength(waypoints);
+			hierarchicalLength += lengths[i];
+		}
+	}
+	const double flatMilliseconds = GetMilliseconds(SDL_GetPerformanceCounter() - startCounter);
+	Logger::Log(std::to_string(numFlatQueries) + " flat A* queries: " + std::to_string(flatMilliseconds / std::max(numFlatQueries, 1)) + " ms per query, the hierarchical paths are "
+		+ std::to_string(flatLength > 0.0f ? hierarchicalLength / flatLength : 1.0f) + " times longer");
+
+	// The changed tiles dirty their clusters, the service rebuilds them within its budget and only
+	// holds back the paths that go through them
+	grid.SetCellChangedCallback([&graph](int col, int row) { graph.OnCellChanged(col, row); });
+	for (int i = 0; i < PATHFINDING_BENCHMARK_TILE_CHANGES; i++) {
+		const int col = random.Range(0, mapSize - 1);
+		const int row = random.Range(0, mapSize - 1);
+		grid.SetCost(col, row, grid.IsWalkable(col, row) ? NAV_BLOCKED : NAV_DEFAULT_COST);
+	}
+
+	PathfindingService pathfinding(grid);
+	pathfinding.SetHierarchicalGraph(&graph);
+	int numFrames = 0;
+	int answeredFrame = 0;
+	pathfinding.RequestPath(grid.CellToWorld(starts[0].x, starts[0].y), grid.CellToWorld(goals[0].x, goals[0].y), [&numFrames, &answeredFrame](const PathResult&) {
+		answeredFrame = numFrames;
+	});
+	Uint64 maxFrameCounter = 0;
+	startCounter = SDL_GetPerformanceCounter();
+	while (answeredFrame == 0 || graph.IsDirty()) {
+		const Uint64 frameStartCounter = SDL_GetPerformanceCounter();
+		numFrames++;
+		pathfinding.Update(jobSystem, PATHFINDING_BENCHMARK_BUDGET);
+		maxFrameCounter = std::max(maxFrameCounter, SDL_GetPerformanceCounter() - frameStartCounter);
+	}
+	Logger::Log(std::to_string(PATHFINDING_BENCHMARK_TILE_CHANGES) + " tile changes: the graph was rebuilt over " + std::to_string(numFrames) + " frames in "
+		+ std::to_string(GetMilliseconds(SDL_GetPerformanceCounter() - startCounter)) + " ms, the path was answered on frame " + std::to_string(answeredFrame)
+		+ ", the longest frame took " + std::to_string(GetMilliseconds(maxFrameCounter)) + " ms");
+	return numFound > 0;
+}
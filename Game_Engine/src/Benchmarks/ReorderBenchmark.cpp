@@ -0,0 +1,136 @@
+#include "Benchmarks.h"
+#include "../Collision/Broadphase.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementSystem.h"
+#include "../Systems/SpatialQuerySystem.h"
+#include "../Systems/SpatialReorderSystem.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+const int REORDER_BENCHMARK_FRAMES = 60;
+const float REORDER_BENCHMARK_DELTA_TIME = 1.0f / 60.0f;
+// Each entity gets this much of the world on average, like the boxes of the broadphase benchmark
+const float REORDER_BENCHMARK_AREA_PER_ENTITY = 200.0f * 200.0f;
+// Cameras looking at different places of the world in each frame, the size of the window
+const int REORDER_BENCHMARK_VIEWS = 64;
+const glm::vec2 REORDER_BENCHMARK_VIEW_SIZE = glm::vec2(1280.0f, 720.0f);
+const int REORDER_BENCHMARK_MAX_VISIBLE = 4096;
+
+struct ReorderBenchmarkTimes {
+	double collisionMilliseconds;
+	double renderMilliseconds;
+	size_t numVisible;
+	double pixelsDrawn;
+};
+
+// Finds the sprites in view and reads the components that the render system draws them with,
+// the way a culled render pass would. Returns the number of visible sprites and adds the area they cover.
+static int CullSprites(Registry& registry, const SpatialQuerySystem& spatialQuery, const AABB& view, std::vector<int>& entityIDs, double& pixelsDrawn) {
+	const int numVisible = spatialQuery.QueryAABB(view, entityIDs.data(), static_cast<int>(entityIDs.size()));
+	for (int i = 0; i < numVisible; i++) {
+		Entity entity(entityIDs[i]);
+		entity.registry = &registry;
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		const auto& sprite = entity.GetComponent<SpriteComponent>();
+
+		// the destination rectangle, clipped to the view
+		const glm::vec2 min = glm::max(transform.position, view.min);
+		const glm::vec2 max = glm::min(transform.position + glm::vec2(sprite.width, sprite.height) * transform.scale, view.max);
+		const glm::vec2 size = glm::max(max - min, glm::vec2(0.0f));
+		pixelsDrawn += size.x * size.y;
+	}
+	return numVisible;
+}
+
+// Runs the same frames on the entities in their current order, the views are the same for every call
+static ReorderBenchmarkTimes TimeReorderBenchmarkFrames(Registry& registry, float worldSize) {
+	auto& movementSystem = registry.GetSystem<MovementSystem>();
+	auto& collisionSystem = registry.GetSystem<CollisionSystem>();
+	auto& spatialQuery = registry.GetSystem<SpatialQuerySystem>();
+
+	// the first collision pass fills the broadphase, it is not timed
+	collisionSystem.Update(movementSystem);
+
+	Random random(2);
+	std::vector<int> entityIDs(REORDER_BENCHMARK_MAX_VISIBLE);
+	double pixelsDrawn = 0.0;
+	Uint64 collisionCounter = 0;
+	Uint64 renderCounter = 0;
+	size_t numVisible = 0;
+	for (int frame = 0; frame < REORDER_BENCHMARK_FRAMES; frame++) {
+		movementSystem.Update(REORDER_BENCHMARK_DELTA_TIME);
+		Uint64 startCounter = SDL_GetPerformanceCounter();
+		collisionSystem.Update(movementSystem);
+		collisionCounter += SDL_GetPerformanceCounter() - startCounter;
+
+		spatialQuery.Update();
+		startCounter = SDL_GetPerformanceCounter();
+		for (int i = 0; i < REORDER_BENCHMARK_VIEWS; i++) {
+			const glm::vec2 viewMin(random.Range(0.0f, worldSize - REORDER_BENCHMARK_VIEW_SIZE.x), random.Range(0.0f, worldSize - REORDER_BENCHMARK_VIEW_SIZE.y));
+			numVisible += CullSprites(registry, spatialQuery, { viewMin, viewMin + REORDER_BENCHMARK_VIEW_SIZE }, entityIDs, pixelsDrawn);
+		}
+		renderCounter += SDL_GetPerformanceCounter() - startCounter;
+	}
+
+	const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+	return {
+		static_cast<double>(collisionCounter) * 1000.0 / frequency / REORDER_BENCHMARK_FRAMES,
+		static_cast<double>(renderCounter) * 1000.0 / frequency / REORDER_BENCHMARK_FRAMES,
+		numVisible / (REORDER_BENCHMARK_FRAMES * REORDER_BENCHMARK_VIEWS),
+		pixelsDrawn / (REORDER_BENCHMARK_FRAMES * REORDER_BENCHMARK_VIEWS)
+	};
+}
+
+bool RunReorderBenchmark(int numEntities) {
+	if (REORDER_BENCHMARK_VIEW_SIZE.x * REORDER_BENCHMARK_VIEW_SIZE.y > numEntities * REORDER_BENCHMARK_AREA_PER_ENTITY) {
+		Logger::Err("The reorder benchmark needs a world larger than one view, use more entities");
+		return false;
+	}
+	const float worldSize = std::sqrt(numEntities * REORDER_BENCHMARK_AREA_PER_ENTITY);
+
+	auto registry = std::make_unique<Registry>();
+	registry->AddSystem<MovementSystem>();
+	registry->AddSystem<CollisionSystem>();
+	registry->AddSystem<SpatialQuerySystem>();
+	registry->AddSystem<SpatialReorderSystem>();
+
+	// The entities are created in random places, so their IDs say nothing of where they are
+	Random random(1);
+	for (int i = 0; i < numEntities; i++) {
+		const glm::vec2 position(random.Range(0.0f, worldSize), random.Range(0.0f, worldSize));
+		const glm::vec2 velocity(random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f));
+
+		Entity entity = registry->CreateEntity();
+		entity.AddComponent<TransformComponent>(position);
+		entity.AddComponent<RigidBodyComponent>(velocity);
+		entity.AddComponent<SpriteComponent>("tank-image", 32, 32, 1);
+		entity.AddComponent<BoxColliderComponent>(32, 32);
+	}
+	registry->Update();
+
+	const ReorderBenchmarkTimes before = TimeReorderBenchmarkFrames(*registry, worldSize);
+
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	registry->GetSystem<SpatialReorderSystem>().Update(*registry);
+	const double reorderMilliseconds = static_cast<double>(SDL_GetPerformanceCounter() - startCounter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+
+	const ReorderBenchmarkTimes after = TimeReorderBenchmarkFrames(*registry, worldSize);
+
+	Logger::Log(std::to_string(numEntities) + " entities in creation order: " + std::to_string(before.collisionMilliseconds) + " ms per collision pass, "
+		+ std::to_string(before.renderMilliseconds) + " ms to cull " + std::to_string(REORDER_BENCHMARK_VIEWS) + " views of " + std::to_string(before.numVisible) + " sprites (" + std::to_string(static_cast<int>(before.pixelsDrawn)) + " pixels)");
+	Logger::Log(std::to_string(numEntities) + " entities in Morton order: " + std::to_string(after.collisionMilliseconds) + " ms per collision pass, "
+		+ std::to_string(after.renderMilliseconds) + " ms to cull " + std::to_string(REORDER_BENCHMARK_VIEWS) + " views of " + std::to_string(after.numVisible) + " sprites (" + std::to_string(static_cast<int>(after.pixelsDrawn)) + " pixels), the reorder took "
+		+ std::to_string(reorderMilliseconds) + " ms");
+	return true;
+}
@@ -0,0 +1,102 @@
+#include "Benchmarks.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/MovementSystem.h"
+#include "../Systems/RenderSystem.h"
+#include "../Systems/SpatialQuerySystem.h"
+#include "../Utils/BinaryStream.h"
+#include "../Utils/Random.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+const int SNAPSHOT_BENCHMARK_REPEATS = 100;
+const int SNAPSHOT_BENCHMARK_TICKS = 3;
+const float SNAPSHOT_BENCHMARK_DELTA_TIME = 1.0f / 60.0f;
+const float SNAPSHOT_BENCHMARK_AREA_PER_ENTITY = 100.0f * 100.0f;
+
+static double GetMilliseconds(Uint64 counter) {
+	return static_cast<double>(counter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+bool RunSnapshotBenchmark(int numEntities) {
+	const float worldSize = std::sqrt(numEntities * SNAPSHOT_BENCHMARK_AREA_PER_ENTITY);
+
+	auto registry = std::make_unique<Registry>();
+	registry->AddSystem<MovementSystem>();
+	registry->AddSystem<RenderSystem>();
+	registry->AddSystem<CollisionSystem>();
+	registry->AddSystem<SpatialQuerySystem>();
+
+	// Every entity is drawn, one in two moves and collides, like the tanks among the trees of a level
+	Random random(1);
+	for (int i = 0; i < numEntities; i++) {
+		Entity entity = registry->CreateEntity();
+		entity.AddComponent<TransformComponent>(glm::vec2(random.Range(0.0f, worldSize), random.Range(0.0f, worldSize)));
+		entity.AddComponent<SpriteComponent>(i % 2 == 0 ? "tank-image" : "tree-image", 32, 32, 1);
+		if (i % 2 == 0) {
+			entity.AddComponent<RigidBodyComponent>(glm::vec2(random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f)));
+			entity.AddComponent<BoxColliderComponent>(32, 32);
+		}
+	}
+	registry->Update();
+
+	// A few ticks, so the systems have state of their own to save
+	auto& movementSystem = registry->GetSystem<MovementSystem>();
+	for (int tick = 0; tick < SNAPSHOT_BENCHMARK_TICKS; tick++) {
+		movementSystem.Update(SNAPSHOT_BENCHMARK_DELTA_TIME);
+		registry->GetSystem<CollisionSystem>().Update(movementSystem);
+		registry->GetSystem<SpatialQuerySystem>().Update();
+	}
+
+	// The buffer keeps its capacity like the rollback ring does, only the first save allocates
+	std::vector<uint8_t> snapshot;
+	Uint64 saveCounter = 0;
+	Uint64 loadCounter = 0;
+	for (int i = 0; i < SNAPSHOT_BENCHMARK_REPEATS; i++) {
+		snapshot.clear();
+		Uint64 startCounter = SDL_GetPerformanceCounter();
+		{
+			BinaryWriter writer(snapshot);
+			registry->SaveSnapshot(writer);
+		}
+		saveCounter += SDL_GetPerformanceCounter() - startCounter;
+
+		startCounter = SDL_GetPerformanceCounter();
+		BinaryReader reader(snapshot.data(), snapshot.size());
+		const bool isLoaded = registry->LoadSnapshot(reader);
+		loadCounter += SDL_GetPerformanceCounter() - startCounter;
+		if (!isLoaded) {
+			Logger::Err("The snapshot benchmark could not restore its own snapshot");
+			return false;
+		}
+	}
+
+	// A restored registry saves the same bytes again
+	std::vector<uint8_t> savedAgain;
+	{
+		BinaryWriter writer(savedAgain);
+		registry->SaveSnapshot(writer);
+	}
+
+	const double saveMilliseconds = GetMilliseconds(saveCounter) / SNAPSHOT_BENCHMARK_REPEATS;
+	const double loadMilliseconds = GetMilliseconds(loadCounter) / SNAPSHOT_BENCHMARK_REPEATS;
+	Logger::Log(std::to_string(numEntities) + " entities: snapshot of " + std::to_string(snapshot.size()) + " bytes, "
+		+ std::to_string(saveMilliseconds) + " ms to save, " + std::to_string(loadMilliseconds) + " ms to restore, "
+		+ std::to_string(saveMilliseconds + loadMilliseconds) + " ms for both");
+
+	if (savedAgain != snapshot) {
+		Logger::Err("The snapshot saved after a restore is different from the restored one");
+		return false;
+	}
+	return true;
+}
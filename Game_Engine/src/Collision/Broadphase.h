@@ -0,0 +1,65 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+/// <summary>
+/// Axis aligned bounding box in world coordinates
+/// </summary>
+struct AABB {
+	glm::vec2 min;
+	glm::vec2 max;
+
+	bool Overlaps(const AABB& other) const {
+		return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y;
+	}
+};
+
+/// <summary>
+/// Two entities whose bounds overlap, entityA is always the lowest ID
+/// </summary>
+struct CollisionPair {
+	int entityA;
+	int entityB;
+
+	// Same pair with the new IDs of the entities, entityA is still the lowest
+	CollisionPair Remap(const std::vector<int>& newIDs) const {
+		const int newA = newIDs[entityA];
+		const int newB = newIDs[entityB];
+		return newA < newB ? CollisionPair{ newA, newB } : CollisionPair{ newB, newA };
+	}
+
+	bool operator == (const CollisionPair& other) const { return entityA == other.entityA && entityB == other.entityB; }
+	bool operator < (const CollisionPair& other) const { return entityA < other.entityA || (entityA == other.entityA && entityB < other.entityB); }
+};
+
+enum BroadphaseType {
+	BROADPHASE_SPATIAL_HASH,
+	BROADPHASE_SWEEP_AND_PRUNE
+};
+
+/// <summary>
+/// The broadphase keeps a proxy (the bounds) of every collider, and quickly finds
+/// the pairs of proxies that overlap so the narrowphase only tests those.
+/// </summary>
+class Broadphase {
+public:
+	virtual ~Broadphase() = default;
+
+	// Adds the proxy of the entity the first time, or moves it to the new bounds
+	virtual void UpdateProxy(int entityID, const AABB& bounds) = 0;
+	virtual void RemoveProxy(int entityID) = 0;
+
+	// Brings the pairs up to date with the proxies, and replaces the content of addedPairs and
+	// removedPairs with the pairs that started or stopped overlapping since the last call
+	virtual void UpdatePairs(std::vector<CollisionPair>& addedPairs, std::vector<CollisionPair>& removedPairs) = 0;
+
+	// Every pair of proxies that overlapped at the last UpdatePairs()
+	virtual const std::vector<CollisionPair>& GetPairs() const = 0;
+
+	// Moves every proxy and pair to the new ID of its entity, newIDs[old ID]
+	virtual void RemapProxies(const std::vector<int>& newIDs) = 0;
+};
+
+#endif // !BROADPHASE_H
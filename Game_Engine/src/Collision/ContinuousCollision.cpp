@@ -0,0 +1,43 @@
+#include "ContinuousCollision.h"
+#include <algorithm>
+#include <limits>
+
+bool SweepAABB(const AABB& moving, const glm::vec2& motion, const AABB& target, SweepHit& hit) {
+	// Slab test: on each axis find when the boxes start and stop overlapping,
+	// they touch when the latest start comes before the earliest stop
+	float entryTimes[2];
+	float exitTimes[2];
+	for (int axis = 0; axis < 2; axis++) {
+		if (motion[axis] > 0.0f) {
+			entryTimes[axis] = (target.min[axis] - moving.max[axis]) / motion[axis];
+			exitTimes[axis] = (target.max[axis] - moving.min[axis]) / motion[axis];
+		}
+		else if (motion[axis] < 0.0f) {
+			entryTimes[axis] = (target.max[axis] - moving.min[axis]) / motion[axis];
+			exitTimes[axis] = (target.min[axis] - moving.max[axis]) / motion[axis];
+		}
+		else if (moving.max[axis] < target.min[axis] || moving.min[axis] > target.max[axis]) {
+			return false;
+		}
+		else {
+			entryTimes[axis] = -std::numeric_limits<float>::infinity();
+			exitTimes[axis] = std::numeric_limits<float>::infinity();
+		}
+	}
+
+	const int entryAxis = entryTimes[0] > entryTimes[1] ? 0 : 1;
+	const float entryTime = entryTimes[entryAxis];
+	const float exitTime = std::min(exitTimes[0], exitTimes[1]);
+	if (entryTime > exitTime || entryTime < 0.0f || entryTime > 1.0f) {
+		return false;
+	}
+
+	hit.timeOfImpact = entryTime;
+	hit.normal = glm::vec2(0);
+	hit.normal[entryAxis] = motion[entryAxis] > 0.0f ? -1.0f : 1.0f;
+	return true;
+}
+
+AABB MergeAABB(const AABB& a, const AABB& b) {
+	return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
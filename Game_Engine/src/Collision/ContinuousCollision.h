@@ -0,0 +1,23 @@
+#ifndef CONTINUOUSCOLLISION_H
+#define CONTINUOUSCOLLISION_H
+
+#include "Broadphase.h"
+#include <glm/glm.hpp>
+
+/// <summary>
+/// First contact of a box moving along a straight line: the fraction of the motion done
+/// when it touches the target, and the normal of the target face that was hit
+/// </summary>
+struct SweepHit {
+	float timeOfImpact;
+	glm::vec2 normal;
+};
+
+// Sweeps moving by motion against a static target. Returns false when they don't touch during the
+// motion, or when they already overlap at the start (the discrete test handles that case).
+bool SweepAABB(const AABB& moving, const glm::vec2& motion, const AABB& target, SweepHit& hit);
+
+// Smallest box that contains both boxes
+AABB MergeAABB(const AABB& a, const AABB& b);
+
+#endif // !CONTINUOUSCOLLISION_H
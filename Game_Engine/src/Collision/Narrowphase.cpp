@@ -0,0 +1,381 @@
+#include "Narrowphase.h"
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Utils/SIMD.h"
+#include <cmath>
+
+// Number of box pairs tested together by one SSE instruction
+const int NARROWPHASE_BATCH_SIZE = SIMD_WIDTH;
+
+AABB CollisionShape::GetBounds() const {
+	glm::vec2 extents;
+	if (type == SHAPE_CIRCLE) {
+		extents = glm::vec2(radius);
+	}
+	else {
+		// the rotated box is contained in the box made of its projections on the x and y axes
+		extents.x = std::fabs(axisX.x) * halfExtents.x + std::fabs(axisX.y) * halfExtents.y;
+		extents.y = std::fabs(axisX.y) * halfExtents.x + std::fabs(axisX.x) * halfExtents.y;
+	}
+	return { center - extents, center + extents };
+}
+
+void Narrowphase::BoxPairBatch::Clear() {
+	pairIndices.clear();
+	deltaX.clear();
+	deltaY.clear();
+	axisXA.clear();
+	axisYA.clear();
+	halfWidthA.clear();
+	halfHeightA.clear();
+	axisXB.clear();
+	axisYB.clear();
+	halfWidthB.clear();
+	halfHeightB.clear();
+}
+
+void Narrowphase::BoxPairBatch::Add(int pairIndex, const CollisionShape& shapeA, const CollisionShape& shapeB) {
+	pairIndices.push_back(pairIndex);
+	deltaX.push_back(shapeB.center.x - shapeA.center.x);
+	deltaY.push_back(shapeB.center.y - shapeA.center.y);
+	axisXA.push_back(shapeA.axisX.x);
+	axisYA.push_back(shapeA.axisX.y);
+	halfWidthA.push_back(shapeA.halfExtents.x);
+	halfHeightA.push_back(shapeA.halfExtents.y);
+	axisXB.push_back(shapeB.axisX.x);
+	axisYB.push_back(shapeB.axisX.y);
+	halfWidthB.push_back(shapeB.halfExtents.x);
+	halfHeightB.push_back(shapeB.halfExtents.y);
+}
+
+void Narrowphase::BoxPairBatch::Pad() {
+	// fills the last batch with two empty boxes far from each other, they never collide
+	CollisionShape farShape = { SHAPE_BOX, glm::vec2(0), glm::vec2(1, 0), glm::vec2(0), 0.0f };
+	CollisionShape nearShape = farShape;
+	farShape.center = glm::vec2(1.0e6f);
+	while (pairIndices.size() % NARROWPHASE_BATCH_SIZE != 0) {
+		Add(-1, nearShape, farShape);
+	}
+	penetrations.resize(pairIndices.size());
+	bestAxes.resize(pairIndices.size());
+}
+
+void Narrowphase::SetShape(int entityID, const CollisionShape& shape) {
+	if (entityID >= static_cast<int>(shapes.size())) {
+		shapes.resize(entityID + 1, { SHAPE_NONE, glm::vec2(0), glm::vec2(1, 0), glm::vec2(0), 0.0f });
+	}
+	shapes[entityID] = shape;
+}
+
+void Narrowphase::RemoveShape(int entityID) {
+	if (entityID < static_cast<int>(shapes.size())) {
+		shapes[entityID].type = SHAPE_NONE;
+	}
+}
+
+const CollisionShape& Narrowphase::GetShape(int entityID) const {
+	return shapes[entityID];
+}
+
+void Narrowphase::RemapShapes(const std::vector<int>& newIDs) {
+	RemapEntityVector(shapes, newIDs, { SHAPE_NONE, glm::vec2(0), glm::vec2(1, 0), glm::vec2(0), 0.0f });
+}
+
+// Separating axis test of two oriented boxes. In 2D the rotation between the boxes is a single
+// angle, so the four axes (width and height of A, then of B) only need |cos| and |sin| of it.
+void Narrowphase::TestBoxPairs(int first, int last) {
+	for (int i = first; i < last; i++) {
+		const float dx = boxPairs.deltaX[i];
+		const float dy = boxPairs.deltaY[i];
+		const float uxA = boxPairs.axisXA[i], uyA = boxPairs.axisYA[i];
+		const float uxB = boxPairs.axisXB[i], uyB = boxPairs.axisYB[i];
+		const float hwA = boxPairs.halfWidthA[i], hhA = boxPairs.halfHeightA[i];
+		const float hwB = boxPairs.halfWidthB[i], hhB = boxPairs.halfHeightB[i];
+
+		const float c = std::fabs(uxA * uxB + uyA * uyB);
+		const float s = std::fabs(uyA * uxB - uxA * uyB);
+
+		const float overlaps[4] = {
+			hwA + hwB * c + hhB * s - std::fabs(dx * uxA + dy * uyA),
+			hhA + hwB * s + hhB * c - std::fabs(dy * uxA - dx * uyA),
+			hwA * c + hhA * s + hwB - std::fabs(dx * uxB + dy * uyB),
+			hwA * s + hhA * c + hhB - std::fabs(dy * uxB - dx * uyB)
+		};
+
+		float penetration = overlaps[0];
+		int bestAxis = 0;
+		for (int axis = 1; axis < 4; axis++) {
+			if (overlaps[axis] < penetration) {
+				penetration = overlaps[axis];
+				bestAxis = axis;
+			}
+		}
+		boxPairs.penetrations[i] = penetration;
+		boxPairs.bestAxes[i] = bestAxis;
+	}
+}
+
+#ifdef USE_SSE2
+
+// Same test as TestBoxPairs(), each lane of the registers is one pair
+void Narrowphase::TestBoxPairsSIMD(int first, int last) {
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	for (int i = first; i < last; i += NARROWPHASE_BATCH_SIZE) {
+		const __m128 dx = _mm_loadu_ps(&boxPairs.deltaX[i]);
+		const __m128 dy = _mm_loadu_ps(&boxPairs.deltaY[i]);
+		const __m128 uxA = _mm_loadu_ps(&boxPairs.axisXA[i]);
+		const __m128 uyA = _mm_loadu_ps(&boxPairs.axisYA[i]);
+		const __m128 uxB = _mm_loadu_ps(&boxPairs.axisXB[i]);
+		const __m128 uyB = _mm_loadu_ps(&boxPairs.axisYB[i]);
+		const __m128 hwA = _mm_loadu_ps(&boxPairs.halfWidthA[i]);
+		const __m128 hhA = _mm_loadu_ps(&boxPairs.halfHeightA[i]);
+		const __m128 hwB = _mm_loadu_ps(&boxPairs.halfWidthB[i]);
+		const __m128 hhB = _mm_loadu_ps(&boxPairs.halfHeightB[i]);
+
+		const __m128 c = _mm_and_ps(absMask, _mm_add_ps(_mm_mul_ps(uxA, uxB), _mm_mul_ps(uyA, uyB)));
+		const __m128 s = _mm_and_ps(absMask, _mm_sub_ps(_mm_mul_ps(uyA, uxB), _mm_mul_ps(uxA, uyB)));
+
+		const __m128 overlap0 = _mm_sub_ps(
+			_mm_add_ps(hwA, _mm_add_ps(_mm_mul_ps(hwB, c), _mm_mul_ps(hhB, s))),
+			_mm_and_ps(absMask, _mm_add_ps(_mm_mul_ps(dx, uxA), _mm_mul_ps(dy, uyA))));
+		const __m128 overlap1 = _mm_sub_ps(
+			_mm_add_ps(hhA, _mm_add_ps(_mm_mul_ps(hwB, s), _mm_mul_ps(hhB, c))),
+			_mm_and_ps(absMask, _mm_sub_ps(_mm_mul_ps(dy, uxA), _mm_mul_ps(dx, uyA))));
+		const __m128 overlap2 = _mm_sub_ps(
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(hwA, c), _mm_mul_ps(hhA, s)), hwB),
+			_mm_and_ps(absMask, _mm_add_ps(_mm_mul_ps(dx, uxB), _mm_mul_ps(dy, uyB))));
+		const __m128 overlap3 = _mm_sub_ps(
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(hwA, s), _mm_mul_ps(hhA, c)), hhB),
+			_mm_and_ps(absMask, _mm_sub_ps(_mm_mul_ps(dy, uxB), _mm_mul_ps(dx, uyB))));
+
+		// keep the smallest overlap and its axis in every lane, without branches
+		__m128 penetration = overlap0;
+		__m128 bestAxis = _mm_setzero_ps();
+		const __m128 overlaps[3] = { overlap1, overlap2, overlap3 };
+		for (int axis = 0; axis < 3; axis++) {
+			const __m128 isSmaller = _mm_cmplt_ps(overlaps[axis], penetration);
+			penetration = _mm_or_ps(_mm_and_ps(isSmaller, overlaps[axis]), _mm_andnot_ps(isSmaller, penetration));
+			bestAxis = _mm_or_ps(_mm_and_ps(isSmaller, _mm_set1_ps(static_cast<float>(axis + 1))), _mm_andnot_ps(isSmaller, bestAxis));
+		}
+
+		_mm_storeu_ps(&boxPairs.penetrations[i], penetration);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&boxPairs.bestAxes[i]), _mm_cvttps_epi32(bestAxis));
+	}
+}
+
+#else
+
+void Narrowphase::TestBoxPairsSIMD(int first, int last) {
+	TestBoxPairs(first, last);
+}
+
+#endif
+
+// Keeps the part of the segment below the plane dot(normal, point) = offset
+static bool ClipSegment(glm::vec2 points[2], const glm::vec2& normal, float offset) {
+	const float distance0 = glm::dot(normal, points[0]) - offset;
+	const float distance1 = glm::dot(normal, points[1]) - offset;
+	if (distance0 > 0.0f && distance1 > 0.0f) {
+		return false;
+	}
+	if (distance0 > 0.0f) {
+		points[0] += (points[1] - points[0]) * (distance0 / (distance0 - distance1));
+	}
+	else if (distance1 > 0.0f) {
+		points[1] += (points[0] - points[1]) * (distance1 / (distance1 - distance0));
+	}
+	return true;
+}
+
+bool Narrowphase::CollideBoxes(int entityA, int entityB, int bestAxis, float penetration, ContactManifold& manifold) const {
+	// The box that owns the separating axis with the smallest overlap gives the reference face,
+	// the face of the other box that faces it the most is clipped against its sides
+	const bool isReferenceB = bestAxis >= 2;
+	const CollisionShape& reference = isReferenceB ? shapes[entityB] : shapes[entityA];
+	const CollisionShape& incident = isReferenceB ? shapes[entityA] : shapes[entityB];
+
+	const glm::vec2 referenceX = reference.axisX;
+	const glm::vec2 referenceY = glm::vec2(-referenceX.y, referenceX.x);
+	const bool isWidthAxis = bestAxis % 2 == 0;
+
+	glm::vec2 normal = isWidthAxis ? referenceX : referenceY;
+	const glm::vec2 side = isWidthAxis ? referenceY : referenceX;
+	const float normalExtent = isWidthAxis ? reference.halfExtents.x : reference.halfExtents.y;
+	const float sideExtent = isWidthAxis ? reference.halfExtents.y : reference.halfExtents.x;
+
+	if (glm::dot(incident.center - reference.center, normal) < 0.0f) {
+		normal = -normal;
+	}
+
+	const glm::vec2 incidentX = incident.axisX;
+	const glm::vec2 incidentY = glm::vec2(-incidentX.y, incidentX.x);
+	const float dotX = glm::dot(incidentX, normal);
+	const float dotY = glm::dot(incidentY, normal);
+
+	glm::vec2 faceNormal, faceTangent;
+	float faceExtent, tangentExtent;
+	if (std::fabs(dotX) > std::fabs(dotY)) {
+		faceNormal = dotX > 0.0f ? -incidentX : incidentX;
+		faceTangent = incidentY;
+		faceExtent = incident.halfExtents.x;
+		tangentExtent = incident.halfExtents.y;
+	}
+	else {
+		faceNormal = dotY > 0.0f ? -incidentY : incidentY;
+		faceTangent = incidentX;
+		faceExtent = incident.halfExtents.y;
+		tangentExtent = incident.halfExtents.x;
+	}
+
+	const glm::vec2 faceCenter = incident.center + faceNormal * faceExtent;
+	glm::vec2 points[2] = { faceCenter - faceTangent * tangentExtent, faceCenter + faceTangent * tangentExtent };
+
+	const float sideCenter = glm::dot(side, reference.center);
+	if (!ClipSegment(points, side, sideCenter + sideExtent) || !ClipSegment(points, -side, -sideCenter + sideExtent)) {
+		return false;
+	}
+
+	// only the clipped points that went through the reference face are touching
+	const float referenceFace = glm::dot(normal, reference.center) + normalExtent;
+	manifold.numPoints = 0;
+	for (const auto& point : points) {
+		if (glm::dot(normal, point) - referenceFace <= 0.0f) {
+			manifold.points[manifold.numPoints++] = point;
+		}
+	}
+	if (manifold.numPoints == 0) {
+		manifold.points[manifold.numPoints++] = glm::dot(normal, points[0]) < glm::dot(normal, points[1]) ? points[0] : points[1];
+	}
+
+	manifold.entityA = entityA;
+	manifold.entityB = entityB;
+	manifold.normal = isReferenceB ? -normal : normal;
+	manifold.penetration = penetration;
+	return true;
+}
+
+bool Narrowphase::CollideCircles(int entityA, int entityB, ContactManifold& manifold) const {
+	const CollisionShape& circleA = shapes[entityA];
+	const CollisionShape& circleB = shapes[entityB];
+
+	const glm::vec2 delta = circleB.center - circleA.center;
+	const float radii = circleA.radius + circleB.radius;
+	const float distanceSquared = glm::dot(delta, delta);
+	if (distanceSquared > radii * radii) {
+		return false;
+	}
+
+	const float distance = std::sqrt(distanceSquared);
+	manifold.entityA = entityA;
+	manifold.entityB = entityB;
+	manifold.normal = distance > 0.0f ? delta / distance : glm::vec2(1, 0);
+	manifold.penetration = radii - distance;
+	manifold.numPoints = 1;
+	manifold.points[0] = circleA.center + manifold.normal * (circleA.radius - manifold.penetration * 0.5f);
+	return true;
+}
+
+bool Narrowphase::CollideBoxCircle(int boxEntity, int circleEntity, ContactManifold& manifold) const {
+	const CollisionShape& box = shapes[boxEntity];
+	const CollisionShape& circle = shapes[circleEntity];
+
+	// work in the space of the box, where it is axis aligned
+	const glm::vec2 boxX = box.axisX;
+	const glm::vec2 boxY = glm::vec2(-boxX.y, boxX.x);
+	const glm::vec2 delta = circle.center - box.center;
+	const glm::vec2 local = glm::vec2(glm::dot(delta, boxX), glm::dot(delta, boxY));
+	const glm::vec2 closest = glm::clamp(local, -box.halfExtents, box.halfExtents);
+
+	manifold.entityA = boxEntity;
+	manifold.entityB = circleEntity;
+	manifold.numPoints = 1;
+
+	if (closest != local) {
+		const glm::vec2 outside = local - closest;
+		const float distanceSquared = glm::dot(outside, outside);
+		if (distanceSquared > circle.radius * circle.radius) {
+			return false;
+		}
+
+		const float distance = std::sqrt(distanceSquared);
+		const glm::vec2 localNormal = outside / distance;
+		manifold.normal = boxX * localNormal.x + boxY * localNormal.y;
+		manifold.penetration = circle.radius - distance;
+		manifold.points[0] = box.center + boxX * closest.x + boxY * closest.y;
+		return true;
+	}
+
+	// the center is inside the box: push the circle out through the closest face
+	const float gapX = box.halfExtents.x - std::fabs(local.x);
+	const float gapY = box.halfExtents.y - std::fabs(local.y);
+	if (gapX < gapY) {
+		const float sign = local.x < 0.0f ? -1.0f : 1.0f;
+		manifold.normal = boxX * sign;
+		manifold.penetration = circle.radius + gapX;
+		manifold.points[0] = box.center + boxX * (sign * box.halfExtents.x) + boxY * local.y;
+	}
+	else {
+		const float sign = local.y < 0.0f ? -1.0f : 1.0f;
+		manifold.normal = boxY * sign;
+		manifold.penetration = circle.radius + gapY;
+		manifold.points[0] = box.center + boxX * local.x + boxY * (sign * box.halfExtents.y);
+	}
+	return true;
+}
+
+void Narrowphase::Collide(const std::vector<CollisionPair>& pairs, std::vector<ContactManifold>& manifolds) {
+	PROFILE_FUNCTION();
+
+	manifolds.clear();
+	boxPairs.Clear();
+
+	ContactManifold manifold;
+	for (int i = 0; i < static_cast<int>(pairs.size()); i++) {
+		const CollisionPair& pair = pairs[i];
+		const CollisionShape& shapeA = shapes[pair.entityA];
+		const CollisionShape& shapeB = shapes[pair.entityB];
+
+		if (shapeA.type == SHAPE_BOX && shapeB.type == SHAPE_BOX) {
+			boxPairs.Add(i, shapeA, shapeB);
+		}
+		else if (shapeA.type == SHAPE_CIRCLE && shapeB.type == SHAPE_CIRCLE) {
+			if (CollideCircles(pair.entityA, pair.entityB, manifold)) {
+				manifolds.push_back(manifold);
+			}
+		}
+		else if (shapeA.type == SHAPE_BOX && shapeB.type == SHAPE_CIRCLE) {
+			if (CollideBoxCircle(pair.entityA, pair.entityB, manifold)) {
+				manifolds.push_back(manifold);
+			}
+		}
+		else if (shapeA.type == SHAPE_CIRCLE && shapeB.type == SHAPE_BOX) {
+			// the manifold keeps the order of the pair, so the normal is flipped
+			if (CollideBoxCircle(pair.entityB, pair.entityA, manifold)) {
+				manifold.entityA = pair.entityA;
+				manifold.entityB = pair.entityB;
+				manifold.normal = -manifold.normal;
+				manifolds.push_back(manifold);
+			}
+		}
+	}
+
+	const int numBoxPairs = static_cast<int>(boxPairs.pairIndices.size());
+	if (numBoxPairs == 0) {
+		return;
+	}
+
+	boxPairs.Pad();
+	TestBoxPairsSIMD(0, static_cast<int>(boxPairs.pairIndices.size()));
+
+	// manifolds are only built for the few pairs that really collide
+	for (int i = 0; i < numBoxPairs; i++) {
+		if (boxPairs.penetrations[i] < 0.0f) {
+			continue;
+		}
+		const CollisionPair& pair = pairs[boxPairs.pairIndices[i]];
+		if (CollideBoxes(pair.entityA, pair.entityB, boxPairs.bestAxes[i], boxPairs.penetrations[i], manifold)) {
+			manifolds.push_back(manifold);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "Broadphase.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+enum ShapeType {
+	SHAPE_NONE,
+	SHAPE_BOX,
+	SHAPE_CIRCLE
+};
+
+/// <summary>
+/// World space shape of a collider. Boxes are oriented: axisX is the direction of the box's
+/// width (cos, sin of the rotation) and the height follows the perpendicular axis.
+/// </summary>
+struct CollisionShape {
+	ShapeType type;
+	glm::vec2 center;
+	glm::vec2 axisX;
+	glm::vec2 halfExtents;
+	float radius;
+
+	// Axis aligned box that contains the whole shape, for the broadphase
+	AABB GetBounds() const;
+};
+
+/// <summary>
+/// Contact between two colliding shapes: the normal points from entityA to entityB,
+/// and there are one or two contact points (two when boxes touch edge to edge).
+/// </summary>
+struct ContactManifold {
+	int entityA;
+	int entityB;
+	glm::vec2 normal;
+	float penetration;
+	int numPoints;
+	glm::vec2 points[2];
+};
+
+/// <summary>
+/// Exact tests of the broadphase candidates with the separating axis theorem.
+/// The box pairs are the common case, so they are copied to structure-of-arrays batches and
+/// tested four at a time with SSE; only the pairs that collide build a manifold.
+/// </summary>
+class Narrowphase {
+private:
+	// [vector index = entity ID]
+	std::vector<CollisionShape> shapes;
+
+	// Box pairs waiting to be tested, one array per value so a batch loads with one instruction
+	struct BoxPairBatch {
+		std::vector<int> pairIndices;
+		std::vector<float> deltaX, deltaY;
+		std::vector<float> axisXA, axisYA, halfWidthA, halfHeightA;
+		std::vector<float> axisXB, axisYB, halfWidthB, halfHeightB;
+		// Results: penetration along the best axis (negative when separated), and that axis (0-3)
+		std::vector<float> penetrations;
+		std::vector<int> bestAxes;
+
+		void Clear();
+		void Add(int pairIndex, const CollisionShape& shapeA, const CollisionShape& shapeB);
+		void Pad();
+	};
+	BoxPairBatch boxPairs;
+
+	void TestBoxPairs(int first, int last);
+	void TestBoxPairsSIMD(int first, int last);
+	bool CollideBoxes(int entityA, int entityB, int bestAxis, float penetration, ContactManifold& manifold) const;
+	bool CollideCircles(int entityA, int entityB, ContactManifold& manifold) const;
+	bool CollideBoxCircle(int boxEntity, int circleEntity, ContactManifold& manifold) const;
+
+public:
+	Narrowphase() = default;
+
+	void SetShape(int entityID, const CollisionShape& shape);
+	void RemoveShape(int entityID);
+	const CollisionShape& GetShape(int entityID) const;
+	void RemapShapes(const std::vector<int>& newIDs);
+
+	// Replaces the content of manifolds with the contacts of the candidate pairs that really collide
+	void Collide(const std::vector<CollisionPair>& pairs, std::vector<ContactManifold>& manifolds);
+};
+
+#endif // !NARROWPHASE_H
@@ -0,0 +1,184 @@
+#include "SpatialHashBroadphase.h"
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+SpatialHashBroadphase::SpatialHashBroadphase(float cellSize) {
+	this->cellSize = cellSize;
+	this->inverseCellSize = 1.0f / cellSize;
+}
+
+int64_t SpatialHashBroadphase::GetCellKey(int cellX, int cellY) {
+	return (static_cast<int64_t>(cellX) << 32) | static_cast<uint32_t>(cellY);
+}
+
+int SpatialHashBroadphase::GetCellCoordinate(float position) const {
+	return static_cast<int>(std::floor(position * inverseCellSize));
+}
+
+int SpatialHashBroadphase::GetNumOccupiedCells() const {
+	return static_cast<int>(cellIndices.size());
+}
+
+void SpatialHashBroadphase::AddToCells(int entityID, const Proxy& proxy) {
+	for (int cellY = proxy.minCellY; cellY <= proxy.maxCellY; cellY++) {
+		for (int cellX = proxy.minCellX; cellX <= proxy.maxCellX; cellX++) {
+			const int64_t key = GetCellKey(cellX, cellY);
+			auto cellIndex = cellIndices.find(key);
+			if (cellIndex == cellIndices.end()) {
+				int index;
+				if (!freeCells.empty()) {
+					index = freeCells.back();
+					freeCells.pop_back();
+				}
+				else {
+					index = static_cast<int>(cells.size());
+					cells.emplace_back();
+				}
+				cells[index].key = key;
+				cellIndex = cellIndices.emplace(key, index).first;
+			}
+			cells[cellIndex->second].entityIDs.push_back(entityID);
+		}
+	}
+}
+
+void SpatialHashBroadphase::RemoveFromCells(int entityID, const Proxy& proxy) {
+	for (int cellY = proxy.minCellY; cellY <= proxy.maxCellY; cellY++) {
+		for (int cellX = proxy.minCellX; cellX <= proxy.maxCellX; cellX++) {
+			auto cellIndex = cellIndices.find(GetCellKey(cellX, cellY));
+			if (cellIndex == cellIndices.end()) {
+				continue;
+			}
+
+			// cells are small, so a linear search and a swap with the last element is enough
+			std::vector<int>& entityIDs = cells[cellIndex->second].entityIDs;
+			for (size_t i = 0; i < entityIDs.size(); i++) {
+				if (entityIDs[i] == entityID) {
+					entityIDs[i] = entityIDs.back();
+					entityIDs.pop_back();
+					break;
+				}
+			}
+
+			if (entityIDs.empty()) {
+				freeCells.push_back(cellIndex->second);
+				cellIndices.erase(cellIndex);
+			}
+		}
+	}
+}
+
+void SpatialHashBroadphase::UpdateProxy(int entityID, const AABB& bounds) {
+	if (entityID >= static_cast<int>(proxies.size())) {
+		proxies.resize(entityID + 1);
+	}
+
+	Proxy& proxy = proxies[entityID];
+	const int minCellX = GetCellCoordinate(bounds.min.x);
+	const int minCellY = GetCellCoordinate(bounds.min.y);
+	const int maxCellX = GetCellCoordinate(bounds.max.x);
+	const int maxCellY = GetCellCoordinate(bounds.max.y);
+
+	// most of the frames the proxy stays in the same cells, then only the bounds change
+	const bool hasMovedCells = !proxy.isActive
+		|| minCellX != proxy.minCellX || minCellY != proxy.minCellY
+		|| maxCellX != proxy.maxCellX || maxCellY != proxy.maxCellY;
+
+	if (hasMovedCells && proxy.isActive) {
+		RemoveFromCells(entityID, proxy);
+	}
+
+	proxy.bounds = bounds;
+	proxy.minCellX = minCellX;
+	proxy.minCellY = minCellY;
+	proxy.maxCellX = maxCellX;
+	proxy.maxCellY = maxCellY;
+
+	if (hasMovedCells) {
+		proxy.isActive = true;
+		AddToCells(entityID, proxy);
+	}
+}
+
+void SpatialHashBroadphase::RemoveProxy(int entityID) {
+	if (entityID >= static_cast<int>(proxies.size()) || !proxies[entityID].isActive) {
+		return;
+	}
+	RemoveFromCells(entityID, proxies[entityID]);
+	proxies[entityID].isActive = false;
+}
+
+void SpatialHashBroadphase::FindPairs(std::vector<CollisionPair>& pairs) {
+	PROFILE_FUNCTION();
+
+	pairs.clear();
+	for (const auto& cell : cells) {
+		const std::vector<int>& entityIDs = cell.entityIDs;
+		if (entityIDs.size() < 2) {
+			continue;
+		}
+
+		const int cellX = static_cast<int>(cell.key >> 32);
+		const int cellY = static_cast<int>(static_cast<int32_t>(cell.key & 0xFFFFFFFF));
+
+		for (size_t i = 0; i < entityIDs.size(); i++) {
+			const AABB& boundsA = proxies[entityIDs[i]].bounds;
+			for (size_t j = i + 1; j < entityIDs.size(); j++) {
+				const AABB& boundsB = proxies[entityIDs[j]].bounds;
+				if (!boundsA.Overlaps(boundsB)) {
+					continue;
+				}
+
+				// Two proxies can share several cells: only the cell that holds the top-left
+				// corner of their intersection reports the pair, so no duplicate check is needed
+				if (GetCellCoordinate(std::max(boundsA.min.x, boundsB.min.x)) != cellX ||
+					GetCellCoordinate(std::max(boundsA.min.y, boundsB.min.y)) != cellY) {
+					continue;
+				}
+
+				const int entityA = entityIDs[i];
+				const int entityB = entityIDs[j];
+				if (entityA < entityB) {
+					pairs.push_back({ entityA, entityB });
+				}
+				else {
+					pairs.push_back({ entityB, entityA });
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashBroadphase::UpdatePairs(std::vector<CollisionPair>& addedPairs, std::vector<CollisionPair>& removedPairs) {
+	pairs.swap(previousPairs);
+	FindPairs(pairs);
+	std::sort(pairs.begin(), pairs.end());
+
+	addedPairs.clear();
+	removedPairs.clear();
+	std::set_difference(pairs.begin(), pairs.end(), previousPairs.begin(), previousPairs.end(), std::back_inserter(addedPairs));
+	std::set_difference(previousPairs.begin(), previousPairs.end(), pairs.begin(), pairs.end(), std::back_inserter(removedPairs));
+}
+
+const std::vector<CollisionPair>& SpatialHashBroadphase::GetPairs() const {
+	return pairs;
+}
+
+void SpatialHashBroadphase::RemapProxies(const std::vector<int>& newIDs) {
+	RemapEntityVector(proxies, newIDs, Proxy());
+	for (auto& cell : cells) {
+		for (auto& entityID : cell.entityIDs) {
+			entityID = newIDs[entityID];
+		}
+	}
+
+	for (auto* pairList : { &pairs, &previousPairs }) {
+		for (auto& pair : *pairList) {
+			pair = pair.Remap(newIDs);
+		}
+		std::sort(pairList->begin(), pairList->end());
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef SPATIALHASHBROADPHASE_H
+#define SPATIALHASHBROADPHASE_H
+
+#include "Broadphase.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Cells a bit larger than the usual collider work best (the sprites are 32px scaled up to 5 times)
+const float DEFAULT_SPATIAL_HASH_CELL_SIZE = 192.0f;
+
+/// <summary>
+/// Uniform grid broadphase: every proxy is stored in the cells that its bounds touch, and only
+/// the proxies that share a cell are tested. The grid is hashed so the world has no limits,
+/// and it is updated incrementally: a proxy only moves between cells when its cell range changes.
+/// The pairs are found again every frame, the added/removed pairs come from comparing both frames.
+/// </summary>
+class SpatialHashBroadphase : public Broadphase {
+private:
+	struct Proxy {
+		AABB bounds;
+		int minCellX;
+		int minCellY;
+		int maxCellX;
+		int maxCellY;
+		bool isActive;
+	};
+
+	struct Cell {
+		int64_t key;
+		std::vector<int> entityIDs;
+	};
+
+	float cellSize;
+	float inverseCellSize;
+
+	// [vector index = entity ID]
+	std::vector<Proxy> proxies;
+
+	// Cells are stored contiguously and recycled once empty, the map only finds them by coordinates
+	std::vector<Cell> cells;
+	std::vector<int> freeCells;
+	std::unordered_map<int64_t, int> cellIndices;
+
+	// Sorted, so the pairs of two frames can be compared in one pass
+	std::vector<CollisionPair> pairs;
+	std::vector<CollisionPair> previousPairs;
+
+	static int64_t GetCellKey(int cellX, int cellY);
+	int GetCellCoordinate(float position) const;
+	void AddToCells(int entityID, const Proxy& proxy);
+	void RemoveFromCells(int entityID, const Proxy& proxy);
+	void FindPairs(std::vector<CollisionPair>& pairs);
+
+public:
+	SpatialHashBroadphase(float cellSize = DEFAULT_SPATIAL_HASH_CELL_SIZE);
+
+	void UpdateProxy(int entityID, const AABB& bounds) override;
+	void RemoveProxy(int entityID) override;
+	void UpdatePairs(std::vector<CollisionPair>& addedPairs, std::vector<CollisionPair>& removedPairs) override;
+	const std::vector<CollisionPair>& GetPairs() const override;
+	void RemapProxies(const std::vector<int>& newIDs) override;
+
+	int GetNumOccupiedCells() const;
+};
+
+#endif // !SPATIALHASHBROADPHASE_H
@@ -0,0 +1,220 @@
+#include "SpatialIndex.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+// Far enough for any world, and close enough that the cell ranges and the rings of QueryNearest never overflow an int
+const float MAX_SPATIAL_INDEX_CELL_COORDINATE = static_cast<float>(INT_MAX / 4);
+
+SpatialIndex::SpatialIndex(float cellSize) {
+	this->cellSize = cellSize;
+	this->inverseCellSize = 1.0f / cellSize;
+	bucketMask = 0;
+	bucketStarts.assign(2, 0);
+	minCellX = minCellY = 0;
+	maxCellX = maxCellY = -1;
+}
+
+int SpatialIndex::GetCellCoordinate(float position) const {
+	// The cast of a NaN or of a float past the int range is undefined, fmax also sends a NaN to the lowest cell
+	const float cell = std::floor(position * inverseCellSize);
+	return static_cast<int>(std::fmin(std::fmax(cell, -MAX_SPATIAL_INDEX_CELL_COORDINATE), MAX_SPATIAL_INDEX_CELL_COORDINATE));
+}
+
+uint32_t SpatialIndex::GetBucket(int cellX, int cellY) const {
+	return ((static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u)) & bucketMask;
+}
+
+template <typename TVisitor>
+void SpatialIndex::VisitCell(int cellX, int cellY, TVisitor&& visit) const {
+	const uint32_t bucket = GetBucket(cellX, cellY);
+	for (int i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; i++) {
+		const SpatialEntry& entry = entries[i];
+		// other cells can share the bucket, their entries would be visited twice
+		if (GetCellCoordinate(entry.position.x) == cellX && GetCellCoordinate(entry.position.y) == cellY) {
+			visit(entry);
+		}
+	}
+}
+
+void SpatialIndex::Build(const std::vector<SpatialEntry>& points) {
+	PROFILE_FUNCTION();
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+
+	// about two buckets per entity keeps the collisions rare
+	uint32_t numBuckets = 1;
+	while (numBuckets < points.size() * 2) {
+		numBuckets <<= 1;
+	}
+	bucketMask = numBuckets - 1;
+	bucketStarts.assign(numBuckets + 1, 0);
+
+	// The range is kept in locals, the compiler can not tell that the counts written below never overwrite it
+	int newMinCellX = INT_MAX, newMinCellY = INT_MAX;
+	int newMaxCellX = INT_MIN, newMaxCellY = INT_MIN;
+	int maxEntityID = -1;
+	pointBuckets.resize(points.size());
+	for (size_t i = 0; i < points.size(); i++) {
+		const SpatialEntry& point = points[i];
+		const int cellX = GetCellCoordinate(point.position.x);
+		const int cellY = GetCellCoordinate(point.position.y);
+		pointBuckets[i] = GetBucket(cellX, cellY);
+		bucketStarts[pointBuckets[i] + 1]++;
+		newMinCellX = std::min(newMinCellX, cellX);
+		newMinCellY = std::min(newMinCellY, cellY);
+		newMaxCellX = std::max(newMaxCellX, cellX);
+		newMaxCellY = std::max(newMaxCellY, cellY);
+		maxEntityID = std::max(maxEntityID, point.entityID);
+	}
+	minCellX = newMinCellX;
+	minCellY = newMinCellY;
+	maxCellX = newMaxCellX;
+	maxCellY = newMaxCellY;
+
+	if (maxEntityID >= static_cast<int>(positions.size())) {
+		positions.resize(maxEntityID + 1);
+	}
+	for (const auto& point : points) {
+		positions[point.entityID] = point.position;
+	}
+
+	// Counting sort: the prefix sum gives the first slot of each bucket
+	for (uint32_t bucket = 0; bucket < numBuckets; bucket++) {
+		bucketStarts[bucket + 1] += bucketStarts[bucket];
+	}
+	entries.resize(points.size());
+	std::vector<int>& nextSlots = bucketStarts;
+	for (size_t i = 0; i < points.size(); i++) {
+		entries[nextSlots[pointBuckets[i]]++] = points[i];
+	}
+
+	// filling the buckets moved every start to the start of the next bucket, shift them back
+	for (uint32_t bucket = numBuckets; bucket > 0; bucket--) {
+		bucketStarts[bucket] = bucketStarts[bucket - 1];
+	}
+	bucketStarts[0] = 0;
+}
+
+int SpatialIndex::QueryRadius(const glm::vec2& center, float radius, int* entityIDs, int maxResults) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	const float radiusSquared = radius * radius;
+	const int firstX = std::max(GetCellCoordinate(center.x - radius), minCellX);
+	const int firstY = std::max(GetCellCoordinate(center.y - radius), minCellY);
+	const int lastX = std::min(GetCellCoordinate(center.x + radius), maxCellX);
+	const int lastY = std::min(GetCellCoordinate(center.y + radius), maxCellY);
+
+	int numFound = 0;
+	for (int cellY = firstY; cellY <= lastY; cellY++) {
+		for (int cellX = firstX; cellX <= lastX; cellX++) {
+			VisitCell(cellX, cellY, [&](const SpatialEntry& entry) {
+				const glm::vec2 delta = entry.position - center;
+				if (glm::dot(delta, delta) <= radiusSquared) {
+					if (numFound < maxResults) {
+						entityIDs[numFound] = entry.entityID;
+					}
+					numFound++;
+				}
+			});
+		}
+	}
+	return numFound;
+}
+
+int SpatialIndex::QueryAABB(const AABB& bounds, int* entityIDs, int maxResults) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	const int firstX = std::max(GetCellCoordinate(bounds.min.x), minCellX);
+	const int firstY = std::max(GetCellCoordinate(bounds.min.y), minCellY);
+	const int lastX = std::min(GetCellCoordinate(bounds.max.x), maxCellX);
+	const int lastY = std::min(GetCellCoordinate(bounds.max.y), maxCellY);
+
+	int numFound = 0;
+	for (int cellY = firstY; cellY <= lastY; cellY++) {
+		for (int cellX = firstX; cellX <= lastX; cellX++) {
+			VisitCell(cellX, cellY, [&](const SpatialEntry& entry) {
+				if (entry.position.x >= bounds.min.x && entry.position.x <= bounds.max.x &&
+					entry.position.y >= bounds.min.y && entry.position.y <= bounds.max.y) {
+					if (numFound < maxResults) {
+						entityIDs[numFound] = entry.entityID;
+					}
+					numFound++;
+				}
+			});
+		}
+	}
+	return numFound;
+}
+
+int SpatialIndex::QueryNearest(const glm::vec2& point, int k, int* entityIDs, float maxDistance) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+
+	if (k <= 0 || entries.empty()) {
+		return 0;
+	}
+
+	// The caller's buffer is used as a max-heap of the k closest entities found so far
+	auto distanceSquared = [&](int entityID) {
+		const glm::vec2 delta = positions[entityID] - point;
+		return glm::dot(delta, delta);
+	};
+	auto isCloser = [&](int entityA, int entityB) {
+		const float distanceA = distanceSquared(entityA);
+		const float distanceB = distanceSquared(entityB);
+		return distanceA < distanceB || (distanceA == distanceB && entityA < entityB);
+	};
+
+	const float maxDistanceSquared = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+	int numFound = 0;
+	auto visit = [&](const SpatialEntry& entry) {
+		const glm::vec2 delta = entry.position - point;
+		if (glm::dot(delta, delta) > maxDistanceSquared) {
+			return;
+		}
+		if (numFound < k) {
+			entityIDs[numFound++] = entry.entityID;
+			std::push_heap(entityIDs, entityIDs + numFound, isCloser);
+		}
+		else if (isCloser(entry.entityID, entityIDs[0])) {
+			std::pop_heap(entityIDs, entityIDs + numFound, isCloser);
+			entityIDs[numFound - 1] = entry.entityID;
+			std::push_heap(entityIDs, entityIDs + numFound, isCloser);
+		}
+	};
+
+	// Visit the cells in square rings around the point. Every cell of ring r is at least
+	// (r - 1) cells away, so the search stops once that is farther than the k-th closest entity.
+	const int centerX = GetCellCoordinate(point.x);
+	const int centerY = GetCellCoordinate(point.y);
+	const int maxRing = std::max(std::max(centerX - minCellX, maxCellX - centerX), std::max(centerY - minCellY, maxCellY - centerY));
+
+	for (int ring = 0; ring <= maxRing; ring++) {
+		const float ringDistance = (ring - 1) * cellSize;
+		if (ring > 1 && ringDistance * ringDistance > maxDistanceSquared) {
+			break;
+		}
+		if (ring > 1 && numFound == k && ringDistance * ringDistance > distanceSquared(entityIDs[0])) {
+			break;
+		}
+
+		for (int cellY = centerY - ring; cellY <= centerY + ring; cellY++) {
+			if (cellY < minCellY || cellY > maxCellY) {
+				continue;
+			}
+			// the inner rows of the ring only have their first and last cells
+			const bool isEdgeRow = cellY == centerY - ring || cellY == centerY + ring;
+			const int stepX = isEdgeRow || ring == 0 ? 1 : 2 * ring;
+			for (int cellX = centerX - ring; cellX <= centerX + ring; cellX += stepX) {
+				if (cellX >= minCellX && cellX <= maxCellX) {
+					VisitCell(cellX, cellY, visit);
+				}
+			}
+		}
+	}
+
+	std::sort_heap(entityIDs, entityIDs + numFound, isCloser);
+	return numFound;
+}
@@ -0,0 +1,63 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "Broadphase.h"
+#include <cfloat>
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+#include <glm/glm.hpp>
+
+const float DEFAULT_SPATIAL_INDEX_CELL_SIZE = 128.0f;
+
+struct SpatialEntry {
+	int entityID;
+	glm::vec2 position;
+};
+
+/// <summary>
+/// Hashed grid of entity positions for gameplay queries. It is rebuilt in one pass with a
+/// counting sort, so the entities of a cell are contiguous and a query reads a few short runs.
+/// The queries write into buffers given by the caller and never allocate; they take a shared
+/// lock, so any number of threads can query while only Build() excludes them.
+/// </summary>
+class SpatialIndex {
+private:
+	float cellSize;
+	float inverseCellSize;
+
+	// Entries sorted by bucket, bucket b holds entries [bucketStarts[b], bucketStarts[b + 1])
+	uint32_t bucketMask;
+	std::vector<int> bucketStarts;
+	std::vector<SpatialEntry> entries;
+	// [vector index = point index], the bucket of each point of the last Build(), so it is hashed once
+	std::vector<uint32_t> pointBuckets;
+
+	// [vector index = entity ID]
+	std::vector<glm::vec2> positions;
+
+	// Range of the occupied cells, the nearest neighbour search never looks past it
+	int minCellX, minCellY, maxCellX, maxCellY;
+
+	mutable std::shared_mutex mutex;
+
+	int GetCellCoordinate(float position) const;
+	uint32_t GetBucket(int cellX, int cellY) const;
+
+	// Calls visit(entry) for every entry stored in the cell
+	template <typename TVisitor> void VisitCell(int cellX, int cellY, TVisitor&& visit) const;
+
+public:
+	SpatialIndex(float cellSize = DEFAULT_SPATIAL_INDEX_CELL_SIZE);
+
+	void Build(const std::vector<SpatialEntry>& points);
+
+	// Both return how many entities matched; only the first maxResults are written
+	int QueryRadius(const glm::vec2& center, float radius, int* entityIDs, int maxResults) const;
+	int QueryAABB(const AABB& bounds, int* entityIDs, int maxResults) const;
+
+	// Writes the k closest entities within maxDistance, closest first, and returns how many were found
+	int QueryNearest(const glm::vec2& point, int k, int* entityIDs, float maxDistance = FLT_MAX) const;
+};
+
+#endif // !SPATIALINDEX_H
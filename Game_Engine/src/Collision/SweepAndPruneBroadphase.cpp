@@ -0,0 +1,237 @@
+#include "SweepAndPruneBroadphase.h"
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cfloat>
+
+uint64_t SweepAndPruneBroadphase::GetPairKey(int entityA, int entityB) {
+	return (static_cast<uint64_t>(entityA) << 32) | static_cast<uint32_t>(entityB);
+}
+
+float SweepAndPruneBroadphase::GetEndpointValue(const AABB& bounds, int axis, bool isMax) {
+	return isMax ? bounds.max[axis] : bounds.min[axis];
+}
+
+void SweepAndPruneBroadphase::AddPair(int entityA, int entityB) {
+	if (entityA > entityB) {
+		std::swap(entityA, entityB);
+	}
+
+	// the endpoints only overlap on one axis, the pair also needs to overlap on the other
+	if (!proxies[entityA].bounds.Overlaps(proxies[entityB].bounds)) {
+		return;
+	}
+
+	if (pairIndices.emplace(GetPairKey(entityA, entityB), static_cast<int>(pairs.size())).second) {
+		pairs.push_back({ entityA, entityB });
+		pendingAddedPairs.push_back({ entityA, entityB });
+	}
+}
+
+void SweepAndPruneBroadphase::RemovePair(int entityA, int entityB) {
+	if (entityA > entityB) {
+		std::swap(entityA, entityB);
+	}
+
+	auto pairIndex = pairIndices.find(GetPairKey(entityA, entityB));
+	if (pairIndex == pairIndices.end()) {
+		return;
+	}
+
+	// keep the pairs packed by moving the last one into the hole
+	const int index = pairIndex->second;
+	pairIndices.erase(pairIndex);
+	if (index != static_cast<int>(pairs.size()) - 1) {
+		pairs[index] = pairs.back();
+		pairIndices[GetPairKey(pairs[index].entityA, pairs[index].entityB)] = index;
+	}
+	pairs.pop_back();
+	pendingRemovedPairs.push_back({ entityA, entityB });
+}
+
+void SweepAndPruneBroadphase::UpdateProxy(int entityID, const AABB& bounds) {
+	if (entityID >= static_cast<int>(proxies.size())) {
+		proxies.resize(entityID + 1);
+	}
+
+	Proxy& proxy = proxies[entityID];
+	proxy.bounds = bounds;
+
+	if (!proxy.isActive) {
+		// A new proxy starts at the end of the arrays, as if it was far away from everything,
+		// then the sort moves it to its place and finds its pairs on the way
+		proxy.isActive = true;
+		numNewProxies++;
+		for (int axis = 0; axis < 2; axis++) {
+			for (int isMax = 0; isMax < 2; isMax++) {
+				proxy.endpointIndices[axis][isMax] = static_cast<int>(endpoints[axis].size());
+				endpoints[axis].push_back({ FLT_MAX, (entityID << 1) | isMax });
+			}
+		}
+	}
+
+	for (int axis = 0; axis < 2; axis++) {
+		for (int isMax = 0; isMax < 2; isMax++) {
+			endpoints[axis][proxy.endpointIndices[axis][isMax]].value = GetEndpointValue(bounds, axis, isMax != 0);
+		}
+	}
+}
+
+void SweepAndPruneBroadphase::RemoveProxy(int entityID) {
+	if (entityID >= static_cast<int>(proxies.size()) || !proxies[entityID].isActive) {
+		return;
+	}
+	proxies[entityID].isActive = false;
+
+	// Removing is rare, so the endpoints are simply erased and the pairs scanned
+	for (int axis = 0; axis < 2; axis++) {
+		std::vector<Endpoint>& axisEndpoints = endpoints[axis];
+		int numKept = 0;
+		for (int i = 0; i < static_cast<int>(axisEndpoints.size()); i++) {
+			const Endpoint endpoint = axisEndpoints[i];
+			if (endpoint.GetEntityID() == entityID) {
+				continue;
+			}
+			axisEndpoints[numKept] = endpoint;
+			proxies[endpoint.GetEntityID()].endpointIndices[axis][endpoint.IsMax()] = numKept;
+			numKept++;
+		}
+		axisEndpoints.resize(numKept);
+	}
+
+	for (int i = static_cast<int>(pairs.size()) - 1; i >= 0; i--) {
+		if (pairs[i].entityA == entityID || pairs[i].entityB == entityID) {
+			RemovePair(pairs[i].entityA, pairs[i].entityB);
+		}
+	}
+}
+
+void SweepAndPruneBroadphase::SortAxis(int axis) {
+	std::vector<Endpoint>& axisEndpoints = endpoints[axis];
+
+	// Insertion sort: each endpoint moves left past the ones with a greater value.
+	// An endpoint only swaps with each of the others once, so every swap is an event:
+	// a min moving past a max starts an overlap, a max moving past a min ends one.
+	for (int i = 1; i < static_cast<int>(axisEndpoints.size()); i++) {
+		const Endpoint endpoint = axisEndpoints[i];
+		const int entityID = endpoint.GetEntityID();
+
+		int j = i - 1;
+		while (j >= 0 && endpoint < axisEndpoints[j]) {
+			const Endpoint& other = axisEndpoints[j];
+			const int otherID = other.GetEntityID();
+
+			if (otherID != entityID) {
+				if (!endpoint.IsMax() && other.IsMax()) {
+					AddPair(entityID, otherID);
+				}
+				else if (endpoint.IsMax() && !other.IsMax()) {
+					RemovePair(entityID, otherID);
+				}
+			}
+
+			axisEndpoints[j + 1] = other;
+			proxies[otherID].endpointIndices[axis][other.IsMax()] = j + 1;
+			j--;
+		}
+
+		axisEndpoints[j + 1] = endpoint;
+		proxies[entityID].endpointIndices[axis][endpoint.IsMax()] = j + 1;
+	}
+}
+
+void SweepAndPruneBroadphase::UpdatePairs(std::vector<CollisionPair>& addedPairs, std::vector<CollisionPair>& removedPairs) {
+	PROFILE_FUNCTION();
+
+	if (numNewProxies > SWEEP_AND_PRUNE_MAX_INSERTIONS) {
+		RebuildPairs();
+	}
+	else {
+		// the overlap tests of AddPair() use the new bounds, so the axes can be sorted one after the other
+		SortAxis(0);
+		SortAxis(1);
+	}
+	numNewProxies = 0;
+
+	addedPairs.swap(pendingAddedPairs);
+	removedPairs.swap(pendingRemovedPairs);
+	pendingAddedPairs.clear();
+	pendingRemovedPairs.clear();
+}
+
+void SweepAndPruneBroadphase::RebuildPairs() {
+	for (int axis = 0; axis < 2; axis++) {
+		std::vector<Endpoint>& axisEndpoints = endpoints[axis];
+		std::sort(axisEndpoints.begin(), axisEndpoints.end());
+		for (int i = 0; i < static_cast<int>(axisEndpoints.size()); i++) {
+			proxies[axisEndpoints[i].GetEntityID()].endpointIndices[axis][axisEndpoints[i].IsMax()] = i;
+		}
+	}
+
+	// One sweep along x finds every pair, the proxies between their min and max are the candidates
+	rebuiltPairs.clear();
+	activeEntityIDs.clear();
+	for (const auto& endpoint : endpoints[0]) {
+		const int entityID = endpoint.GetEntityID();
+		if (endpoint.IsMax()) {
+			auto activeEntityID = std::find(activeEntityIDs.begin(), activeEntityIDs.end(), entityID);
+			*activeEntityID = activeEntityIDs.back();
+			activeEntityIDs.pop_back();
+			continue;
+		}
+		for (int otherID : activeEntityIDs) {
+			if (proxies[entityID].bounds.Overlaps(proxies[otherID].bounds)) {
+				rebuiltPairs.push_back(entityID < otherID ? CollisionPair{ entityID, otherID } : CollisionPair{ otherID, entityID });
+			}
+		}
+		activeEntityIDs.push_back(entityID);
+	}
+
+	// Both lists sorted, so the pairs that started or stopped overlapping come out of one merge
+	std::sort(rebuiltPairs.begin(), rebuiltPairs.end());
+	std::sort(pairs.begin(), pairs.end());
+	size_t oldIndex = 0;
+	size_t newIndex = 0;
+	while (oldIndex < pairs.size() || newIndex < rebuiltPairs.size()) {
+		if (newIndex == rebuiltPairs.size() || (oldIndex < pairs.size() && pairs[oldIndex] < rebuiltPairs[newIndex])) {
+			pendingRemovedPairs.push_back(pairs[oldIndex++]);
+		}
+		else if (oldIndex == pairs.size() || rebuiltPairs[newIndex] < pairs[oldIndex]) {
+			pendingAddedPairs.push_back(rebuiltPairs[newIndex++]);
+		}
+		else {
+			oldIndex++;
+			newIndex++;
+		}
+	}
+
+	pairs.swap(rebuiltPairs);
+	pairIndices.clear();
+	for (int i = 0; i < static_cast<int>(pairs.size()); i++) {
+		pairIndices[GetPairKey(pairs[i].entityA, pairs[i].entityB)] = i;
+	}
+}
+
+const std::vector<CollisionPair>& SweepAndPruneBroadphase::GetPairs() const {
+	return pairs;
+}
+
+void SweepAndPruneBroadphase::RemapProxies(const std::vector<int>& newIDs) {
+	RemapEntityVector(proxies, newIDs, Proxy());
+	for (auto& axisEndpoints : endpoints) {
+		for (auto& endpoint : axisEndpoints) {
+			endpoint.data = (newIDs[endpoint.GetEntityID()] << 1) | (endpoint.data & 1);
+		}
+	}
+
+	pairIndices.clear();
+	for (int i = 0; i < static_cast<int>(pairs.size()); i++) {
+		pairs[i] = pairs[i].Remap(newIDs);
+		pairIndices[GetPairKey(pairs[i].entityA, pairs[i].entityB)] = i;
+	}
+	for (auto* pairList : { &pendingAddedPairs, &pendingRemovedPairs }) {
+		for (auto& pair : *pairList) {
+			pair = pair.Remap(newIDs);
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef SWEEPANDPRUNEBROADPHASE_H
+#define SWEEPANDPRUNEBROADPHASE_H
+
+#include "Broadphase.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// More new proxies than this in one update are sorted in all at once, as each of them would
+// otherwise cross most of the arrays on its own
+const int SWEEP_AND_PRUNE_MAX_INSERTIONS = 256;
+
+/// <summary>
+/// Sort based broadphase: the min and max of every proxy are kept sorted along both axes.
+/// Bodies move little between frames, so the arrays stay almost sorted and an insertion sort
+/// fixes them in close to linear time. Every swap of a min with a max is a pair that starts or
+/// stops overlapping, so the pairs are maintained incrementally instead of found again.
+/// </summary>
+class SweepAndPruneBroadphase : public Broadphase {
+private:
+	struct Endpoint {
+		float value;
+		// entity ID << 1, the lowest bit is set for a max endpoint
+		int data;
+
+		int GetEntityID() const { return data >> 1; }
+		bool IsMax() const { return (data & 1) != 0; }
+
+		// At the same value a min comes before a max, so touching proxies overlap like AABB::Overlaps() says
+		bool operator < (const Endpoint& other) const {
+			return value < other.value || (value == other.value && !IsMax() && other.IsMax());
+		}
+	};
+
+	struct Proxy {
+		AABB bounds;
+		// Position of the min and max endpoints in the arrays [axis][0 = min, 1 = max]
+		int endpointIndices[2][2];
+		bool isActive;
+	};
+
+	// [axis 0 = x, axis 1 = y]
+	std::vector<Endpoint> endpoints[2];
+
+	// [vector index = entity ID]
+	std::vector<Proxy> proxies;
+
+	// The pairs are stored contiguously, the map finds them by key when they are removed
+	std::vector<CollisionPair> pairs;
+	std::unordered_map<uint64_t, int> pairIndices;
+
+	// Pairs that changed since the last UpdatePairs()
+	std::vector<CollisionPair> pendingAddedPairs;
+	std::vector<CollisionPair> pendingRemovedPairs;
+
+	// Proxies added since the last UpdatePairs(), they start at the end of the arrays
+	int numNewProxies = 0;
+	// Reused by the rebuild
+	std::vector<int> activeEntityIDs;
+	std::vector<CollisionPair> rebuiltPairs;
+
+	static uint64_t GetPairKey(int entityA, int entityB);
+	static float GetEndpointValue(const AABB& bounds, int axis, bool isMax);
+	void AddPair(int entityA, int entityB);
+	void RemovePair(int entityA, int entityB);
+	void SortAxis(int axis);
+	void RebuildPairs();
+
+public:
+	SweepAndPruneBroadphase() = default;
+
+	void UpdateProxy(int entityID, const AABB& bounds) override;
+	void RemoveProxy(int entityID) override;
+	void UpdatePairs(std::vector<CollisionPair>& addedPairs, std::vector<CollisionPair>& removedPairs) override;
+	const std::vector<CollisionPair>& GetPairs() const override;
+	void RemapProxies(const std::vector<int>& newIDs) override;
+};
+
+#endif // !SWEEPANDPRUNEBROADPHASE_H
@@ -0,0 +1,25 @@
+#ifndef BOIDCOMPONENT_H
+#define BOIDCOMPONENT_H
+
+struct BoidComponent {
+	// Boids align and group with the boids of their own flock, and keep their distance from all of them
+	int flockID;
+	// Pixels per second
+	float maxSpeed;
+	// Largest steering acceleration, in pixels per second squared, lower values make wider turns
+	float maxForce;
+	float separationWeight;
+	float alignmentWeight;
+	float cohesionWeight;
+
+	BoidComponent(int flockID = 0, float maxSpeed = 100.0f, float maxForce = 200.0f, float separationWeight = 1.5f, float alignmentWeight = 1.0f, float cohesionWeight = 1.0f) {
+		this->flockID = flockID;
+		this->maxSpeed = maxSpeed;
+		this->maxForce = maxForce;
+		this->separationWeight = separationWeight;
+		this->alignmentWeight = alignmentWeight;
+		this->cohesionWeight = cohesionWeight;
+	}
+};
+
+#endif // !BOIDCOMPONENT_H
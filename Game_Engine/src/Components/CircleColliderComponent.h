@@ -0,0 +1,18 @@
+#ifndef CIRCLECOLLIDERCOMPONENT_H
+#define CIRCLECOLLIDERCOMPONENT_H
+
+#include <glm/glm.hpp>
+
+struct CircleColliderComponent {
+	// Radius before the transform scale is applied, offset of the circle's bounding square
+	// from the transform position (like a sprite, the circle is drawn from its top left corner)
+	int radius;
+	glm::vec2 offset;
+
+	CircleColliderComponent(int radius = 0, glm::vec2 offset = glm::vec2(0)) {
+		this->radius = radius;
+		this->offset = offset;
+	}
+};
+
+#endif // !CIRCLECOLLIDERCOMPONENT_H
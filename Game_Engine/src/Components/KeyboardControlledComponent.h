@@ -0,0 +1,16 @@
+#ifndef KEYBOARDCONTROLLEDCOMPONENT_H
+#define KEYBOARDCONTROLLEDCOMPONENT_H
+
+struct KeyboardControlledComponent {
+	// Pixels per second while a movement action is held
+	float speed;
+	// Whose input steers the entity
+	int player;
+
+	KeyboardControlledComponent(float speed = 100.0f, int player = 0) {
+		this->speed = speed;
+		this->player = player;
+	}
+};
+
+#endif // !KEYBOARDCONTROLLEDCOMPONENT_H
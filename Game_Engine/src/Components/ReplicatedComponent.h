@@ -0,0 +1,15 @@
+#ifndef REPLICATEDCOMPONENT_H
+#define REPLICATEDCOMPONENT_H
+
+#include <cstdint>
+
+struct ReplicatedComponent {
+	// Same entity on the server and the clients, unlike the entity ID it never changes
+	uint32_t networkID;
+
+	ReplicatedComponent(uint32_t networkID = 0) {
+		this->networkID = networkID;
+	}
+};
+
+#endif // !REPLICATEDCOMPONENT_H
@@ -5,9 +5,32 @@
 
 struct RigidBodyComponent {
 	glm::vec2 velocity;
+	// Constant acceleration that doesn't depend on the mass, like gravity
+	glm::vec2 acceleration;
+	// Sum of the forces applied during the current tick, cleared after each physics step
+	glm::vec2 force;
+	// A mass of 0 is infinite: forces and impulses don't move the body
+	float mass;
+	// Fraction of the velocity lost per second, to slow bodies down without friction
+	float linearDamping;
 
-	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0, 0.0)) {
+	// A body that stays almost still for a while falls asleep and is skipped by the MovementSystem.
+	// Writing the velocity of a sleeping body doesn't wake it, use MovementSystem::SetVelocity().
+	bool isSleeping;
+	float idleTime;
+
+	RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0, 0.0), float mass = 1.0f, float linearDamping = 0.0f, glm::vec2 acceleration = glm::vec2(0.0, 0.0)) {
 		this->velocity = velocity;
+		this->acceleration = acceleration;
+		this->force = glm::vec2(0.0, 0.0);
+		this->mass = mass;
+		this->linearDamping = linearDamping;
+		this->isSleeping = false;
+		this->idleTime = 0.0f;
+	}
+
+	float GetInverseMass() const {
+		return mass > 0.0f ? 1.0f / mass : 0.0f;
 	}
 };
 
@@ -1,18 +1,21 @@
 #ifndef SPRITECOMPONENT_H
 #define SPRITECOMPONENT_H
 
+#include "../AssetManager/AssetHandle.h"
 #include <glm/glm.hpp>
 #include <SDL.h>
+#include <string>
 
+// The asset ID is kept as a handle, so the sprites are plain data and copied in bulk in the snapshots
 struct SpriteComponent {
-	std::string assetID;
+	AssetHandle assetHandle;
 	int width;
 	int height;
 	int zIndex;
 	SDL_Rect srcRect;
 
 	SpriteComponent(std::string assetID = "", int width = 0, int height = 0, int zIndex = 0, int srcRectX = 0, int srcRectY = 0) {
-		this->assetID = assetID;
+		this->assetHandle = GetAssetHandle(assetID);
 		this->width = width;
 		this->height = height;
 		this->zIndex = zIndex;
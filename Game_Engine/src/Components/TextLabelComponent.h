@@ -0,0 +1,37 @@
+#ifndef TEXTLABELCOMPONENT_H
+#define TEXTLABELCOMPONENT_H
+
+#include "../Utils/BinaryStream.h"
+#include <glm/glm.hpp>
+#include <SDL.h>
+#include <string>
+
+struct TextLabelComponent {
+	glm::vec2 position;
+	std::string text;
+	std::string assetID;
+	SDL_Color color;
+
+	TextLabelComponent(glm::vec2 position = glm::vec2(0), std::string text = "", std::string assetID = "", const SDL_Color& color = { 255, 255, 255, 255 }) {
+		this->position = position;
+		this->text = text;
+		this->assetID = assetID;
+		this->color = color;
+	}
+};
+
+inline void WriteComponent(BinaryWriter& writer, const TextLabelComponent& label) {
+	writer.Write(label.position);
+	writer.WriteString(label.text);
+	writer.WriteString(label.assetID);
+	writer.Write(label.color);
+}
+
+inline void ReadComponent(BinaryReader& reader, TextLabelComponent& label) {
+	reader.Read(label.position);
+	reader.ReadString(label.text);
+	reader.ReadString(label.assetID);
+	reader.Read(label.color);
+}
+
+#endif // !TEXTLABELCOMPONENT_H
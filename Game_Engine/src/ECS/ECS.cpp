@@ -1,5 +1,7 @@
 #include "ECS.h"
 #include "../logger/logger.h"
+#include "../Profiler/Profiler.h"
+#include <cstring>
 
 int BaseComponent::nextID = 0;
 
@@ -8,19 +10,191 @@ int Entity::GetID() const {
 }
 
 void System::AddEntityToSystem(Entity entity) {
+	areEntitiesSorted = areEntitiesSorted && (entities.empty() || entities.back().GetID() < entity.GetID());
 	entities.push_back(entity);
+	SetEntityBit(entity.GetID(), true);
 }
 
 void System::RemoveEntityFromSystem(Entity entity) {
-	for (const auto& entityID = entities.begin(); entityID != entities.end();) {
+	for (auto entityID = entities.begin(); entityID != entities.end(); entityID++) {
 		if (entityID->GetID() == entity.GetID()) {
 			entities.erase(entityID);
+			SetEntityBit(entity.GetID(), false);
 			break;
 		}
 	}
 }
 
-std::vector<Entity> System::GetSystemEntities() const {
+void System::RemoveAllEntitiesFromSystem() {
+	entities.clear();
+	std::fill(entityBits.begin(), entityBits.end(), 0);
+	areEntitiesSorted = true;
+}
+
+void System::SetEntityBit(int entityID, bool isSet) {
+	const size_t wordIndex = entityID / 64;
+	if (wordIndex >= entityBits.size()) {
+		entityBits.resize(wordIndex + 1, 0);
+	}
+	const uint64_t bit = uint64_t(1) << (entityID % 64);
+	entityBits[wordIndex] = isSet ? entityBits[wordIndex] | bit : entityBits[wordIndex] & ~bit;
+}
+
+void System::UpdateEntityBits() {
+	std::fill(entityBits.begin(), entityBits.end(), 0);
+	areEntitiesSorted = true;
+	for (size_t i = 0; i < entities.size(); i++) {
+		areEntitiesSorted = areEntitiesSorted && (i == 0 || entities[i - 1].GetID() < entities[i].GetID());
+		SetEntityBit(entities[i].GetID(), true);
+	}
+}
+
+void WriteEntityIDs(BinaryWriter& writer, const std::vector<Entity>& entities) {
+	const size_t numRunsPosition = writer.GetSize();
+	writer.Write(static_cast<uint32_t>(0));
+
+	uint32_t numRuns = 0;
+	size_t first = 0;
+	while (first < entities.size()) {
+		size_t last = first + 1;
+		while (last < entities.size() && entities[last].GetID() == entities[last - 1].GetID() + 1) {
+			last++;
+		}
+		const int32_t run[2] = { entities[first].GetID(), static_cast<int32_t>(last - first) };
+		writer.Write(run);
+		numRuns++;
+		first = last;
+	}
+	writer.WriteAt(numRunsPosition, numRuns);
+}
+
+// Number of bits set, without the intrinsics that differ between the compilers
+static int CountBits(uint64_t word) {
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+}
+
+static uint64_t ReadEntityWord(const uint8_t* words, size_t wordIndex) {
+	uint64_t word;
+	std::memcpy(&word, words + wordIndex * sizeof(uint64_t), sizeof(uint64_t));
+	return word;
+}
+
+// Reads the bits of a list saved sorted, returns nullptr when they don't match the count or the registry
+static const uint8_t* ReadEntityWords(BinaryReader& reader, int numEntities, uint32_t& count) {
+	reader.Read(count);
+	const size_t numWords = (static_cast<size_t>(numEntities) + 63) / 64;
+	const uint8_t* words = reader.SkipBytes(numWords * sizeof(uint64_t));
+	if (!words) {
+		return nullptr;
+	}
+	size_t numBits = 0;
+	for (size_t wordIndex = 0; wordIndex < numWords; wordIndex++) {
+		numBits += CountBits(ReadEntityWord(words, wordIndex));
+	}
+	const bool hasBitsPastEnd = numEntities % 64 != 0 && (ReadEntityWord(words, numWords - 1) >> (numEntities % 64)) != 0;
+	if (numBits != count || hasBitsPastEnd) {
+		reader.SetInvalid();
+		return nullptr;
+	}
+	return words;
+}
+
+// A list sorted by ID, as they are unless the system added an entity out of order, is saved as
+// one bit per entity of the registry. The others are saved as runs of IDs, in their order.
+void System::SaveEntities(BinaryWriter& writer, int numEntities) const {
+	const bool isSorted = areEntitiesSorted && (entities.empty() || entities.back().GetID() < numEntities);
+	writer.Write(static_cast<uint8_t>(isSorted));
+	if (!isSorted) {
+		WriteEntityIDs(writer, entities);
+		return;
+	}
+
+	writer.Write(static_cast<uint32_t>(entities.size()));
+	const size_t numWords = (static_cast<size_t>(numEntities) + 63) / 64;
+	const size_t numWordsKept = std::min(numWords, entityBits.size());
+	writer.WriteBytes(entityBits.data(), numWordsKept * sizeof(uint64_t));
+	for (size_t wordIndex = numWordsKept; wordIndex < numWords; wordIndex++) {
+		writer.Write(static_cast<uint64_t>(0));
+	}
+}
+
+bool System::LoadEntities(BinaryReader& reader, Registry* registry, int numEntities) {
+	uint8_t isSorted = 0;
+	reader.Read(isSorted);
+	if (!isSorted) {
+		// Overwritten in place, the list only allocates when the snapshot has more entities than it ever had
+		RemoveAllEntitiesFromSystem();
+		const bool isLoaded = ReadEntityIDs(reader, numEntities, [&](int firstID, int count) {
+			for (int entityID = firstID; entityID < firstID + count; entityID++) {
+				entities.emplace_back(entityID);
+				entities.back().registry = registry;
+			}
+		});
+		if (!isLoaded) {
+			entities.clear();
+		}
+		UpdateEntityBits();
+		return isLoaded;
+	}
+
+	uint32_t count = 0;
+	const uint8_t* words = ReadEntityWords(reader, numEntities, count);
+	if (!words) {
+		RemoveAllEntitiesFromSystem();
+		return false;
+	}
+
+	// A rollback mostly restores the entities that the system already has, the list and the data
+	// that the system keeps per entity are left as they are then. The bits past the snapshot's
+	// entities are compared as zeros.
+	const size_t numWords = (static_cast<size_t>(numEntities) + 63) / 64;
+	const size_t numWordsKept = std::min(numWords, entityBits.size());
+	bool isSame = areEntitiesSorted && entities.size() == count
+		&& (numWordsKept == 0 || std::memcmp(words, entityBits.data(), numWordsKept * sizeof(uint64_t)) == 0);
+	for (size_t wordIndex = numWordsKept; wordIndex < numWords && isSame; wordIndex++) {
+		isSame = ReadEntityWord(words, wordIndex) == 0;
+	}
+	for (size_t wordIndex = numWordsKept; wordIndex < entityBits.size() && isSame; wordIndex++) {
+		isSame = entityBits[wordIndex] == 0;
+	}
+	if (isSame) {
+		return true;
+	}
+
+	RemoveAllEntitiesFromSystem();
+	if (entityBits.size() < numWords) {
+		entityBits.resize(numWords, 0);
+	}
+	if (numWords > 0) {
+		std::memcpy(entityBits.data(), words, numWords * sizeof(uint64_t));
+	}
+	for (size_t wordIndex = 0; wordIndex < numWords; wordIndex++) {
+		uint64_t word = entityBits[wordIndex];
+		for (int entityID = static_cast<int>(wordIndex * 64); word != 0; entityID++, word >>= 1) {
+			if (word & 1) {
+				entities.emplace_back(entityID);
+				entities.back().registry = registry;
+			}
+		}
+	}
+	return true;
+}
+
+// Same as LoadEntities() for a system of the snapshot that this registry doesn't have
+static bool SkipEntities(BinaryReader& reader, int numEntities) {
+	uint8_t isSorted = 0;
+	reader.Read(isSorted);
+	if (!isSorted) {
+		return ReadEntityIDs(reader, numEntities, [](int /*firstID*/, int /*count*/) {});
+	}
+	uint32_t count = 0;
+	return ReadEntityWords(reader, numEntities, count) != nullptr;
+}
+
+const std::vector<Entity>& System::GetSystemEntities() const {
 	return entities;
 }
 
@@ -28,6 +202,27 @@ const Signature& System::GetComponentSignature() const {
 	return componentSignature;
 }
 
+bool System::IsInterested(const Signature& entityComponentSignature) const {
+	return (entityComponentSignature & componentSignature) == componentSignature
+		&& (anyComponentSignature.none() || (entityComponentSignature & anyComponentSignature).any());
+}
+
+Entity System::RemapEntity(const Entity& entity, const std::vector<int>& newIDs) {
+	Entity remappedEntity(newIDs[entity.GetID()]);
+	remappedEntity.registry = entity.registry;
+	return remappedEntity;
+}
+
+void System::RemapEntities(const std::vector<int>& newIDs) {
+	for (auto& entity : entities) {
+		entity = RemapEntity(entity, newIDs);
+	}
+	std::sort(entities.begin(), entities.end());
+	UpdateEntityBits();
+
+	OnEntitiesRemapped(newIDs);
+}
+
 Entity Registry::CreateEntity() {
 	int entityID;
 
@@ -54,17 +249,211 @@ void Registry::AddEntityToSystems(Entity entity) {
 
 	// loop all of the systems
 	for (auto& system : systems) {
-		const auto& systemComponentSignature = system.second->GetComponentSignature();
+		if (system.second->IsInterested(entityComponentSignature)) {
+			system.second->AddEntityToSystem(entity);
+		}
+	}
+}
 
-		bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
+int Registry::GetNumEntities() const {
+	return numEntities;
+}
 
-		if (isInterested) {
-			system.second->AddEntityToSystem(entity);
+int Registry::GetNumSystems() const {
+	return static_cast<int>(systems.size());
+}
+
+std::vector<std::pair<std::string, int>> Registry::GetSystemEntityCounts() const {
+	std::vector<std::pair<std::string, int>> systemEntityCounts;
+	for (const auto& system : systems) {
+		systemEntityCounts.emplace_back(system.first.name(), static_cast<int>(system.second->GetSystemEntities().size()));
+	}
+	return systemEntityCounts;
+}
+
+void Registry::ReorderEntities(const std::vector<int>& newIDs) {
+	PROFILE_FUNCTION();
+
+	if (static_cast<int>(newIDs.size()) != numEntities) {
+		Logger::Err("ReorderEntities needs a new ID for each of the " + std::to_string(numEntities) + " entities");
+		return;
+	}
+
+	RemapEntityVector(entityComponentSignatures, newIDs, Signature());
+	for (auto& componentPool : componentPools) {
+		if (componentPool) {
+			componentPool->Remap(newIDs);
 		}
 	}
+
+	auto remapEntities = [&](std::set<Entity>& entitySet) {
+		std::set<Entity> remappedEntities;
+		for (const auto& entity : entitySet) {
+			Entity remappedEntity(newIDs[entity.GetID()]);
+			remappedEntity.registry = this;
+			remappedEntities.insert(remappedEntity);
+		}
+		entitySet.swap(remappedEntities);
+	};
+	remapEntities(entitiesToBeAdded);
+	remapEntities(entitiesToBeDestroyed);
+
+	for (auto& system : systems) {
+		system.second->RemapEntities(newIDs);
+	}
+}
+
+void Registry::SaveSnapshot(BinaryWriter& writer) const {
+	PROFILE_FUNCTION();
+
+	static_assert(std::is_trivially_copyable<Signature>::value, "The signatures are saved byte for byte");
+	writer.Write(static_cast<int32_t>(numEntities));
+	writer.WriteBytes(entityComponentSignatures.data(), numEntities * sizeof(Signature));
+
+	// The entities created during the last frame are only added to the systems by the next Update()
+	writer.Write(static_cast<int32_t>(entitiesToBeAdded.size()));
+	for (const auto& entity : entitiesToBeAdded) {
+		writer.Write(static_cast<int32_t>(entity.GetID()));
+	}
+
+	uint32_t poolMask = 0;
+	for (size_t componentID = 0; componentID < componentPools.size(); componentID++) {
+		if (componentPools[componentID]) {
+			poolMask |= 1u << componentID;
+		}
+	}
+	writer.Write(poolMask);
+	for (size_t componentID = 0; componentID < componentPools.size(); componentID++) {
+		if (componentPools[componentID]) {
+			componentPools[componentID]->Save(writer, entityComponentSignatures, static_cast<int>(componentID));
+		}
+	}
+
+	// The systems keep their own list of entities, it is saved instead of checking every entity
+	// against every system again on load. Each system state is prefixed by its size, so the state
+	// of a system that is missing is skipped.
+	writer.Write(static_cast<int32_t>(systems.size()));
+	for (const auto& system : systems) {
+		writer.WriteString(system.first.name());
+		system.second->SaveEntities(writer, numEntities);
+
+		const size_t stateSizePosition = writer.GetSize();
+		writer.Write(static_cast<uint32_t>(0));
+		system.second->SaveState(writer);
+		writer.WriteAt(stateSizePosition, static_cast<uint32_t>(writer.GetSize() - stateSizePosition - sizeof(uint32_t)));
+	}
+}
+
+bool Registry::LoadSnapshot(BinaryReader& reader) {
+	PROFILE_FUNCTION();
+
+	int32_t newNumEntities = 0;
+	reader.Read(newNumEntities);
+	if (!reader.IsValid() || newNumEntities < 0) {
+		Logger::Err("The registry snapshot is damaged");
+		return false;
+	}
+	const uint8_t* newSignatures = reader.SkipBytes(newNumEntities * sizeof(Signature));
+	int32_t numEntitiesToBeAdded = 0;
+	reader.Read(numEntitiesToBeAdded);
+	const uint8_t* newEntitiesToBeAdded = reader.SkipBytes(std::max(numEntitiesToBeAdded, 0) * sizeof(int32_t));
+	uint32_t poolMask = 0;
+	reader.Read(poolMask);
+	if (!reader.IsValid() || numEntitiesToBeAdded < 0) {
+		Logger::Err("The registry snapshot is damaged");
+		return false;
+	}
+
+	// Nothing changes until it is sure the snapshot fits this registry
+	for (int32_t i = 0; i < numEntitiesToBeAdded; i++) {
+		int32_t entityID;
+		std::memcpy(&entityID, newEntitiesToBeAdded + i * sizeof(int32_t), sizeof(int32_t));
+		if (entityID < 0 || entityID >= newNumEntities) {
+			Logger::Err("The registry snapshot adds entity ID " + std::to_string(entityID) + " out of its " + std::to_string(newNumEntities) + " entities");
+			return false;
+		}
+	}
+	for (int componentID = 0; componentID < static_cast<int>(MAX_COMPONENTS); componentID++) {
+		if ((poolMask >> componentID) & 1) {
+			if (componentID >= static_cast<int>(componentPools.size()) || !componentPools[componentID]) {
+				Logger::Err("The registry snapshot has components of ID " + std::to_string(componentID) + " that this registry has no pool for");
+				return false;
+			}
+		}
+	}
+
+	numEntities = newNumEntities;
+	entityComponentSignatures.resize(numEntities);
+	std::memcpy(entityComponentSignatures.data(), newSignatures, numEntities * sizeof(Signature));
+	entitiesToBeAdded.clear();
+	entitiesToBeDestroyed.clear();
+	for (int32_t i = 0; i < numEntitiesToBeAdded; i++) {
+		int32_t entityID;
+		std::memcpy(&entityID, newEntitiesToBeAdded + i * sizeof(int32_t), sizeof(int32_t));
+		Entity entity(entityID);
+		entity.registry = this;
+		entitiesToBeAdded.insert(entity);
+	}
+
+	for (int componentID = 0; componentID < static_cast<int>(componentPools.size()); componentID++) {
+		if ((poolMask >> componentID) & 1) {
+			componentPools[componentID]->Load(reader, entityComponentSignatures, componentID);
+		}
+	}
+	if (!reader.IsValid()) {
+		Logger::Err("The registry snapshot is cut short, the entities are left incomplete");
+		return false;
+	}
+
+	// A system that is not in the snapshot is left without entities
+	loadedSystems.clear();
+	int32_t numSystems = 0;
+	reader.Read(numSystems);
+	for (int i = 0; i < numSystems && reader.IsValid(); i++) {
+		// The name is compared in place, it is longer than what a string holds without allocating
+		uint32_t nameLength = 0;
+		reader.Read(nameLength);
+		const char* name = reinterpret_cast<const char*>(reader.SkipBytes(nameLength));
+		if (!name) {
+			break;
+		}
+		System* loadedSystem = nullptr;
+		for (auto& system : systems) {
+			const char* systemName = system.first.name();
+			if (std::strlen(systemName) == nameLength && std::memcmp(systemName, name, nameLength) == 0) {
+				loadedSystem = system.second.get();
+			}
+		}
+
+		if (loadedSystem) {
+			loadedSystem->LoadEntities(reader, this, numEntities);
+			loadedSystems.push_back(loadedSystem);
+		} else {
+			SkipEntities(reader, numEntities);
+		}
+		uint32_t stateSize = 0;
+		reader.Read(stateSize);
+		const uint8_t* state = reader.SkipBytes(stateSize);
+		if (state && loadedSystem) {
+			BinaryReader systemReader(state, stateSize);
+			loadedSystem->LoadState(systemReader);
+		}
+	}
+	for (auto& system : systems) {
+		if (std::find(loadedSystems.begin(), loadedSystems.end(), system.second.get()) == loadedSystems.end()) {
+			system.second->RemoveAllEntitiesFromSystem();
+		}
+	}
+	if (!reader.IsValid()) {
+		Logger::Err("The registry snapshot is cut short, the systems are left incomplete");
+		return false;
+	}
+	return true;
 }
 
 void Registry::Update() {
+	PROFILE_FUNCTION();
+
 	// TODO: Add the entities that are waiting to be created
 	for (auto entity : entitiesToBeAdded) {
 		AddEntityToSystems(entity);
@@ -1,12 +1,18 @@
 #ifndef ECS_H
 #define ECS_H
 #include "../Logger/Logger.h"
+#include "../Utils/BinaryStream.h"
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include <unordered_map>
 #include <typeindex>
 #include <set>
+#include <type_traits>
 #include <memory>
+#include <string>
 
 const unsigned int MAX_COMPONENTS = 32;
 
@@ -57,33 +63,130 @@ public:
 	class Registry* registry;
 };
 
+// Moves the values of a vector indexed by entity ID to the new IDs given by newIDs[old ID].
+// The vector grows to the number of entities, the slots that receive nothing get emptyValue.
+template <typename T>
+void RemapEntityVector(std::vector<T>& values, const std::vector<int>& newIDs, const T& emptyValue) {
+	std::vector<T> remappedValues(std::max(values.size(), newIDs.size()), emptyValue);
+	for (size_t oldID = 0; oldID < values.size(); oldID++) {
+		const size_t newID = oldID < newIDs.size() ? newIDs[oldID] : oldID;
+		remappedValues[newID] = std::move(values[oldID]);
+	}
+	values.swap(remappedValues);
+}
+
+// Writes the IDs of the entities as runs of consecutive IDs, the first ID and the length of each.
+// The lists are mostly sorted by ID, so a whole list often takes a few runs.
+void WriteEntityIDs(BinaryWriter& writer, const std::vector<Entity>& entities);
+
+// Calls visit(first ID, count) for each run written by WriteEntityIDs, in the same order.
+// Returns false, and invalidates the reader, when a run is damaged or goes past numEntities.
+template <typename TVisit>
+bool ReadEntityIDs(BinaryReader& reader, int numEntities, TVisit visit) {
+	uint32_t numRuns = 0;
+	reader.Read(numRuns);
+	const uint8_t* runs = reader.SkipBytes(static_cast<size_t>(numRuns) * 2 * sizeof(int32_t));
+	if (!runs) {
+		return false;
+	}
+	for (uint32_t i = 0; i < numRuns; i++) {
+		int32_t run[2];
+		std::memcpy(run, runs + i * sizeof(run), sizeof(run));
+		if (run[0] < 0 || run[1] < 0 || run[1] > numEntities - run[0]) {
+			reader.SetInvalid();
+			return false;
+		}
+		visit(run[0], run[1]);
+	}
+	return true;
+}
+
 /// <summary>
 /// The system will processes entities that contain a specific signature
 /// </summary>
 class System {
 private:
 	Signature componentSignature;
+	// The entities also need at least one of these components, when there are any
+	Signature anyComponentSignature;
 	std::vector<Entity> entities;
 
+	// [bit = entity ID], set for the entities of the list, kept up to date so the snapshots copy it whole
+	std::vector<uint64_t> entityBits;
+	// The list is sorted by ID unless an entity was added out of order, then it is saved as runs of IDs
+	bool areEntitiesSorted = true;
+
+	void SetEntityBit(int entityID, bool isSet);
+	// After the list was replaced, the bits and the order are found again from it
+	void UpdateEntityBits();
+
+protected:
+	// Same entity under its new ID
+	static Entity RemapEntity(const Entity& entity, const std::vector<int>& newIDs);
+
+	// Called after the entities changed IDs, systems that keep their own data per entity
+	// (in vectors indexed by entity ID, or Entity copies) override it to move that data
+	virtual void OnEntitiesRemapped(const std::vector<int>& /*newIDs*/) {}
+
 public:
 	System() = default;
-	~System() = default;
-
-	void AddEntityToSystem(Entity entity);
-	void RemoveEntityFromSystem(Entity entity);
-	std::vector<Entity> GetSystemEntities() const;
+	virtual ~System() = default;
+
+	// Systems that keep their own data per entity override these to stay in sync
+	virtual void AddEntityToSystem(Entity entity);
+	virtual void RemoveEntityFromSystem(Entity entity);
+	virtual void RemoveAllEntitiesFromSystem();
+
+	// Systems that carry data from one tick to the next, besides the components, save it in the
+	// registry snapshots. LoadState() runs once the system got its entities back, which are restored
+	// as a whole without AddEntityToSystem(), so it also rebuilds the system's own data per entity.
+	virtual void SaveState(BinaryWriter& /*writer*/) const {}
+	virtual void LoadState(BinaryReader& /*reader*/) {}
+
+	// The IDs of the system's entities, in the order they are visited. Loading calls
+	// RemoveAllEntitiesFromSystem() first, unless the system already has the same entities.
+	void SaveEntities(BinaryWriter& writer, int numEntities) const;
+	bool LoadEntities(BinaryReader& reader, class Registry* registry, int numEntities);
+	const std::vector<Entity>& GetSystemEntities() const;
 	const Signature& GetComponentSignature() const;
+	// True if an entity with these components belongs to the system
+	bool IsInterested(const Signature& entityComponentSignature) const;
+
+	// Gives the entities their new IDs, and keeps them sorted so they are visited in memory order
+	void RemapEntities(const std::vector<int>& newIDs);
 
 	// Defines the component type that entities have to be considered by the system
 	template <typename TComponent> void RequireComponent();
+	// Defines one of the component types, entities need at least one of them to be considered by the system
+	template <typename TComponent> void RequireAnyComponent();
 };
 
+// The pools of plain components are copied in blocks in the snapshots. The components that own
+// memory (strings) are saved one by one by their codec, these two functions overloaded next to their struct.
+template <typename TComponent>
+void WriteComponent(BinaryWriter& writer, const TComponent& component) {
+	static_assert(std::is_trivially_copyable<TComponent>::value, "This component owns memory, it needs its own WriteComponent() and ReadComponent()");
+	writer.Write(component);
+}
+
+template <typename TComponent>
+void ReadComponent(BinaryReader& reader, TComponent& component) {
+	reader.Read(component);
+}
+
 /// <summary>
 /// A pool is just a vector of objects type T
 /// </summary>
 class BasePool {
 public:
 	virtual ~BasePool() {};
+
+	// Moves the component of every entity to its new ID, newIDs[old ID]
+	virtual void Remap(const std::vector<int>& newIDs) = 0;
+
+	// Writes or reads the components of the entities whose signature has the componentID bit
+	virtual void Save(BinaryWriter& writer, const std::vector<Signature>& signatures, int componentID) const = 0;
+	virtual void Load(BinaryReader& reader, const std::vector<Signature>& signatures, int componentID) = 0;
 };
 
 template <typename T>
@@ -91,6 +194,9 @@ class Pool: public BasePool {
 private:
 	std::vector<T> data;
 
+	// The small plain components are copied in blocks in the snapshots, the others go through their codec
+	static constexpr bool isGathered = std::is_trivially_copyable<T>::value && sizeof(T) <= BINARY_WRITER_BLOCK_SIZE;
+
 public:
 	Pool(int size = 100) {
 		data.resize(size);
@@ -129,6 +235,83 @@ public:
 	T& operator [](unsigned int index) {
 		return data[index];
 	}
+
+	void Remap(const std::vector<int>& newIDs) override {
+		RemapEntityVector(data, newIDs, T());
+	}
+
+	void Save(BinaryWriter& writer, const std::vector<Signature>& signatures, int componentID) const override {
+		if constexpr (isGathered) {
+			// Only the components of the entities that have one are written, in one copy when every entity has one
+			const size_t numSlots = std::min(data.size(), signatures.size());
+			size_t numComponents = 0;
+			for (size_t entityID = 0; entityID < numSlots; entityID++) {
+				numComponents += signatures[entityID][componentID];
+			}
+			if (numComponents == numSlots) {
+				writer.WriteBytes(data.data(), numSlots * sizeof(T));
+				return;
+			}
+
+			// Otherwise they are gathered in a block without a branch per entity: every slot is copied,
+			// and the next copy overwrites it when the entity has none
+			const size_t blockLength = BINARY_WRITER_BLOCK_SIZE / sizeof(T);
+			uint8_t block[BINARY_WRITER_BLOCK_SIZE];
+			size_t numGathered = 0;
+			for (size_t entityID = 0; entityID < numSlots; entityID++) {
+				std::memcpy(block + numGathered * sizeof(T), &data[entityID], sizeof(T));
+				numGathered += signatures[entityID][componentID];
+				if (numGathered == blockLength) {
+					writer.WriteBytes(block, numGathered * sizeof(T));
+					numGathered = 0;
+				}
+			}
+			writer.WriteBytes(block, numGathered * sizeof(T));
+		} else {
+			for (size_t entityID = 0; entityID < signatures.size(); entityID++) {
+				if (signatures[entityID].test(componentID)) {
+					WriteComponent(writer, data[entityID]);
+				}
+			}
+		}
+	}
+
+	// The pool only grows, a pool that is already big enough is overwritten in place
+	void Load(BinaryReader& reader, const std::vector<Signature>& signatures, int componentID) override {
+		if (data.size() < signatures.size()) {
+			data.resize(signatures.size());
+		}
+		if constexpr (isGathered) {
+			size_t numComponents = 0;
+			size_t lastEntityID = 0;
+			for (size_t entityID = 0; entityID < signatures.size(); entityID++) {
+				const bool hasComponent = signatures[entityID][componentID];
+				numComponents += hasComponent;
+				lastEntityID = hasComponent ? entityID : lastEntityID;
+			}
+			const uint8_t* components = reader.SkipBytes(numComponents * sizeof(T));
+			if (!components || numComponents == 0) {
+				return;
+			}
+			if (numComponents == lastEntityID + 1) {
+				std::memcpy(data.data(), components, numComponents * sizeof(T));
+				return;
+			}
+
+			// Scattered the same way, every slot up to the last component gets the next one. The slots of the
+			// entities without the component get a copy of another, they are never read.
+			for (size_t entityID = 0; entityID <= lastEntityID; entityID++) {
+				std::memcpy(&data[entityID], components, sizeof(T));
+				components += signatures[entityID][componentID] * sizeof(T);
+			}
+		} else {
+			for (size_t entityID = 0; entityID < signatures.size(); entityID++) {
+				if (signatures[entityID].test(componentID)) {
+					ReadComponent(reader, data[entityID]);
+				}
+			}
+		}
+	}
 };
 
 /// <summary>
@@ -156,6 +339,9 @@ private:
 	std::set<Entity> entitiesToBeDestroyed;
 	std::set<Entity> entitiesToBeAdded;
 
+	// The systems found in the snapshot being loaded, the others lose their entities
+	std::vector<System*> loadedSystems;
+
 public:
 	Registry() {
 		Logger::Log("Registry constructor called");
@@ -183,9 +369,27 @@ public:
 	template <typename TSystem> bool HasSystem() const;
 	template <typename TSystem> TSystem& GetSystem() const;
 
+	// Statistics for the debug tools
+	int GetNumEntities() const;
+	int GetNumSystems() const;
+	std::vector<std::pair<std::string, int>> GetSystemEntityCounts() const;
+
 	// Checks the component sugnature of an entity and add it to the systems
 	// that are interested in the entity
 	void AddEntityToSystems(Entity entity);
+
+	// Gives every entity a new ID, newIDs[old ID], and moves its components and signature with it.
+	// newIDs must be a permutation of all the entity IDs. Entity copies held outside of
+	// the systems keep their old ID, so this should run between ticks.
+	void ReorderEntities(const std::vector<int>& newIDs);
+
+	// Writes every entity with its components, and the entities and state of the systems. A snapshot
+	// is only read by the build that wrote it, with the same systems, since the component IDs may change.
+	void SaveSnapshot(BinaryWriter& writer) const;
+	// Replaces the entities by the ones of the snapshot, the component pools must already exist.
+	// The pools and system lists are overwritten in place, so once they have grown to the size
+	// of the snapshot, loading it again does not allocate.
+	bool LoadSnapshot(BinaryReader& reader);
 };
 
 template <typename TComponent>
@@ -194,6 +398,12 @@ void System::RequireComponent() {
 	componentSignature.set(componentID);
 }
 
+template <typename TComponent>
+void System::RequireAnyComponent() {
+	const auto componentID = Component<TComponent>::GetID();
+	anyComponentSignature.set(componentID);
+}
+
 template <typename TComponent, typename ...TArgs> 
 void Registry::AddComponent(Entity entity, TArgs&& ...args) {
 	const auto componentID = Component<TComponent>::GetID();
@@ -251,7 +461,8 @@ template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const {
 	const auto componentID = Component<TComponent>::GetID();
 	const auto entityID = entity.GetID();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentID]);
+	// The systems call this for every entity each tick, a copy of the shared_ptr would update its count each time
+	auto componentPool = static_cast<Pool<TComponent>*>(componentPools[componentID].get());
 	return componentPool->Get(entityID);
 }
 
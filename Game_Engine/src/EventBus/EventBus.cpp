@@ -0,0 +1,45 @@
+#include "EventBus.h"
+#include "../Profiler/Profiler.h"
+
+int BaseEvent::nextID = 0;
+
+void EventBus::UnsubscribeFromEvents(const void* owner) {
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue) {
+			eventQueue->Unsubscribe(owner);
+		}
+	}
+}
+
+void EventBus::DispatchEvents() {
+	PROFILE_FUNCTION();
+
+	for (int pass = 0; pass < MAX_EVENT_DISPATCH_PASSES; pass++) {
+		bool hasEvents = false;
+		for (auto& eventQueue : eventQueues) {
+			if (eventQueue) {
+				eventQueue->MergeProducers();
+				hasEvents = hasEvents || eventQueue->HasEvents();
+			}
+		}
+		if (!hasEvents) {
+			return;
+		}
+
+		// By index, a handler that subscribes to a new type of event resizes the list of queues
+		for (size_t i = 0; i < eventQueues.size(); i++) {
+			if (eventQueues[i] && eventQueues[i]->HasEvents()) {
+				eventQueues[i]->Dispatch();
+			}
+		}
+	}
+	Logger::Err("Events are still being emitted after " + std::to_string(MAX_EVENT_DISPATCH_PASSES) + " dispatch passes, the rest waits for the next dispatch");
+}
+
+void EventBus::ClearEvents() {
+	for (auto& eventQueue : eventQueues) {
+		if (eventQueue) {
+			eventQueue->Clear();
+		}
+	}
+}
@@ -0,0 +1,240 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Events emitted by the handlers are delivered in the same DispatchEvents(), up to this many rounds
+const int MAX_EVENT_DISPATCH_PASSES = 16;
+
+struct BaseEvent {
+protected:
+	static int nextID;
+};
+
+// Assigns a unique ID to an event type, the queues are dispatched in the order of these IDs
+template <typename TEvent>
+class Event : public BaseEvent {
+public:
+	static int GetID() {
+		static auto ID = nextID++;
+		return ID;
+	}
+};
+
+class BaseEventQueue {
+public:
+	virtual ~BaseEventQueue() = default;
+	virtual void MergeProducers() = 0;
+	virtual bool HasEvents() const = 0;
+	virtual void Dispatch() = 0;
+	virtual void Clear() = 0;
+	virtual void Unsubscribe(const void* owner) = 0;
+};
+
+/// <summary>
+/// Contiguous buffer of the events of one type. The vectors are cleared but never shrunk,
+/// so once they reached the size of a busy frame, emitting an event doesn't allocate.
+/// </summary>
+template <typename TEvent>
+class EventQueue : public BaseEventQueue {
+	static_assert(std::is_trivially_copyable<TEvent>::value, "Events must be plain structs, they are copied in bulk");
+
+private:
+	struct Handler {
+		const void* owner;
+		std::function<void(const TEvent* events, size_t numEvents)> callback;
+		// Unsubscribed during a dispatch, it is erased once the loop over the handlers is done
+		bool isRemoved;
+	};
+
+	// A producer that runs on a worker writes to its own buffer, on its own cache line
+	struct alignas(64) ProducerBuffer {
+		std::vector<TEvent> events;
+	};
+
+	std::vector<TEvent> events;
+	// The batch being delivered, the handlers can queue new events in the meantime
+	std::vector<TEvent> dispatchingEvents;
+	std::vector<ProducerBuffer> producers;
+	std::vector<Handler> handlers;
+	// Subscribed during a dispatch, they are added after it and receive the next batches only
+	std::vector<Handler> addedHandlers;
+	// While true the handlers list is being walked, it must not move or shift
+	bool isDispatching = false;
+
+public:
+	void Subscribe(const void* owner, std::function<void(const TEvent* events, size_t numEvents)> callback) {
+		if (isDispatching) {
+			addedHandlers.push_back({ owner, std::move(callback), false });
+		} else {
+			handlers.push_back({ owner, std::move(callback), false });
+		}
+	}
+
+	void Unsubscribe(const void* owner) override {
+		auto isOwner = [owner](const Handler& handler) { return handler.owner == owner; };
+		addedHandlers.erase(std::remove_if(addedHandlers.begin(), addedHandlers.end(), isOwner), addedHandlers.end());
+		if (isDispatching) {
+			for (auto& handler : handlers) {
+				handler.isRemoved = handler.isRemoved || isOwner(handler);
+			}
+			return;
+		}
+		handlers.erase(std::remove_if(handlers.begin(), handlers.end(), isOwner), handlers.end());
+	}
+
+	void Emit(const TEvent& event) {
+		events.push_back(event);
+	}
+
+	void SetNumProducers(int numProducers) {
+		if (static_cast<int>(producers.size()) < numProducers) {
+			producers.resize(numProducers);
+		}
+	}
+
+	int GetNumProducers() const {
+		return static_cast<int>(producers.size());
+	}
+
+	void EmitFrom(int producer, const TEvent& event) {
+		assert(producer >= 0 && producer < static_cast<int>(producers.size()) && "The producer was not reserved");
+		producers[producer].events.push_back(event);
+	}
+
+	// Appends the producer buffers in producer order, which doesn't depend on the threads that filled them
+	void MergeProducers() override {
+		for (auto& producer : producers) {
+			events.insert(events.end(), producer.events.begin(), producer.events.end());
+			producer.events.clear();
+		}
+	}
+
+	bool HasEvents() const override {
+		return !events.empty();
+	}
+
+	// Every handler receives the whole batch, one after the other. The handlers can subscribe
+	// and unsubscribe meanwhile, the changes to the list are applied after the loop.
+	void Dispatch() override {
+		dispatchingEvents.swap(events);
+		events.clear();
+		isDispatching = true;
+		for (size_t i = 0; i < handlers.size(); i++) {
+			if (!handlers[i].isRemoved) {
+				handlers[i].callback(dispatchingEvents.data(), dispatchingEvents.size());
+			}
+		}
+		isDispatching = false;
+		dispatchingEvents.clear();
+
+		handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [](const Handler& handler) { return handler.isRemoved; }), handlers.end());
+		for (auto& handler : addedHandlers) {
+			handlers.push_back(std::move(handler));
+		}
+		addedHandlers.clear();
+	}
+
+	void Clear() override {
+		events.clear();
+		for (auto& producer : producers) {
+			producer.events.clear();
+		}
+	}
+};
+
+/// <summary>
+/// Lets the systems react to what happens in the others without sharing components.
+/// Events are queued when they are emitted and only delivered by DispatchEvents(), at the points
+/// of the frame chosen by the game, type after type in batches. Jobs running on the workers emit
+/// through numbered producers (the batch index, not the thread), which are merged in order before
+/// the dispatch, so the handlers see the same sequence whatever thread ran each batch.
+/// </summary>
+class EventBus {
+private:
+	// [vector index = event type ID]
+	std::vector<std::unique_ptr<BaseEventQueue>> eventQueues;
+
+	// Kept out of GetEventQueue(), so emitting an event compiles to a few instructions
+	template <typename TEvent>
+	EventQueue<TEvent>& CreateEventQueue() {
+		const auto eventID = Event<TEvent>::GetID();
+		if (eventID >= static_cast<int>(eventQueues.size())) {
+			eventQueues.resize(eventID + 1);
+		}
+		eventQueues[eventID] = std::make_unique<EventQueue<TEvent>>();
+		return static_cast<EventQueue<TEvent>&>(*eventQueues[eventID]);
+	}
+
+public:
+	EventBus() = default;
+
+	// A system that emits many events in a loop can keep the queue and call Emit() on it directly
+	template <typename TEvent>
+	EventQueue<TEvent>& GetEventQueue() {
+		const auto eventID = Event<TEvent>::GetID();
+		if (eventID < static_cast<int>(eventQueues.size()) && eventQueues[eventID]) {
+			return static_cast<EventQueue<TEvent>&>(*eventQueues[eventID]);
+		}
+		return CreateEventQueue<TEvent>();
+	}
+
+	// The owner's callback is called once per event
+	template <typename TEvent, typename TOwner>
+	void SubscribeToEvent(TOwner* owner, void (TOwner::*callback)(const TEvent& event)) {
+		GetEventQueue<TEvent>().Subscribe(owner, [owner, callback](const TEvent* events, size_t numEvents) {
+			for (size_t i = 0; i < numEvents; i++) {
+				(owner->*callback)(events[i]);
+			}
+		});
+	}
+
+	// The owner's callback receives all of the queued events of the type at once
+	template <typename TEvent, typename TOwner>
+	void SubscribeToEventBatch(TOwner* owner, void (TOwner::*callback)(const TEvent* events, size_t numEvents)) {
+		GetEventQueue<TEvent>().Subscribe(owner, [owner, callback](const TEvent* events, size_t numEvents) {
+			(owner->*callback)(events, numEvents);
+		});
+	}
+
+	// Removes every callback of the owner, before it is destroyed
+	void UnsubscribeFromEvents(const void* owner);
+
+	// Only from the main thread, the workers use EmitEventFrom()
+	template <typename TEvent, typename ...TArgs>
+	void EmitEvent(TArgs&& ...args) {
+		GetEventQueue<TEvent>().Emit(TEvent(std::forward<TArgs>(args)...));
+	}
+
+	// Called from the main thread before a parallel loop, with one producer per batch
+	template <typename TEvent>
+	void ReserveEventProducers(int numProducers) {
+		GetEventQueue<TEvent>().SetNumProducers(numProducers);
+	}
+
+	// Safe from any thread, as long as no two threads use the same producer at once. The queue is
+	// never created here, another worker could be reading the list of queues: ReserveEventProducers()
+	// must have created it and its producers before the parallel loop.
+	template <typename TEvent, typename ...TArgs>
+	void EmitEventFrom(int producer, TArgs&& ...args) {
+		const auto eventID = Event<TEvent>::GetID();
+		assert(eventID < static_cast<int>(eventQueues.size()) && eventQueues[eventID] && "ReserveEventProducers() was not called for this event");
+		auto& eventQueue = static_cast<EventQueue<TEvent>&>(*eventQueues[eventID]);
+		eventQueue.EmitFrom(producer, TEvent(std::forward<TArgs>(args)...));
+	}
+
+	// Delivers the queued events, including the ones that the handlers emit while it runs
+	void DispatchEvents();
+
+	// Drops the queued events without delivering them
+	void ClearEvents();
+};
+
+#endif // !EVENTBUS_H
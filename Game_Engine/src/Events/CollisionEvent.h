@@ -0,0 +1,18 @@
+#ifndef COLLISIONEVENT_H
+#define COLLISIONEVENT_H
+
+// Sent by the CollisionSystem when two entities start or stop touching. The IDs are the ones
+// of the tick that emitted it, the events are dispatched before the entities can be reordered.
+struct CollisionEvent {
+	int entityA;
+	int entityB;
+	bool isStarted;
+
+	CollisionEvent(int entityA = -1, int entityB = -1, bool isStarted = true) {
+		this->entityA = entityA;
+		this->entityB = entityB;
+		this->isStarted = isStarted;
+	}
+};
+
+#endif // !COLLISIONEVENT_H
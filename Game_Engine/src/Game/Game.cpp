@@ -4,19 +4,56 @@
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
+#include "../Components/TextLabelComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/BoidComponent.h"
+#include "../Components/KeyboardControlledComponent.h"
+#include "../Components/ReplicatedComponent.h"
 #include "../Systems/MovementSystem.h"
 #include "../Systems/RenderSystem.h"
+#include "../Systems/RenderTextSystem.h"
+#include "../Systems/CollisionSystem.h"
+#include "../Systems/SpatialQuerySystem.h"
+#include "../Systems/SpatialReorderSystem.h"
+#include "../Systems/FlockingSystem.h"
+#include "../Systems/KeyboardControlSystem.h"
+#include "../Profiler/Profiler.h"
+#include "../Rollback/RollbackSession.h"
+#include "../Rollback/LoopbackChannel.h"
+#include "../Network/ReplicationServer.h"
+#include "../Network/ReplicationClient.h"
 #include <SDL.h>
 #include <SDL_image.h>
+#include <SDL_ttf.h>
 #include <glm/glm.hpp>
+#include <imgui/imgui.h>
+#include <imgui/imgui_sdl.h>
+#include <cmath>
 #include <iostream>
-#include <fstream>
+#include <memory>
 
 // Constructor
 Game::Game() {
 	isRunning = false;
+	isDebug = false;
+	isHeadless = false;
+	level = 1;
+	broadphaseType = BROADPHASE_SWEEP_AND_PRUNE;
+	window = nullptr;
+	renderer = nullptr;
 	registry = std::make_unique<Registry>();
 	assetManager = std::make_unique<AssetManager>();
+	audioManager = std::make_unique<AudioManager>();
+	eventBus = std::make_unique<EventBus>();
+	inputManager = std::make_unique<InputManager>();
+	frameStats = std::make_unique<FrameStats>();
+	hitchRecorder = std::make_unique<HitchRecorder>(MILLISECS_HITCH_THRESHOLD);
+	tileMap = std::make_unique<TileMap>();
+	jobSystem = std::make_unique<JobSystem>();
+	navGrid = std::make_unique<NavGrid>();
+	hierarchicalGraph = std::make_unique<HierarchicalGraph>();
+	pathfinding = std::make_unique<PathfindingService>(*navGrid);
+	replayRecorder = std::make_unique<ReplayRecorder>();
 	Logger::Log("Game constructor called!");
 }
 
@@ -26,12 +63,37 @@ Game::~Game() {
 }
 
 // Function that will set up the scene of the game
-void Game::Start() {
+void Game::Start(bool isHeadless) {
+	this->isHeadless = isHeadless;
+
+	// The simulation only needs the timers
+	if (isHeadless) {
+		if (SDL_Init(SDL_INIT_TIMER) != 0) {
+			Logger::Err("Error initializing SDL.");
+			return;
+		}
+		random.Seed(SDL_GetPerformanceCounter());
+		windowWidth = 0;
+		windowHeight = 0;
+		Profiler::SetThreadName("Main");
+		isRunning = true;
+		return;
+	}
+
 	// If we can't initialize SDL, then display error message.
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
 		Logger::Err("Error initializing SDL.");
 		return;
 	}
+	random.Seed(SDL_GetPerformanceCounter());
+
+	if (TTF_Init() != 0) {
+		Logger::Err("Error initializing SDL TTF.");
+		return;
+	}
+
+	// The game can still run without sound if there is no audio device
+	audioManager->Start();
 
 	// Create operating system window
 	SDL_DisplayMode displayMode;
@@ -61,27 +123,394 @@ void Game::Start() {
 
 	SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 
+	// Initialize the ImGui context, used by the debug panels
+	ImGui::CreateContext();
+	ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
+
+	Profiler::SetThreadName("Main");
+
 	// After it initializes SDL, create window and render, then it is ready to run
 	isRunning = true;
 }
 
+void Game::SetBroadphase(BroadphaseType broadphaseType) {
+	this->broadphaseType = broadphaseType;
+}
+
 // The function includes the loop
 void Game::Run() {
 	SetUp();
 
 	// Game Loop
 	while (isRunning) {
+		Profiler::BeginFrame();
 		ProcessInput();
 		Update();
 		Render();
+		Profiler::EndFrame();
+
+		// A slow frame is written to disk once the profiler has all of its markers
+		hitchRecorder->CaptureIfPending(*registry);
+	}
+}
+
+bool Game::Record(const std::string& filePath) {
+	return replayRecorder->Open(filePath, PHYSICS_TICKS_PER_SECOND, level, random.GetSeed());
+}
+
+void Game::SaveKeyframe(std::vector<uint8_t>& keyframe) const {
+	BinaryWriter writer(keyframe);
+	writer.Write(static_cast<int32_t>(physicsTick));
+	writer.Write(random.GetState());
+	registry->SaveSnapshot(writer);
+}
+
+bool Game::LoadKeyframe(const uint8_t* keyframe, size_t keyframeSize) {
+	BinaryReader reader(keyframe, keyframeSize);
+	int32_t tick = 0;
+	uint64_t randomState = 0;
+	reader.Read(tick);
+	reader.Read(randomState);
+	if (!reader.IsValid() || !registry->LoadSnapshot(reader)) {
+		Logger::Err("Can't load the keyframe");
+		return false;
+	}
+	physicsTick = tick;
+	random.SetState(randomState);
+	return true;
+}
+
+bool Game::Replay(const std::string& filePath, int fromTick) {
+	ReplayPlayer replayPlayer;
+	if (!replayPlayer.Open(filePath)) {
+		return false;
+	}
+	if (replayPlayer.GetTicksPerSecond() != PHYSICS_TICKS_PER_SECOND) {
+		Logger::Err("The replay was recorded at " + std::to_string(replayPlayer.GetTicksPerSecond()) + " ticks per second, the game runs at " + std::to_string(PHYSICS_TICKS_PER_SECOND));
+		return false;
+	}
+
+	random.Seed(replayPlayer.GetSeed());
+	level = replayPlayer.GetLevel();
+	LoadLevel(level);
+
+	// Seeking restores the last keyframe before fromTick, then simulates the few ticks left
+	bool isSeeking = false;
+	if (fromTick > 0) {
+		if (fromTick >= replayPlayer.GetNumTicks()) {
+			Logger::Err("The replay only has " + std::to_string(replayPlayer.GetNumTicks()) + " ticks");
+			return false;
+		}
+		if (replayPlayer.SeekToKeyframe(fromTick) < 0) {
+			Logger::Err("The replay has no keyframe before tick " + std::to_string(fromTick));
+			return false;
+		}
+		isSeeking = true;
+	}
+
+	// The ticks run back to back, their duration is the benchmark. The path requests are answered
+	// within a time budget in a live session, so the gameplay that uses them doesn't replay exactly.
+	const double countsPerMillisecond = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	double slowestTickMilliseconds = 0.0;
+	int numTicks = 0;
+	bool isFrameOpen = false;
+
+	ReplayTick tick;
+	while (isRunning && replayPlayer.ReadTick(tick)) {
+		if (isSeeking && numTicks == 0) {
+			// The keyframe was saved after the frame update of its tick
+			if (!LoadKeyframe(tick.keyframe, tick.keyframeSize)) {
+				return false;
+			}
+		}
+		else if (tick.isNewFrame) {
+			// Same frame boundaries as the recording, the registry adds the new entities between frames
+			if (isFrameOpen) {
+				Profiler::EndFrame();
+			}
+			Profiler::BeginFrame();
+			isFrameOpen = true;
+			registry->Update();
+			eventBus->DispatchEvents();
+		}
+
+		if (isSeeking && physicsTick == fromTick) {
+			const double seekMilliseconds = (SDL_GetPerformanceCounter() - startCounter) / countsPerMillisecond;
+			Logger::Log("Seeked to tick " + std::to_string(fromTick) + " in " + std::to_string(seekMilliseconds) + " ms, simulating "
+				+ std::to_string(numTicks) + " ticks after the keyframe");
+			isSeeking = false;
+			startCounter = SDL_GetPerformanceCounter();
+			slowestTickMilliseconds = 0.0;
+			numTicks = 0;
+		}
+
+		const Uint64 tickStartCounter = SDL_GetPerformanceCounter();
+		tickInputs[0] = tick.input;
+		FixedUpdate();
+		slowestTickMilliseconds = std::max(slowestTickMilliseconds, (SDL_GetPerformanceCounter() - tickStartCounter) / countsPerMillisecond);
+		numTicks++;
+	}
+	if (isFrameOpen) {
+		Profiler::EndFrame();
+	}
+
+	const double totalMilliseconds = (SDL_GetPerformanceCounter() - startCounter) / countsPerMillisecond;
+	Logger::Log("Replayed " + std::to_string(numTicks) + " ticks in " + std::to_string(totalMilliseconds) + " ms, "
+		+ std::to_string(numTicks > 0 ? totalMilliseconds / numTicks : 0.0) + " ms per tick, slowest tick " + std::to_string(slowestTickMilliseconds) + " ms");
+	return true;
+}
+
+void Game::SimulateTick(const InputSnapshot* inputs, int numPlayers) {
+	// Same order as a frame: the new entities join the systems, then the tick runs. The events of a
+	// tick that runs again after a rollback are delivered again.
+	registry->Update();
+	eventBus->DispatchEvents();
+	for (int player = 0; player < MAX_PLAYERS; player++) {
+		tickInputs[player] = player < numPlayers ? inputs[player] : InputSnapshot(physicsTick);
+	}
+	FixedUpdate();
+}
+
+uint64_t Game::GetSimulationChecksum() const {
+	// FNV-1a over the values that diverge first when the peers are out of sync
+	uint64_t checksum = 14695981039346656037ULL;
+	auto addBytes = [&checksum](const void* bytes, size_t numBytes) {
+		for (size_t i = 0; i < numBytes; i++) {
+			checksum = (checksum ^ static_cast<const uint8_t*>(bytes)[i]) * 1099511628211ULL;
+		}
+	};
+	const uint64_t randomState = random.GetState();
+	addBytes(&physicsTick, sizeof(physicsTick));
+	addBytes(&randomState, sizeof(randomState));
+	for (auto entity : registry->GetSystem<MovementSystem>().GetSystemEntities()) {
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+		addBytes(&transform.position, sizeof(transform.position));
+		addBytes(&rigidbody.velocity, sizeof(rigidbody.velocity));
+	}
+	return checksum;
+}
+
+// Holds a random direction for a while, then changes it, like a player would
+static InputSnapshot NextBotInput(Random& random, const InputSnapshot& previousInput, int tick) {
+	const uint32_t movementActions = (1u << ACTION_MOVE_UP) | (1u << ACTION_MOVE_DOWN) | (1u << ACTION_MOVE_LEFT) | (1u << ACTION_MOVE_RIGHT);
+	InputSnapshot input(tick);
+	input.actionsDown = previousInput.actionsDown;
+	if (random.NextFloat() < 0.05f) {
+		input.actionsDown = random.NextUInt() & movementActions;
+	}
+	input.actionsPressed = input.actionsDown & ~previousInput.actionsDown;
+	input.actionsReleased = previousInput.actionsDown & ~input.actionsDown;
+	return input;
+}
+
+bool Game::RollbackLoopback(int numTicks, int latencyMilliseconds, int jitterMilliseconds) {
+	static_assert(MAX_PLAYERS == 2, "The loopback test runs one peer per player, and each peer sends to the other");
+
+	// The second peer is another game in this process, both load the same level with the same seed
+	Game remoteGame;
+	remoteGame.isHeadless = true;
+	remoteGame.level = level;
+	remoteGame.broadphaseType = broadphaseType;
+	Game* peers[MAX_PLAYERS] = { this, &remoteGame };
+
+	const uint64_t seed = random.GetSeed();
+	std::vector<std::unique_ptr<RollbackSession>> sessions;
+	for (int player = 0; player < MAX_PLAYERS; player++) {
+		Game& peer = *peers[player];
+		peer.random.Seed(seed);
+		peer.LoadLevel(level);
+		peer.CreatePlayerTank(1, glm::vec2(10.0, 300.0));
+		sessions.push_back(std::make_unique<RollbackSession>(MAX_PLAYERS, player,
+			[&peer](std::vector<uint8_t>& state) { peer.SaveKeyframe(state); },
+			[&peer](const uint8_t* state, size_t stateSize) { return peer.LoadKeyframe(state, stateSize); },
+			[&peer](const InputSnapshot* inputs, int numPlayers) { peer.SimulateTick(inputs, numPlayers); },
+			peer.physicsTick));
+	}
+
+	// incomingChannels[player] carries the inputs sent to that player's peer
+	LoopbackChannel localChannel(latencyMilliseconds, jitterMilliseconds, seed + 1);
+	LoopbackChannel remoteChannel(latencyMilliseconds, jitterMilliseconds, seed + 2);
+	LoopbackChannel* incomingChannels[MAX_PLAYERS] = { &localChannel, &remoteChannel };
+	Random botRandoms[MAX_PLAYERS] = { Random(seed + 3), Random(seed + 4) };
+	InputSnapshot botInputs[MAX_PLAYERS] = { InputSnapshot(-1), InputSnapshot(-1) };
+	int numStalledTicks[MAX_PLAYERS] = { 0, 0 };
+	Uint64 advanceCounters[MAX_PLAYERS] = { 0, 0 };
+
+	// Both peers try to run one tick per tick of the simulated clock
+	const double millisecondsPerTick = 1000.0 / PHYSICS_TICKS_PER_SECOND;
+	double time = 0.0;
+	while (sessions[0]->GetCurrentTick() < numTicks || sessions[1]->GetCurrentTick() < numTicks) {
+		for (int player = 0; player < MAX_PLAYERS; player++) {
+			RollbackSession& session = *sessions[player];
+			RollbackInputMessage message;
+			while (incomingChannels[player]->Receive(time, message)) {
+				session.AddRemoteInput(message.player, message.tick, message.input);
+			}
+			if (session.GetCurrentTick() >= numTicks) {
+				continue;
+			}
+
+			// The input of a tick is read once, even if the peer has to wait before running it
+			if (botInputs[player].tick < session.GetCurrentTick()) {
+				botInputs[player] = NextBotInput(botRandoms[player], botInputs[player], session.GetCurrentTick());
+				session.AddLocalInput(botInputs[player]);
+				incomingChannels[1 - player]->Send(time, { player, botInputs[player].tick, botInputs[player] });
+			}
+			const Uint64 startCounter = SDL_GetPerformanceCounter();
+			if (!session.AdvanceTick()) {
+				numStalledTicks[player]++;
+			}
+			advanceCounters[player] += SDL_GetPerformanceCounter() - startCounter;
+		}
+		time += millisecondsPerTick;
+	}
+
+	// The last inputs arrive, and correct the last predictions
+	while (localChannel.GetNumPendingMessages() > 0 || remoteChannel.GetNumPendingMessages() > 0) {
+		time += millisecondsPerTick;
+		for (int player = 0; player < MAX_PLAYERS; player++) {
+			RollbackInputMessage message;
+			while (incomingChannels[player]->Receive(time, message)) {
+				sessions[player]->AddRemoteInput(message.player, message.tick, message.input);
+			}
+			const Uint64 startCounter = SDL_GetPerformanceCounter();
+			sessions[player]->Synchronize();
+			advanceCounters[player] += SDL_GetPerformanceCounter() - startCounter;
+		}
+	}
+
+	const double countsPerMillisecond = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+	for (int player = 0; player < MAX_PLAYERS; player++) {
+		const RollbackSession& session = *sessions[player];
+		const int numResimulatedTicks = session.GetNumResimulatedTicks();
+		const double resimulationMilliseconds = session.GetResimulationMilliseconds();
+		const double tickMilliseconds = (advanceCounters[player] / countsPerMillisecond - resimulationMilliseconds) / numTicks;
+		Logger::Log("Peer " + std::to_string(player) + ": " + std::to_string(session.GetNumRollbacks()) + " rollbacks, "
+			+ std::to_string(numResimulatedTicks) + " ticks simulated again (at most " + std::to_string(session.GetMaxRollbackTicks()) + " at once), "
+			+ std::to_string(numResimulatedTicks > 0 ? resimulationMilliseconds / numResimulatedTicks : 0.0) + " ms per tick simulated again, "
+			+ std::to_string(tickMilliseconds) + " ms per tick otherwise, waited " + std::to_string(numStalledTicks[player]) + " ticks for the other peer");
+	}
+
+	if (sessions[0]->GetConfirmedTick() != numTicks - 1 || sessions[1]->GetConfirmedTick() != numTicks - 1
+		|| GetSimulationChecksum() != remoteGame.GetSimulationChecksum()) {
+		Logger::Err("The peers ended out of sync after " + std::to_string(numTicks) + " ticks, with "
+			+ std::to_string(latencyMilliseconds) + " ms of latency and " + std::to_string(jitterMilliseconds) + " ms of jitter");
+		return false;
+	}
+	Logger::Log("Both peers ended in the same state after " + std::to_string(numTicks) + " ticks, with "
+		+ std::to_string(latencyMilliseconds) + " ms of latency and " + std::to_string(jitterMilliseconds) + " ms of jitter");
+	return true;
+}
+
+// Replicated entities of the test, and the updates without simulation that let the clients catch up at the end
+const int REPLICATION_TEST_NUM_BOIDS = 400;
+const int REPLICATION_TEST_SETTLE_UPDATES = 30;
+
+// The views are spread over the map, so the clients see different and overlapping parts of it
+static glm::vec2 GetTestViewCenter(int client, int numClients, float mapWidth, float mapHeight) {
+	return glm::vec2(mapWidth * (client + 0.5f) / numClients, mapHeight * (client % 2 == 0 ? 0.3f : 0.7f));
+}
+
+bool Game::ReplicationLoopback(int numTicks, int numClients, float packetLossRate) {
+	LoadLevel(level);
+	const float mapWidth = tileMap->GetNumCols() * tileMap->GetTileSize();
+	const float mapHeight = tileMap->GetNumRows() * tileMap->GetTileSize();
+	for (int i = 0; i < REPLICATION_TEST_NUM_BOIDS; i++) {
+		const float angle = random.NextFloat() * 6.2831853f;
+		Entity boid = registry->CreateEntity();
+		boid.AddComponent<TransformComponent>(glm::vec2(random.NextFloat() * mapWidth, random.NextFloat() * mapHeight), glm::vec2(2.0, 2.0), 0.0);
+		boid.AddComponent<RigidBodyComponent>(glm::vec2(std::cos(angle), std::sin(angle)) * 60.0f);
+		boid.AddComponent<BoidComponent>(i % 4);
+		boid.AddComponent<ReplicatedComponent>(static_cast<uint32_t>(i + 1));
+	}
+
+	ReplicationServer server;
+	if (!server.Start()) {
+		return false;
+	}
+	const uint64_t seed = random.GetSeed();
+	server.SetSimulatedPacketLoss(packetLossRate, seed + 1);
+	server.SetWorldBounds({ glm::vec2(0.0f, 0.0f), glm::vec2(mapWidth, mapHeight) });
+
+	std::vector<std::unique_ptr<ReplicationClient>> clients;
+	for (int i = 0; i < numClients; i++) {
+		auto client = std::make_unique<ReplicationClient>();
+		client->SetViewCenter(GetTestViewCenter(i, numClients, mapWidth, mapHeight));
+		client->SetSimulatedPacketLoss(packetLossRate, seed + 2 + i);
+		if (!client->Connect(NetworkAddress::Localhost(server.GetPort()))) {
+			return false;
+		}
+		clients.push_back(std::move(client));
+	}
+
+	const SpatialQuerySystem& spatialQuery = registry->GetSystem<SpatialQuerySystem>();
+	const InputSnapshot idleInput(-1);
+	Uint64 serverCounter = 0;
+	for (int tick = 0; tick < numTicks; tick++) {
+		SimulateTick(&idleInput, 1);
+		const Uint64 startCounter = SDL_GetPerformanceCounter();
+		server.Update(*registry, spatialQuery, physicsTick);
+		serverCounter += SDL_GetPerformanceCounter() - startCounter;
+		for (auto& client : clients) {
+			client->Update();
+		}
+	}
+	const uint64_t numBytesSent = server.GetNumBytesSent();
+	const int numPacketsLost = server.GetNumDroppedPackets();
+	int numPacketsDropped = 0;
+	for (const auto& client : clients) {
+		numPacketsDropped += client->GetNumPacketsDropped();
+	}
+
+	// The world stops and the packets go through, every client should end up with what the server sees
+	server.SetSimulatedPacketLoss(0.0f, seed + 1);
+	for (auto& client : clients) {
+		client->SetSimulatedPacketLoss(0.0f, 0);
 	}
+	for (int i = 0; i < REPLICATION_TEST_SETTLE_UPDATES; i++) {
+		server.Update(*registry, spatialQuery, physicsTick);
+		for (auto& client : clients) {
+			client->Update();
+		}
+	}
+
+	const double countsPerMillisecond = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0;
+	Logger::Log(std::to_string(numClients) + " clients, " + std::to_string(numTicks) + " ticks, " + std::to_string(static_cast<int>(packetLossRate * 100.0f))
+		+ "% packet loss: " + std::to_string(static_cast<double>(numBytesSent) / (numClients * numTicks)) + " bytes per client per tick, "
+		+ std::to_string(numPacketsLost) + " snapshots lost, " + std::to_string(numPacketsDropped) + " received without their baseline, "
+		+ std::to_string(serverCounter / countsPerMillisecond / numTicks) + " ms per server update");
+
+	int numClientsOutOfSync = 0;
+	ReplicationSnapshot expectedSnapshot;
+	for (int i = 0; i < numClients; i++) {
+		const ReplicationClient& client = *clients[i];
+		server.GetInterestSnapshot(*registry, spatialQuery, GetTestViewCenter(i, numClients, mapWidth, mapHeight), expectedSnapshot);
+		bool isInSync = client.HasSnapshot() && client.GetLatestSnapshot().entities.size() == expectedSnapshot.entities.size();
+		for (size_t j = 0; isInSync && j < expectedSnapshot.entities.size(); j++) {
+			const ReplicatedEntity& entity = client.GetLatestSnapshot().entities[j];
+			isInSync = entity.networkID == expectedSnapshot.entities[j].networkID && entity.transform == expectedSnapshot.entities[j].transform;
+		}
+		if (!isInSync) {
+			numClientsOutOfSync++;
+		}
+	}
+	if (numClientsOutOfSync > 0) {
+		Logger::Err(std::to_string(numClientsOutOfSync) + " of the " + std::to_string(numClients) + " clients don't have the state of the server");
+		return false;
+	}
+	Logger::Log("Every client has the state of the server around its view, " + std::to_string(expectedSnapshot.entities.size()) + " entities for the last one");
+	return true;
 }
 
 void Game::ProcessInput() {
+	PROFILE_FUNCTION();
 
 	// pure struct
 	SDL_Event sdlEvent;
 
+	// The window and debug keys are handled right away, the rest is queued for the next physics tick
 	// not passing entire struct, just a reference (address)
 	while (SDL_PollEvent(&sdlEvent)) {
 		switch (sdlEvent.type) {
@@ -93,20 +522,38 @@ void Game::ProcessInput() {
 				if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
 					isRunning = false;
 				}
+				// Show or hide the debug panels
+				if (sdlEvent.key.keysym.sym == SDLK_F1) {
+					isDebug = !isDebug;
+				}
+				break;
+			case SDL_MOUSEWHEEL:
+				ImGui::GetIO().MouseWheel += static_cast<float>(sdlEvent.wheel.y);
 				break;
 		}
+		inputManager->PushEvent(sdlEvent);
 	}
 }
 
 void Game::LoadLevel(int level) {
 	// Add the systems that need to be processed in our game
-	registry->AddSystem<MovementSystem>();
+	registry->AddSystem<MovementSystem>(PHYSICS_SUBSTEPS);
 	registry->AddSystem<RenderSystem>();
-
-	// Add assets to the asset manager
-	assetManager->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
-	assetManager->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-right.png");
-	assetManager->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
+	registry->AddSystem<RenderTextSystem>();
+	registry->AddSystem<CollisionSystem>(broadphaseType);
+	registry->AddSystem<SpatialQuerySystem>();
+	registry->AddSystem<SpatialReorderSystem>();
+	registry->AddSystem<FlockingSystem>();
+	registry->AddSystem<KeyboardControlSystem>();
+
+	// Add assets to the asset manager, nothing is drawn without a window
+	if (!isHeadless) {
+		assetManager->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
+		assetManager->AddTexture(renderer, "truck-image", "./assets/images/truck-ford-right.png");
+		assetManager->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
+		assetManager->AddFont("charriot-font", "./assets/fonts/charriot.ttf", 20);
+		assetManager->AddFont("arial-font", "./assets/fonts/arial.ttf", 14);
+	}
 
 	// Load the tilemap
 	int tileSize = 32;
@@ -114,17 +561,24 @@ void Game::LoadLevel(int level) {
 	int mapNumCols = 25;
 	int mapNumRows = 20;
 
-	std::fstream mapFile;
-	mapFile.open("./assets/tilemaps/jungle.map");
+	// The collision layer keeps the tile IDs, the entities are only used to draw the tiles
+	const bool isMapLoaded = tileMap->LoadMap("./assets/tilemaps/jungle.map", mapNumCols, mapNumRows, static_cast<float>(tileSize * tileScale));
+	tileMap->SetSolidTileIDs(SOLID_TILE_IDS);
+	navGrid->Build(*tileMap);
+	navGrid->SetCellChangedCallback(nullptr);
+	if (navGrid->GetNumCells() >= MIN_CELLS_FOR_HIERARCHICAL_PATHFINDING) {
+		hierarchicalGraph->Build(*navGrid, jobSystem.get());
+		pathfinding->SetHierarchicalGraph(hierarchicalGraph.get());
+		// the clusters of the changed tiles are rebuilt by the pathfinding, a few per frame
+		navGrid->SetCellChangedCallback([this](int col, int row) { hierarchicalGraph->OnCellChanged(col, row); });
+	}
 
-	for (int y = 0; y < mapNumRows; y++) {
+	// Without its map the level has no tiles, the other entities are still created
+	for (int y = 0; isMapLoaded && y < mapNumRows; y++) {
 		for (int x = 0; x < mapNumCols; x++) {
-			char ch;
-			mapFile.get(ch);
-			int srcRectY = std::atoi(&ch) * tileSize;
-			mapFile.get(ch);
-			int srcRectX = std::atoi(&ch) * tileSize;
-			mapFile.ignore();
+			int tileID = tileMap->GetTileID(x, y);
+			int srcRectY = (tileID / TILESET_NUM_COLS) * tileSize;
+			int srcRectX = (tileID % TILESET_NUM_COLS) * tileSize;
 
 			Entity tile = registry->CreateEntity();
 			tile.AddComponent<TransformComponent>
@@ -135,61 +589,185 @@ void Game::LoadLevel(int level) {
 			tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, 0, srcRectX, srcRectY);
 		}
 	}
-	mapFile.close();
 
 
 	// Create an Entity and Add components to that entity
-	Entity tank = registry->CreateEntity();
-	tank.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(5.0, 5.0), 0.0);
-	tank.AddComponent<RigidBodyComponent>(glm::vec2(30.0, 0.0));
-	tank.AddComponent<SpriteComponent>("tank-image", 32, 32, 1);
+	CreatePlayerTank(0, glm::vec2(10.0, 10.0));
 
 	Entity truck = registry->CreateEntity();
 	truck.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(5.0, 5.0), 90.0);
 	truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 30.0));
 	truck.AddComponent<SpriteComponent>("truck-image", 32, 32, 2);
+	truck.AddComponent<BoxColliderComponent>(32, 32);
+
+	Entity label = registry->CreateEntity();
+	SDL_Color green = { 0, 255, 0, 255 };
+	label.AddComponent<TextLabelComponent>(glm::vec2(windowWidth / 2 - 40, 10), "GAME ENGINE 1.0", "charriot-font", green);
+}
+
+void Game::CreatePlayerTank(int player, glm::vec2 position) {
+	Entity tank = registry->CreateEntity();
+	tank.AddComponent<TransformComponent>(position, glm::vec2(5.0, 5.0), 0.0);
+	tank.AddComponent<RigidBodyComponent>(glm::vec2(30.0, 0.0));
+	tank.AddComponent<SpriteComponent>("tank-image", 32, 32, 1);
+	tank.AddComponent<BoxColliderComponent>(32, 32);
+	tank.AddComponent<KeyboardControlledComponent>(80.0f, player);
 }
 
 // Initialize Game Objects positions, callers, etc. at the start of the game
 void Game::SetUp() {
-	LoadLevel(1);
+	// Watch the assets folder, so art changes show up without restarting the game
+	assetManager->EnableHotReload("./assets");
+
+	// Both the arrows and WASD move, bound by position so other keyboard layouts keep the same keys
+	inputManager->BindKey(SDL_SCANCODE_UP, ACTION_MOVE_UP);
+	inputManager->BindKey(SDL_SCANCODE_DOWN, ACTION_MOVE_DOWN);
+	inputManager->BindKey(SDL_SCANCODE_LEFT, ACTION_MOVE_LEFT);
+	inputManager->BindKey(SDL_SCANCODE_RIGHT, ACTION_MOVE_RIGHT);
+	inputManager->BindKey(SDL_SCANCODE_W, ACTION_MOVE_UP);
+	inputManager->BindKey(SDL_SCANCODE_S, ACTION_MOVE_DOWN);
+	inputManager->BindKey(SDL_SCANCODE_A, ACTION_MOVE_LEFT);
+	inputManager->BindKey(SDL_SCANCODE_D, ACTION_MOVE_RIGHT);
+	inputManager->BindKey(SDL_SCANCODE_SPACE, ACTION_FIRE);
+	inputManager->BindMouseButton(SDL_BUTTON_LEFT, ACTION_FIRE);
+
+	LoadLevel(level);
 }
 
 void Game::Update() {
+	PROFILE_FUNCTION();
+
 	// if we are too fast, waste some time until we reach the MILLISECS_PER_FRAME
 	int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecPreviousFrame);
 	if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) {
+		PROFILE_SCOPE("Game::WaitForFrame");
 		SDL_Delay(timeToWait);
 	}
 
 	// The difference in ticks since the last frame, converted to seconds
 	double deltaTime = (SDL_GetTicks() - millisecPreviousFrame) / 1000.0;
 
+	// Keep track of the frame times to find the stutters,
+	// the first frame also measures the loading time so it is left out
+	if (millisecPreviousFrame > 0) {
+		frameStats->AddFrame(static_cast<float>(deltaTime * 1000.0));
+		hitchRecorder->AddFrame(deltaTime * 1000.0);
+	}
+
 	// Store the previous frame time	
 	millisecPreviousFrame = SDL_GetTicks();
 
+	// Swap the textures that were modified on disk at the frame boundary
+	assetManager->ProcessReloads(renderer, MILLISECS_ASSET_RELOAD_BUDGET);
+
 	// Update the registry to process the entities that are waiting to be created/deleted
 	registry->Update();
+	replayRecorder->BeginFrame();
+
+	// Answer the path requests of the previous frames, within the budget
+	pathfinding->Update(*jobSystem, MILLISECS_PATHFINDING_BUDGET);
+
+	// Deliver the events emitted outside of the physics ticks
+	eventBus->DispatchEvents();
+
+	// Run as many physics ticks as the time that passed, rendering doesn't wait for a whole tick
+	physicsAccumulator += deltaTime;
+	int numTicks = 0;
+	while (physicsAccumulator >= SECONDS_PER_PHYSICS_TICK && numTicks < MAX_PHYSICS_TICKS_PER_FRAME) {
+		// The input received since the previous tick, the same for every system of this tick
+		tickInputs[0] = inputManager->BuildSnapshot(physicsTick);
+		if (replayRecorder->IsOpen()) {
+			const bool isKeyframeTick = physicsTick % REPLAY_TICKS_PER_KEYFRAME == 0;
+			if (isKeyframeTick) {
+				keyframe.clear();
+				SaveKeyframe(keyframe);
+			}
+			replayRecorder->WriteTick(tickInputs[0], isKeyframeTick ? &keyframe : nullptr);
+		}
+		FixedUpdate();
+		physicsAccumulator -= SECONDS_PER_PHYSICS_TICK;
+		numTicks++;
+	}
+	if (physicsAccumulator >= SECONDS_PER_PHYSICS_TICK) {
+		physicsAccumulator = std::fmod(physicsAccumulator, SECONDS_PER_PHYSICS_TICK);
+	}
+}
+
+void Game::FixedUpdate() {
+	PROFILE_FUNCTION();
+
+	// Once in a while, store the entities that are close in the world close in memory
+	if (PHYSICS_TICKS_PER_ENTITY_REORDER > 0 && physicsTick % PHYSICS_TICKS_PER_ENTITY_REORDER == 0) {
+		registry->GetSystem<SpatialReorderSystem>().Update(*registry);
+	}
+
+	// Call all the systems that need to update, always with the same step
+	registry->GetSystem<KeyboardControlSystem>().Update(tickInputs, MAX_PLAYERS, registry->GetSystem<MovementSystem>());
+	registry->GetSystem<FlockingSystem>().Update(SECONDS_PER_PHYSICS_TICK, *jobSystem, registry->GetSystem<MovementSystem>());
+	registry->GetSystem<MovementSystem>().Update(SECONDS_PER_PHYSICS_TICK);
+	registry->GetSystem<CollisionSystem>().Update(registry->GetSystem<MovementSystem>());
 
-	// Call all the systems that need to update
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
+	// A new contact wakes the sleeping bodies that were hit
+	registry->GetSystem<MovementSystem>().WakeUpColliding(registry->GetSystem<CollisionSystem>().GetCollisionsStarted());
 
-	// TODO: registry->GetSystem<CollisionSystem>().Update();
+	// Index the new positions for the gameplay queries of the next tick
+	registry->GetSystem<SpatialQuerySystem>().Update();
+
+	// The gameplay reacts to the tick before the next one can reorder the entity IDs
+	registry->GetSystem<CollisionSystem>().EmitCollisionEvents(*eventBus);
+	eventBus->DispatchEvents();
+
+	physicsTick++;
 }
 
 void Game::Render() {
+	PROFILE_FUNCTION();
+
 	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
 	SDL_RenderClear(renderer);
 
 	// Call all the systems that need to render
 	registry->GetSystem<RenderSystem>().Update(renderer, assetManager);
+	registry->GetSystem<RenderTextSystem>().Update(renderer, assetManager);
+
+	// Display the debug panels on top of the game
+	if (isDebug) {
+		PROFILE_SCOPE("Game::RenderDebug");
+
+		ImGuiIO& io = ImGui::GetIO();
+		int mouseX, mouseY;
+		const Uint32 buttons = SDL_GetMouseState(&mouseX, &mouseY);
+		io.MousePos = ImVec2(static_cast<float>(mouseX), static_cast<float>(mouseY));
+		io.MouseDown[0] = (buttons & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
+		io.MouseDown[1] = (buttons & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
+
+		ImGui::NewFrame();
+		Profiler::DrawPanel();
+		frameStats->DrawPanel();
+		ImGui::Render();
+		ImGuiSDL::Render(ImGui::GetDrawData());
+	}
 
-	SDL_RenderPresent(renderer);
+	{
+		PROFILE_SCOPE("Game::Present");
+		SDL_RenderPresent(renderer);
+	}
 }
 
 // Destroy window, game objects
 void Game::Stop() {
+	replayRecorder->Close();
+	if (isHeadless) {
+		SDL_Quit();
+		return;
+	}
+	audioManager->Stop();
+	assetManager->DisableHotReload();
+	assetManager->ClearAssets();
+	ImGuiSDL::Deinitialize();
+	ImGui::DestroyContext();
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
+	TTF_Quit();
 	SDL_Quit();
 }
\ No newline at end of file
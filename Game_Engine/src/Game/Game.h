@@ -2,29 +2,128 @@
 #define GAME_H
 #include "../ECS/ECS.h"
 #include "../AssetManager/AssetManager.h"
+#include "../AudioManager/AudioManager.h"
+#include "../Collision/Broadphase.h"
+#include "../EventBus/EventBus.h"
+#include "../Input/InputManager.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Navigation/NavGrid.h"
+#include "../Navigation/HierarchicalGraph.h"
+#include "../Navigation/PathfindingService.h"
+#include "../Replay/ReplayRecorder.h"
+#include "../Replay/ReplayPlayer.h"
+#include "../Profiler/FrameStats.h"
+#include "../Profiler/HitchRecorder.h"
+#include "../TileMap/TileMap.h"
+#include "../Utils/Random.h"
 #include <SDL.h>
+#include <string>
+#include <vector>
 
 const int FPS = 60;
 const int MILLISECS_PER_FRAME = 1000 / FPS;
 
+// Slice of the frame that can be spent swapping assets that changed on disk
+const double MILLISECS_ASSET_RELOAD_BUDGET = 2.0;
+
+// Slice of the frame that can be spent searching the paths requested by the units
+const double MILLISECS_PATHFINDING_BUDGET = 2.0;
+
+// Maps with more tiles than this also get a hierarchical graph for the long paths
+const int MIN_CELLS_FOR_HIERARCHICAL_PATHFINDING = 256 * 256;
+
+// Frames slower than this are captured to disk by the hitch recorder
+const double MILLISECS_HITCH_THRESHOLD = 2.0 * MILLISECS_PER_FRAME;
+
+// The simulation advances in fixed steps, so it doesn't depend on the frame rate
+const int PHYSICS_TICKS_PER_SECOND = 60;
+const double SECONDS_PER_PHYSICS_TICK = 1.0 / PHYSICS_TICKS_PER_SECOND;
+const int PHYSICS_SUBSTEPS = 2;
+
+// After a long hitch the extra time is dropped instead of simulating dozens of ticks at once
+const int MAX_PHYSICS_TICKS_PER_FRAME = 5;
+
+// Entities are reordered by position every few seconds to keep the pools cache friendly, 0 disables it
+const int PHYSICS_TICKS_PER_ENTITY_REORDER = 10 * PHYSICS_TICKS_PER_SECOND;
+
+// A recorded session stores a snapshot every few seconds, seeking in the replay never simulates more ticks than that
+const int REPLAY_TICKS_PER_KEYFRAME = 10 * PHYSICS_TICKS_PER_SECOND;
+
+// Tiles of the jungle tileset that block movement and sight (open water)
+const std::vector<int> SOLID_TILE_IDS = { 8 };
+
 class Game {
 private:
 	bool isRunning;
+	bool isDebug;
+	// No window, renderer or sound, only the simulation runs (for the replays)
+	bool isHeadless;
+	int level;
+	// The vehicles move a few pixels per frame, the sort based broadphase takes advantage of it
+	BroadphaseType broadphaseType;
 	int millisecPreviousFrame = 0;
+	double physicsAccumulator = 0.0;
+	int physicsTick = 0;
+	// Actions of each player during the physics tick being simulated, read by the systems.
+	// Only the first player plays in a local session.
+	InputSnapshot tickInputs[MAX_PLAYERS];
+	// The only source of randomness of the simulation, its seed is saved in the replays
+	Random random;
 	SDL_Window* window;
 	SDL_Renderer* renderer;
 
 	std::unique_ptr<Registry> registry;
 	std::unique_ptr<AssetManager> assetManager;
+	std::unique_ptr<AudioManager> audioManager;
+	std::unique_ptr<EventBus> eventBus;
+	std::unique_ptr<InputManager> inputManager;
+	std::unique_ptr<FrameStats> frameStats;
+	std::unique_ptr<HitchRecorder> hitchRecorder;
+	std::unique_ptr<TileMap> tileMap;
+	std::unique_ptr<JobSystem> jobSystem;
+	std::unique_ptr<NavGrid> navGrid;
+	std::unique_ptr<HierarchicalGraph> hierarchicalGraph;
+	std::unique_ptr<PathfindingService> pathfinding;
+	std::unique_ptr<ReplayRecorder> replayRecorder;
+	// Reused for the keyframes of the recording
+	std::vector<uint8_t> keyframe;
+
+	// State of the simulation between two ticks: the tick, the random sequence and the registry
+	void SaveKeyframe(std::vector<uint8_t>& keyframe) const;
+	bool LoadKeyframe(const uint8_t* keyframe, size_t keyframeSize);
+
+	// Runs one tick with the given input of each player, as the rollback sessions step the game
+	void SimulateTick(const InputSnapshot* inputs, int numPlayers);
+	// Hash of the tick, the random sequence and the bodies, the same on every peer that is in sync
+	uint64_t GetSimulationChecksum() const;
+
+	void CreatePlayerTank(int player, glm::vec2 position);
 
 public:
 	Game();
 	~Game();
-	void Start();
+	void Start(bool isHeadless = false);
+	// The broadphase of the collision system, to be called before the level is loaded
+	void SetBroadphase(BroadphaseType broadphaseType);
+	// Saves the inputs of the session, to be called before Run()
+	bool Record(const std::string& filePath);
+	// Runs a recorded session headless, as fast as possible, and logs how long the ticks took.
+	// With fromTick, it first seeks there from the last keyframe and only times the ticks after it.
+	bool Replay(const std::string& filePath, int fromTick = 0);
+	// Runs the two peers of a rollback session in this process, headless, on a simulated clock.
+	// Bots play both players and the peers send their inputs to each other with the given latency
+	// and jitter. Logs what the rollbacks cost and checks that both peers end in the same state.
+	bool RollbackLoopback(int numTicks, int latencyMilliseconds, int jitterMilliseconds);
+	// Runs this game as a replication server for clients in this process, over localhost UDP, headless.
+	// A flock moves over the map, each client looks at another part of it and the given share of the
+	// packets is dropped both ways. Logs the bytes sent per client per tick and checks that every
+	// client ends with the state the server has around its view.
+	bool ReplicationLoopback(int numTicks, int numClients, float packetLossRate);
 	void SetUp();
 	void ProcessInput();
 	void LoadLevel(int level);
 	void Update();
+	void FixedUpdate();
 	void Render();
 	void Run();
 	void Stop();
@@ -0,0 +1,139 @@
+#include "InputManager.h"
+#include "../Logger/Logger.h"
+#include <string>
+
+InputManager::InputManager() {
+	numDroppedEvents = 0;
+	keyActions.assign(SDL_NUM_SCANCODES, -1);
+	mouseButtonActions.assign(MAX_MOUSE_BUTTONS, -1);
+	isKeyHeld.assign(SDL_NUM_SCANCODES, 0);
+	isMouseButtonHeld.assign(MAX_MOUSE_BUTTONS, 0);
+	for (int action = 0; action < NUM_INPUT_ACTIONS; action++) {
+		numInputsHeld[action] = 0;
+	}
+	mousePosition = glm::ivec2(0);
+	polledMousePosition = glm::ivec2(0);
+}
+
+void InputManager::BindKey(SDL_Scancode scancode, InputAction action) {
+	if (scancode < 0 || scancode >= SDL_NUM_SCANCODES) {
+		Logger::Err("Can't bind the unknown scancode " + std::to_string(scancode));
+		return;
+	}
+	keyActions[scancode] = action;
+}
+
+void InputManager::BindMouseButton(int button, InputAction action) {
+	if (button < 0 || button >= MAX_MOUSE_BUTTONS) {
+		Logger::Err("Can't bind the mouse button " + std::to_string(button));
+		return;
+	}
+	mouseButtonActions[button] = action;
+}
+
+void InputManager::ClearBindings() {
+	std::fill(keyActions.begin(), keyActions.end(), -1);
+	std::fill(mouseButtonActions.begin(), mouseButtonActions.end(), -1);
+}
+
+void InputManager::PushEvent(const SDL_Event& sdlEvent) {
+	InputEvent event;
+	switch (sdlEvent.type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			// the repeats of a held key don't change any action
+			if (sdlEvent.key.repeat || sdlEvent.key.keysym.scancode < 0 || sdlEvent.key.keysym.scancode >= SDL_NUM_SCANCODES) {
+				return;
+			}
+			event.type = sdlEvent.type == SDL_KEYDOWN ? INPUT_KEY_DOWN : INPUT_KEY_UP;
+			event.code = sdlEvent.key.keysym.scancode;
+			event.mouseX = polledMousePosition.x;
+			event.mouseY = polledMousePosition.y;
+			break;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			if (sdlEvent.button.button >= MAX_MOUSE_BUTTONS) {
+				return;
+			}
+			event.type = sdlEvent.type == SDL_MOUSEBUTTONDOWN ? INPUT_MOUSE_DOWN : INPUT_MOUSE_UP;
+			event.code = sdlEvent.button.button;
+			event.mouseX = sdlEvent.button.x;
+			event.mouseY = sdlEvent.button.y;
+			polledMousePosition = glm::ivec2(event.mouseX, event.mouseY);
+			break;
+		case SDL_MOUSEMOTION:
+			event.type = INPUT_MOUSE_MOTION;
+			event.code = 0;
+			event.mouseX = sdlEvent.motion.x;
+			event.mouseY = sdlEvent.motion.y;
+			polledMousePosition = glm::ivec2(event.mouseX, event.mouseY);
+			break;
+		default:
+			return;
+	}
+
+	if (!events.Push(event)) {
+		// only the first drop is logged, a stuck consumer would flood the log
+		if (numDroppedEvents++ == 0) {
+			Logger::Err("The input event ring is full, the new events are dropped");
+		}
+	}
+}
+
+void InputManager::SetHeld(int action, bool isHeld, InputSnapshot& snapshot) {
+	if (action < 0) {
+		return;
+	}
+	const uint32_t bit = 1u << action;
+	if (isHeld) {
+		if (numInputsHeld[action]++ == 0) {
+			snapshot.actionsPressed |= bit;
+		}
+	}
+	else if (numInputsHeld[action] > 0 && --numInputsHeld[action] == 0) {
+		snapshot.actionsReleased |= bit;
+	}
+}
+
+InputSnapshot InputManager::BuildSnapshot(int tick) {
+	InputSnapshot snapshot(tick);
+
+	InputEvent event;
+	while (events.Pop(event)) {
+		switch (event.type) {
+			case INPUT_KEY_DOWN:
+			case INPUT_KEY_UP: {
+				const bool isDown = event.type == INPUT_KEY_DOWN;
+				if (isKeyHeld[event.code] != isDown) {
+					isKeyHeld[event.code] = isDown;
+					SetHeld(keyActions[event.code], isDown, snapshot);
+				}
+				break;
+			}
+			case INPUT_MOUSE_DOWN:
+			case INPUT_MOUSE_UP: {
+				const bool isDown = event.type == INPUT_MOUSE_DOWN;
+				if (isMouseButtonHeld[event.code] != isDown) {
+					isMouseButtonHeld[event.code] = isDown;
+					SetHeld(mouseButtonActions[event.code], isDown, snapshot);
+				}
+				break;
+			}
+			case INPUT_MOUSE_MOTION:
+				break;
+		}
+		mousePosition = glm::ivec2(event.mouseX, event.mouseY);
+	}
+
+	for (int action = 0; action < NUM_INPUT_ACTIONS; action++) {
+		if (numInputsHeld[action] > 0) {
+			snapshot.actionsDown |= 1u << action;
+		}
+	}
+	snapshot.mousePosition = mousePosition;
+	return snapshot;
+}
+
+int InputManager::GetNumDroppedEvents() const {
+	return numDroppedEvents;
+}
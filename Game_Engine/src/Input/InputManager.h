@@ -0,0 +1,118 @@
+#ifndef INPUTMANAGER_H
+#define INPUTMANAGER_H
+
+#include "../Utils/LockFreeQueue.h"
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Raw events kept between two ticks, a frame with more than this drops the rest
+const size_t INPUT_EVENT_CAPACITY = 1024;
+const int MAX_MOUSE_BUTTONS = 8;
+
+// Players whose input a tick can hold, only the first one is read from this machine's devices
+const int MAX_PLAYERS = 2;
+
+// What the simulation reacts to, the keys and buttons are bound to these
+enum InputAction {
+	ACTION_MOVE_UP,
+	ACTION_MOVE_DOWN,
+	ACTION_MOVE_LEFT,
+	ACTION_MOVE_RIGHT,
+	ACTION_FIRE,
+	NUM_INPUT_ACTIONS
+};
+static_assert(NUM_INPUT_ACTIONS <= 32, "The input snapshots store one bit per action");
+
+enum InputEventType : uint8_t {
+	INPUT_KEY_DOWN,
+	INPUT_KEY_UP,
+	INPUT_MOUSE_DOWN,
+	INPUT_MOUSE_UP,
+	INPUT_MOUSE_MOTION
+};
+
+// SDL event reduced to what the bindings need: a scancode or a mouse button, and the mouse position
+struct InputEvent {
+	InputEventType type;
+	int code;
+	int mouseX;
+	int mouseY;
+};
+
+/// <summary>
+/// State of the actions during one simulation tick. It is a plain value built once per tick,
+/// so the systems (and later other threads) read it without locks, and a tick can be replayed
+/// from it. An action that was pressed and released within the same tick is still seen as pressed.
+/// </summary>
+struct InputSnapshot {
+	int tick;
+	uint32_t actionsDown;
+	uint32_t actionsPressed;
+	uint32_t actionsReleased;
+	glm::ivec2 mousePosition;
+
+	InputSnapshot(int tick = 0) {
+		this->tick = tick;
+		this->actionsDown = 0;
+		this->actionsPressed = 0;
+		this->actionsReleased = 0;
+		this->mousePosition = glm::ivec2(0);
+	}
+
+	bool IsDown(InputAction action) const { return (actionsDown >> action) & 1; }
+	bool IsPressed(InputAction action) const { return (actionsPressed >> action) & 1; }
+	bool IsReleased(InputAction action) const { return (actionsReleased >> action) & 1; }
+
+	// Same action bits, whatever the tick. No system simulates the mouse, so a cursor that only
+	// moved doesn't make the rollback run the tick again.
+	bool HasSameActions(const InputSnapshot& other) const {
+		return actionsDown == other.actionsDown && actionsPressed == other.actionsPressed
+			&& actionsReleased == other.actionsReleased;
+	}
+};
+
+/// <summary>
+/// Input layer between SDL and the simulation. ProcessInput() pushes the SDL events to a lock-free
+/// ring as they are polled, and each tick drains it in order through the key bindings into an
+/// InputSnapshot. The events wait in the ring when a frame runs no tick, so none are lost.
+/// </summary>
+class InputManager {
+private:
+	LockFreeQueue<InputEvent, INPUT_EVENT_CAPACITY> events;
+	int numDroppedEvents;
+	// Last position seen by the polling loop, the key events carry it
+	glm::ivec2 polledMousePosition;
+
+	// [vector index = scancode / mouse button], the bound action or -1
+	std::vector<int> keyActions;
+	std::vector<int> mouseButtonActions;
+
+	// Only touched by the tick that builds the snapshots
+	std::vector<uint8_t> isKeyHeld;
+	std::vector<uint8_t> isMouseButtonHeld;
+	// Number of held keys and buttons per action, so two keys bound to one action don't fight
+	int numInputsHeld[NUM_INPUT_ACTIONS];
+	glm::ivec2 mousePosition;
+
+	void SetHeld(int action, bool isHeld, InputSnapshot& snapshot);
+
+public:
+	InputManager();
+
+	void BindKey(SDL_Scancode scancode, InputAction action);
+	void BindMouseButton(int button, InputAction action);
+	void ClearBindings();
+
+	// Called from the polling loop, ignores the events that no binding cares about
+	void PushEvent(const SDL_Event& sdlEvent);
+
+	// Drains the events received since the previous tick
+	InputSnapshot BuildSnapshot(int tick);
+
+	int GetNumDroppedEvents() const;
+};
+
+#endif // !INPUTMANAGER_H
@@ -0,0 +1,125 @@
+#include "JobSystem.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <string>
+
+JobSystem::JobSystem(int numWorkers) {
+	if (numWorkers < 0) {
+		numWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+	}
+
+	isRunning = true;
+	job = nullptr;
+	jobCount = 0;
+	jobBatchSize = 1;
+	jobNumBatches = 0;
+	jobGeneration = 0;
+	numBusyWorkers = 0;
+	nextBatch = 0;
+	numUnfinishedBatches = 0;
+
+	for (int i = 0; i < numWorkers; i++) {
+		workers.emplace_back(&JobSystem::Work, this, i);
+	}
+	Logger::Log("JobSystem started with " + std::to_string(numWorkers) + " workers");
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isRunning = false;
+	}
+	jobStarted.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+int JobSystem::GetNumThreads() const {
+	return static_cast<int>(workers.size()) + 1;
+}
+
+void JobSystem::RunBatches(const std::function<void(int, int)>* function, int count, int batchSize, int numBatches) {
+	int numFinished = 0;
+	for (int batch = nextBatch.fetch_add(1); batch < numBatches; batch = nextBatch.fetch_add(1)) {
+		const int first = batch * batchSize;
+		(*function)(first, std::min(first + batchSize, count));
+		numFinished++;
+	}
+
+	// the thread that finishes the last batch wakes the caller
+	if (numFinished > 0 && numUnfinishedBatches.fetch_sub(numFinished) == numFinished) {
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFinished.notify_all();
+	}
+}
+
+void JobSystem::Work(int workerIndex) {
+	Profiler::SetThreadName("Worker " + std::to_string(workerIndex));
+
+	int lastGeneration = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		jobStarted.wait(lock, [&]() { return !isRunning || jobGeneration != lastGeneration; });
+		if (!isRunning) {
+			return;
+		}
+		lastGeneration = jobGeneration;
+
+		// A worker that wakes up late can find a job that is already done, the counter
+		// is past the last batch then and RunBatches() returns without calling the job
+		const std::function<void(int, int)>* function = job;
+		const int count = jobCount;
+		const int batchSize = jobBatchSize;
+		const int numBatches = jobNumBatches;
+		numBusyWorkers++;
+		lock.unlock();
+
+		{
+			PROFILE_SCOPE("JobSystem::Work");
+			RunBatches(function, count, batchSize, numBatches);
+		}
+
+		lock.lock();
+		numBusyWorkers--;
+		if (numBusyWorkers == 0) {
+			jobFinished.notify_all();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(int count, int batchSize, const std::function<void(int first, int last)>& function) {
+	if (count <= 0) {
+		return;
+	}
+	batchSize = std::max(batchSize, 1);
+	const int numBatches = (count + batchSize - 1) / batchSize;
+
+	// Not worth waking the workers
+	if (workers.empty() || numBatches == 1) {
+		function(0, count);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		jobFinished.wait(lock, [&]() { return numBusyWorkers == 0; });
+
+		job = &function;
+		jobCount = count;
+		jobBatchSize = batchSize;
+		jobNumBatches = numBatches;
+		nextBatch = 0;
+		numUnfinishedBatches = numBatches;
+		jobGeneration++;
+	}
+	jobStarted.notify_all();
+
+	// The calling thread takes batches too instead of waiting
+	RunBatches(&function, count, batchSize, numBatches);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobFinished.wait(lock, [&]() { return numUnfinishedBatches.load() == 0; });
+	job = nullptr;
+}
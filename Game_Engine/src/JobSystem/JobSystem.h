@@ -0,0 +1,52 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// A pool of worker threads that splits loops over many entities in batches. The workers and
+/// the calling thread take the batches from a shared counter, so a slow batch never leaves the
+/// others idle. ParallelFor() returns once every batch is done, so the systems keep running in
+/// the same order as before; it must be called by one thread at a time, and not from a job.
+/// </summary>
+class JobSystem {
+private:
+	std::vector<std::thread> workers;
+	bool isRunning;
+
+	// The loop being run, only changed while no worker is inside RunBatches()
+	const std::function<void(int, int)>* job;
+	int jobCount;
+	int jobBatchSize;
+	int jobNumBatches;
+	int jobGeneration;
+	int numBusyWorkers;
+
+	std::atomic<int> nextBatch;
+	std::atomic<int> numUnfinishedBatches;
+
+	std::mutex mutex;
+	std::condition_variable jobStarted;
+	std::condition_variable jobFinished;
+
+	void Work(int workerIndex);
+	void RunBatches(const std::function<void(int, int)>* function, int count, int batchSize, int numBatches);
+
+public:
+	// By default, one worker per core besides the one of the calling thread
+	JobSystem(int numWorkers = -1);
+	~JobSystem();
+
+	// Workers plus the calling thread
+	int GetNumThreads() const;
+
+	// Calls function(first, last) for consecutive ranges of at most batchSize indices covering [0, count)
+	void ParallelFor(int count, int batchSize, const std::function<void(int first, int last)>& function);
+};
+
+#endif // !JOBSYSTEM_H
@@ -4,9 +4,13 @@
 #include <string>
 #include <chrono>
 #include <ctime>
+#include <mutex>
 
 std::vector<LogEntry> Logger::messages;
 
+// Background threads (e.g. the asset watcher) can log at the same time as the game loop
+static std::mutex loggerMutex;
+
 std::string CurrentDateTimeToString() {
 	std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 	std::string output(30, '\0');
@@ -18,6 +22,7 @@ void Logger::Log(const std::string& message) {
 	LogEntry logEntry;
 	logEntry.type = LOG_INFO;
 	logEntry.message = "LOG: [" + CurrentDateTimeToString() + "]: " + message;
+	std::lock_guard<std::mutex> lock(loggerMutex);
 	std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
 	messages.push_back(logEntry);
 
@@ -27,6 +32,7 @@ void Logger::Err(const std::string& message) {
 	LogEntry logEntry;
 	logEntry.type = LOG_ERROR;
 	logEntry.message = "Err: [" + CurrentDateTimeToString() + "]: " + message;
+	std::lock_guard<std::mutex> lock(loggerMutex);
 	std::cerr << "\x1B[91m" << logEntry.message << "\033[0m" << std::endl;
 	messages.push_back(logEntry);
 
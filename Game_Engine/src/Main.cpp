@@ -1,12 +1,182 @@
 #include "./Game/Game.h"
+#include "./Benchmarks/Benchmarks.h"
+#include "./Logger/Logger.h"
+#include <cstdlib>
+#include <string>
 
-
+// Game_Engine.exe --record <file> saves the inputs of the session,
+// Game_Engine.exe --replay <file> [--from <tick>] runs a recorded session without a window, as fast as possible,
+// Game_Engine.exe --rollback-test <ticks> [--latency <ms>] [--jitter <ms>] runs two peers of a rollback session without a window,
+// Game_Engine.exe --replication-test <ticks> [--clients <count>] [--loss <ratio>] replicates the world to clients over localhost UDP,
+// Game_Engine.exe --audio-stress <effects> plays effects from several threads until the voices are stolen,
+// Game_Engine.exe --broadphase-bench <boxes> measures the pairs found per second by each broadphase,
+// Game_Engine.exe --narrowphase-bench <shapes> measures the exact tests per second of the narrowphase,
+// Game_Engine.exe --ccd-bench <bodies> measures the collision pass with 1% and 10% of fast movers,
+// Game_Engine.exe --reorder-bench <entities> measures the collision and culled render passes before and after the Morton reorder,
+// Game_Engine.exe --flocking-bench <agents> measures the time of a flocking tick,
+// Game_Engine.exe --pathfinding-bench <queries> measures the hierarchical path queries on a 2048x2048 map,
+// Game_Engine.exe --event-bench <events> measures the events emitted and dispatched per frame,
+// Game_Engine.exe --snapshot-bench <entities> measures the save and the restore of a registry snapshot,
+// and --broadphase <hash|sap> picks the broadphase of the collisions in any mode
 int main(int argc, char* argv[]) { // Used if parameters are sent from the operating system to the program
+	std::string recordPath;
+	std::string replayPath;
+	int replayFromTick = 0;
+	int rollbackTestTicks = 0;
+	int latencyMilliseconds = 100;
+	int jitterMilliseconds = 30;
+	int replicationTestTicks = 0;
+	int numClients = 4;
+	float packetLossRate = 0.05f;
+	int audioStressEffects = 0;
+	int broadphaseBenchBoxes = 0;
+	int narrowphaseBenchShapes = 0;
+	int ccdBenchBodies = 0;
+	int reorderBenchEntities = 0;
+	int flockingBenchAgents = 0;
+	int pathfindingBenchQueries = 0;
+	int eventBenchEvents = 0;
+	int snapshotBenchEntities = 0;
+	BroadphaseType broadphaseType = BROADPHASE_SWEEP_AND_PRUNE;
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--record" && i + 1 < argc) {
+			recordPath = argv[++i];
+		}
+		else if (argument == "--replay" && i + 1 < argc) {
+			replayPath = argv[++i];
+		}
+		else if (argument == "--from" && i + 1 < argc) {
+			replayFromTick = std::atoi(argv[++i]);
+		}
+		else if (argument == "--rollback-test" && i + 1 < argc) {
+			rollbackTestTicks = std::atoi(argv[++i]);
+		}
+		else if (argument == "--latency" && i + 1 < argc) {
+			latencyMilliseconds = std::atoi(argv[++i]);
+		}
+		else if (argument == "--jitter" && i + 1 < argc) {
+			jitterMilliseconds = std::atoi(argv[++i]);
+		}
+		else if (argument == "--replication-test" && i + 1 < argc) {
+			replicationTestTicks = std::atoi(argv[++i]);
+		}
+		else if (argument == "--clients" && i + 1 < argc) {
+			numClients = std::atoi(argv[++i]);
+		}
+		else if (argument == "--loss" && i + 1 < argc) {
+			packetLossRate = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (argument == "--audio-stress" && i + 1 < argc) {
+			audioStressEffects = std::atoi(argv[++i]);
+		}
+		else if (argument == "--broadphase-bench" && i + 1 < argc) {
+			broadphaseBenchBoxes = std::atoi(argv[++i]);
+		}
+		else if (argument == "--narrowphase-bench" && i + 1 < argc) {
+			narrowphaseBenchShapes = std::atoi(argv[++i]);
+		}
+		else if (argument == "--ccd-bench" && i + 1 < argc) {
+			ccdBenchBodies = std::atoi(argv[++i]);
+		}
+		else if (argument == "--reorder-bench" && i + 1 < argc) {
+			reorderBenchEntities = std::atoi(argv[++i]);
+		}
+		else if (argument == "--flocking-bench" && i + 1 < argc) {
+			flockingBenchAgents = std::atoi(argv[++i]);
+		}
+		else if (argument == "--pathfinding-bench" && i + 1 < argc) {
+			pathfindingBenchQueries = std::atoi(argv[++i]);
+		}
+		else if (argument == "--event-bench" && i + 1 < argc) {
+			eventBenchEvents = std::atoi(argv[++i]);
+		}
+		else if (argument == "--snapshot-bench" && i + 1 < argc) {
+			snapshotBenchEntities = std::atoi(argv[++i]);
+		}
+		else if (argument == "--broadphase" && i + 1 < argc) {
+			const std::string broadphaseName = argv[++i];
+			if (broadphaseName == "hash") {
+				broadphaseType = BROADPHASE_SPATIAL_HASH;
+			}
+			else if (broadphaseName == "sap") {
+				broadphaseType = BROADPHASE_SWEEP_AND_PRUNE;
+			}
+			else {
+				Logger::Err("Unknown broadphase " + broadphaseName + ", the broadphases are hash and sap");
+			}
+		}
+		else {
+			Logger::Err("Unknown argument " + argument);
+		}
+	}
+
+	if (audioStressEffects > 0) {
+		return RunAudioStressTest(audioStressEffects) ? 0 : 1;
+	}
+
+	if (broadphaseBenchBoxes > 0) {
+		return RunBroadphaseBenchmark(broadphaseBenchBoxes) ? 0 : 1;
+	}
+
+	if (narrowphaseBenchShapes > 0) {
+		return RunNarrowphaseBenchmark(narrowphaseBenchShapes) ? 0 : 1;
+	}
+
+	if (ccdBenchBodies > 0) {
+		return RunContinuousCollisionBenchmark(ccdBenchBodies) ? 0 : 1;
+	}
+
+	if (reorderBenchEntities > 0) {
+		return RunReorderBenchmark(reorderBenchEntities) ? 0 : 1;
+	}
+
+	if (flockingBenchAgents > 0) {
+		return RunFlockingBenchmark(flockingBenchAgents) ? 0 : 1;
+	}
+
+	if (pathfindingBenchQueries > 0) {
+		return RunPathfindingBenchmark(pathfindingBenchQueries) ? 0 : 1;
+	}
+
+	if (eventBenchEvents > 0) {
+		return RunEventBenchmark(eventBenchEvents) ? 0 : 1;
+	}
+
+	if (snapshotBenchEntities > 0) {
+		return RunSnapshotBenchmark(snapshotBenchEntities) ? 0 : 1;
+	}
+
 	Game game;
+	game.SetBroadphase(broadphaseType);
+
+	if (rollbackTestTicks > 0) {
+		game.Start(true);
+		const bool isInSync = game.RollbackLoopback(rollbackTestTicks, latencyMilliseconds, jitterMilliseconds);
+		game.Stop();
+		return isInSync ? 0 : 1;
+	}
+
+	if (replicationTestTicks > 0 && numClients > 0) {
+		game.Start(true);
+		const bool isInSync = game.ReplicationLoopback(replicationTestTicks, numClients, packetLossRate);
+		game.Stop();
+		return isInSync ? 0 : 1;
+	}
+
+	if (!replayPath.empty()) {
+		game.Start(true);
+		const bool isReplayed = game.Replay(replayPath, replayFromTick);
+		game.Stop();
+		return isReplayed ? 0 : 1;
+	}
 
 	game.Start();
+	if (!recordPath.empty()) {
+		game.Record(recordPath);
+	}
 	game.Run();
 	game.Stop();
 
 	return 0;
-}
\ No newline at end of file
+}
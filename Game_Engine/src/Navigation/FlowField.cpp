@@ -0,0 +1,27 @@
+#include "FlowField.h"
+#include "NavGrid.h"
+#include <cfloat>
+#include <cmath>
+
+static int GetFlowFieldCell(const FlowField& flowField, const glm::vec2& position) {
+	const int col = static_cast<int>(std::floor(position.x / flowField.cellSize));
+	const int row = static_cast<int>(std::floor(position.y / flowField.cellSize));
+	if (col < 0 || row < 0 || col >= flowField.numCols || row >= flowField.numRows) {
+		return -1;
+	}
+	return row * flowField.numCols + col;
+}
+
+bool FlowField::IsReachable(const glm::vec2& position) const {
+	const int cell = GetFlowFieldCell(*this, position);
+	return cell >= 0 && distances[cell] < FLT_MAX;
+}
+
+glm::vec2 FlowField::GetDirection(const glm::vec2& position) const {
+	const int cell = GetFlowFieldCell(*this, position);
+	if (cell < 0 || directions[cell] < 0) {
+		return glm::vec2(0.0f);
+	}
+	const int direction = directions[cell];
+	return glm::normalize(glm::vec2(NAV_DIRECTIONS_X[direction], NAV_DIRECTIONS_Y[direction]));
+}
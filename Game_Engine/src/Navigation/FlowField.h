@@ -0,0 +1,31 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Directions towards one goal from every cell of a NavGrid, shared by all the units heading
+/// there: each unit reads the direction of its cell instead of searching its own path.
+/// </summary>
+struct FlowField {
+	glm::ivec2 goal;
+	// NavGrid version the field was computed from
+	int version;
+	int numCols;
+	int numRows;
+	float cellSize;
+
+	// [vector index = row * numCols + col], cost to reach the goal, FLT_MAX when it can't be reached
+	std::vector<float> distances;
+	// [vector index = row * numCols + col], index in NAV_DIRECTIONS, -1 at the goal and where it can't be reached
+	std::vector<int8_t> directions;
+
+	bool IsReachable(const glm::vec2& position) const;
+
+	// Normalized direction to follow from the cell under the position, zero at the goal or when it can't be reached
+	glm::vec2 GetDirection(const glm::vec2& position) const;
+};
+
+#endif // !FLOWFIELD_H
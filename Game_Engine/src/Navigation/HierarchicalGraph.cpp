@@ -0,0 +1,456 @@
+#include "HierarchicalGraph.h"
+#include "../Profiler/Profiler.h"
+#include <SDL.h>
+#include <algorithm>
+#include <cfloat>
+
+ClusterSearch::ClusterSearch() {
+	grid = nullptr;
+	gridVersion = -1;
+	bounds = { 0, 0, -1, -1 };
+	paddedWidth = 0;
+	searchNumber = 0;
+}
+
+void ClusterSearch::LoadCluster(const NavGrid& grid, const ClusterBounds& bounds) {
+	// the nodes of a cluster are searched one after the other, the costs are only copied once
+	if (this->grid == &grid && gridVersion == grid.GetVersion() && this->bounds.minCol == bounds.minCol && this->bounds.minRow == bounds.minRow &&
+		this->bounds.maxCol == bounds.maxCol && this->bounds.maxRow == bounds.maxRow) {
+		return;
+	}
+	this->grid = &grid;
+	gridVersion = grid.GetVersion();
+	this->bounds = bounds;
+
+	paddedWidth = bounds.maxCol - bounds.minCol + 3;
+	const int paddedHeight = bounds.maxRow - bounds.minRow + 3;
+	localCosts.assign(paddedWidth * paddedHeight, NAV_BLOCKED);
+	for (int row = bounds.minRow; row <= bounds.maxRow; row++) {
+		for (int col = bounds.minCol; col <= bounds.maxCol; col++) {
+			localCosts[GetLocalCell(col, row)] = grid.GetCost(col, row);
+		}
+	}
+	for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+		neighbourOffsets[direction] = NAV_DIRECTIONS_Y[direction] * paddedWidth + NAV_DIRECTIONS_X[direction];
+	}
+
+	const size_t numCells = localCosts.size();
+	if (costsSoFar.size() < numCells) {
+		costsSoFar.resize(numCells);
+		parents.resize(numCells);
+		openedSearch.assign(numCells, 0);
+		closedSearch.assign(numCells, 0);
+		targetSearch.assign(numCells, 0);
+		searchNumber = 0;
+	}
+}
+
+void ClusterSearch::Search(const NavGrid& grid, const ClusterBounds& bounds, glm::ivec2 source, bool isReversed, glm::ivec2 goal, const int* targetCells, int numTargets) {
+	LoadCluster(grid, bounds);
+	if (++searchNumber == 0) {
+		std::fill(openedSearch.begin(), openedSearch.end(), 0);
+		std::fill(closedSearch.begin(), closedSearch.end(), 0);
+		std::fill(targetSearch.begin(), targetSearch.end(), 0);
+		searchNumber = 1;
+	}
+	openNodes.clear();
+
+	if (!bounds.Contains(source.x, source.y) || localCosts[GetLocalCell(source.x, source.y)] == NAV_BLOCKED) {
+		return;
+	}
+
+	auto isFarther = [](const OpenNode& a, const OpenNode& b) {
+		return a.estimatedCost > b.estimatedCost || (a.estimatedCost == b.estimatedCost && a.cell > b.cell);
+	};
+	const bool hasGoal = bounds.Contains(goal.x, goal.y);
+	const int goalCell = hasGoal ? GetLocalCell(goal.x, goal.y) : -1;
+	const float minCost = grid.GetMinCost();
+	auto open = [&](int cell, float costSoFar, int parent) {
+		if (closedSearch[cell] == searchNumber || (openedSearch[cell] == searchNumber && costsSoFar[cell] <= costSoFar)) {
+			return;
+		}
+		openedSearch[cell] = searchNumber;
+		costsSoFar[cell] = costSoFar;
+		parents[cell] = parent;
+		float heuristic = 0.0f;
+		if (hasGoal) {
+			heuristic = GetOctileDistance(goalCell % paddedWidth - cell % paddedWidth, goalCell / paddedWidth - cell / paddedWidth) * minCost;
+		}
+		openNodes.push_back({ costSoFar + heuristic, costSoFar, cell });
+		std::push_heap(openNodes.begin(), openNodes.end(), isFarther);
+	};
+
+	int numTargetsLeft = 0;
+	for (int i = 0; i < numTargets; i++) {
+		const int col = targetCells[i] % grid.GetNumCols();
+		const int row = targetCells[i] / grid.GetNumCols();
+		if (bounds.Contains(col, row)) {
+			const int cell = GetLocalCell(col, row);
+			if (localCosts[cell] != NAV_BLOCKED && targetSearch[cell] != searchNumber) {
+				targetSearch[cell] = searchNumber;
+				numTargetsLeft++;
+			}
+		}
+	}
+	const int sourceCell = GetLocalCell(source.x, source.y);
+
+	open(sourceCell, 0.0f, -1);
+	while (!openNodes.empty()) {
+		std::pop_heap(openNodes.begin(), openNodes.end(), isFarther);
+		const OpenNode node = openNodes.back();
+		openNodes.pop_back();
+		if (closedSearch[node.cell] == searchNumber) {
+			continue;
+		}
+		closedSearch[node.cell] = searchNumber;
+
+		if (node.cell == goalCell) {
+			return;
+		}
+		if (targetSearch[node.cell] == searchNumber && --numTargetsLeft == 0) {
+			return;
+		}
+
+		const uint8_t leftCost = localCosts[node.cell];
+		for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+			const int neighbour = node.cell + neighbourOffsets[direction];
+			const uint8_t enteredCost = localCosts[neighbour];
+			if (enteredCost == NAV_BLOCKED) {
+				continue;
+			}
+			// no corner cutting, the directions after the 4th are diagonal
+			const bool isDiagonal = direction >= 4;
+			if (isDiagonal && (localCosts[node.cell + NAV_DIRECTIONS_X[direction]] == NAV_BLOCKED || localCosts[node.cell + NAV_DIRECTIONS_Y[direction] * paddedWidth] == NAV_BLOCKED)) {
+				continue;
+			}
+			// a reversed search walks the moves backwards, so it pays for the cell it leaves
+			const uint8_t cost = isReversed ? leftCost : enteredCost;
+			open(neighbour, node.costSoFar + (isDiagonal ? NAV_DIAGONAL_LENGTH : 1.0f) * cost, node.cell);
+		}
+	}
+}
+
+float ClusterSearch::GetCostTo(int col, int row) const {
+	if (!bounds.Contains(col, row)) {
+		return FLT_MAX;
+	}
+	const int cell = GetLocalCell(col, row);
+	return closedSearch[cell] == searchNumber ? costsSoFar[cell] : FLT_MAX;
+}
+
+void ClusterSearch::AppendPath(int col, int row, std::vector<glm::ivec2>& cells) const {
+	const size_t first = cells.size();
+	for (int cell = GetLocalCell(col, row); parents[cell] >= 0; cell = parents[cell]) {
+		cells.emplace_back(bounds.minCol + cell % paddedWidth - 1, bounds.minRow + cell / paddedWidth - 1);
+	}
+	std::reverse(cells.begin() + first, cells.end());
+}
+
+HierarchicalGraph::HierarchicalGraph(int clusterSize) {
+	this->clusterSize = std::max(clusterSize, 2);
+	numCols = 0;
+	numRows = 0;
+	numClustersX = 0;
+	numClustersY = 0;
+}
+
+ClusterBounds HierarchicalGraph::GetClusterBounds(int cluster) const {
+	const int minCol = (cluster % numClustersX) * clusterSize;
+	const int minRow = (cluster / numClustersX) * clusterSize;
+	return { minCol, minRow, std::min(minCol + clusterSize, numCols) - 1, std::min(minRow + clusterSize, numRows) - 1 };
+}
+
+void HierarchicalGraph::Build(const NavGrid& grid, JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	numCols = grid.GetNumCols();
+	numRows = grid.GetNumRows();
+	numClustersX = (numCols + clusterSize - 1) / clusterSize;
+	numClustersY = (numRows + clusterSize - 1) / clusterSize;
+	const int numClusters = numClustersX * numClustersY;
+
+	nodes.clear();
+	freeNodes.clear();
+	nodeOfCell.clear();
+	clusterNodes.assign(numClusters, {});
+	verticalBorders.assign(numClusters, {});
+	horizontalBorders.assign(numClusters, {});
+	dirtyClusters.clear();
+	isClusterDirty.assign(numClusters, 0);
+
+	std::vector<int> clusters(numClusters);
+	for (int cluster = 0; cluster < numClusters; cluster++) {
+		clusters[cluster] = cluster;
+	}
+	RebuildClusters(grid, clusters, jobSystem);
+}
+
+void HierarchicalGraph::OnCellChanged(int col, int row) {
+	if (col < 0 || row < 0 || col >= numCols || row >= numRows) {
+		return;
+	}
+	const int cluster = GetClusterIndex(col, row);
+	if (!isClusterDirty[cluster]) {
+		isClusterDirty[cluster] = 1;
+		dirtyClusters.push_back(cluster);
+	}
+}
+
+void HierarchicalGraph::Update(const NavGrid& grid, JobSystem* jobSystem, double maxMilliseconds) {
+	if (dirtyClusters.empty()) {
+		return;
+	}
+
+	PROFILE_FUNCTION();
+
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	const double millisecsPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+
+	// One cluster per thread at a time, at least one batch per call
+	const size_t batchSize = jobSystem ? jobSystem->GetNumThreads() : 1;
+	std::vector<int> batch;
+	size_t numRebuilt = 0;
+	while (numRebuilt < dirtyClusters.size()) {
+		const size_t last = std::min(numRebuilt + batchSize, dirtyClusters.size());
+		batch.assign(dirtyClusters.begin() + numRebuilt, dirtyClusters.begin() + last);
+		RebuildClusters(grid, batch, jobSystem);
+		for (int cluster : batch) {
+			isClusterDirty[cluster] = 0;
+		}
+		numRebuilt = last;
+
+		if ((SDL_GetPerformanceCounter() - startCounter) * millisecsPerCount >= maxMilliseconds) {
+			break;
+		}
+	}
+	dirtyClusters.erase(dirtyClusters.begin(), dirtyClusters.begin() + numRebuilt);
+}
+
+void HierarchicalGraph::FindTransitions(const NavGrid& grid, int cluster, bool isVertical, std::vector<Transition>& transitions) const {
+	transitions.clear();
+
+	// Walk along the border, cellA is the last column / row of the cluster and cellB the first of the next one
+	const ClusterBounds bounds = GetClusterBounds(cluster);
+	const int length = isVertical ? bounds.maxRow - bounds.minRow + 1 : bounds.maxCol - bounds.minCol + 1;
+	auto getCells = [&](int i, glm::ivec2& cellA, glm::ivec2& cellB) {
+		cellA = isVertical ? glm::ivec2(bounds.maxCol, bounds.minRow + i) : glm::ivec2(bounds.minCol + i, bounds.maxRow);
+		cellB = isVertical ? cellA + glm::ivec2(1, 0) : cellA + glm::ivec2(0, 1);
+	};
+	auto addTransition = [&](int i) {
+		glm::ivec2 cellA, cellB;
+		getCells(i, cellA, cellB);
+		transitions.push_back({ grid.GetCellIndex(cellA.x, cellA.y), grid.GetCellIndex(cellB.x, cellB.y) });
+	};
+
+	int runStart = -1;
+	for (int i = 0; i <= length; i++) {
+		bool isOpen = false;
+		if (i < length) {
+			glm::ivec2 cellA, cellB;
+			getCells(i, cellA, cellB);
+			isOpen = grid.IsWalkable(cellA.x, cellA.y) && grid.IsWalkable(cellB.x, cellB.y);
+		}
+
+		if (isOpen && runStart < 0) {
+			runStart = i;
+		}
+		else if (!isOpen && runStart >= 0) {
+			const int runEnd = i - 1;
+			if (runEnd - runStart + 1 >= MIN_DOUBLE_ENTRANCE_WIDTH) {
+				addTransition(runStart);
+				addTransition(runEnd);
+			}
+			else {
+				addTransition((runStart + runEnd) / 2);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+int HierarchicalGraph::GetOrCreateNode(int cell, int cluster) {
+	auto existingNode = nodeOfCell.find(cell);
+	if (existingNode != nodeOfCell.end()) {
+		return existingNode->second;
+	}
+
+	int node;
+	if (!freeNodes.empty()) {
+		node = freeNodes.back();
+		freeNodes.pop_back();
+	}
+	else {
+		node = static_cast<int>(nodes.size());
+		nodes.emplace_back();
+	}
+	nodes[node].cell = cell;
+	nodes[node].cluster = cluster;
+	nodes[node].intraEdges.clear();
+	nodes[node].interEdges.clear();
+	nodeOfCell[cell] = node;
+	return node;
+}
+
+void HierarchicalGraph::FreeNode(int node) {
+	nodeOfCell.erase(nodes[node].cell);
+	nodes[node].cell = -1;
+	nodes[node].intraEdges.clear();
+	nodes[node].interEdges.clear();
+	freeNodes.push_back(node);
+}
+
+void HierarchicalGraph::RemoveInterEdge(int node, int targetNode) {
+	auto& edges = nodes[node].interEdges;
+	edges.erase(std::remove_if(edges.begin(), edges.end(), [&](const HierarchicalEdge& edge) { return edge.targetNode == targetNode; }), edges.end());
+}
+
+void HierarchicalGraph::UpdateIntraEdges(const NavGrid& grid, int cluster, ClusterSearch& search) {
+	const ClusterBounds bounds = GetClusterBounds(cluster);
+	const std::vector<int>& nodesOfCluster = clusterNodes[cluster];
+
+	std::vector<int> nodeCells;
+	for (int node : nodesOfCluster) {
+		nodeCells.push_back(nodes[node].cell);
+	}
+
+	for (int node : nodesOfCluster) {
+		const int cell = nodes[node].cell;
+		search.Search(grid, bounds, glm::ivec2(cell % numCols, cell / numCols), false, glm::ivec2(-1), nodeCells.data(), static_cast<int>(nodeCells.size()));
+
+		auto& edges = nodes[node].intraEdges;
+		edges.clear();
+		for (int targetNode : nodesOfCluster) {
+			const int targetCell = nodes[targetNode].cell;
+			const float cost = search.GetCostTo(targetCell % numCols, targetCell / numCols);
+			if (targetNode != node && cost < FLT_MAX) {
+				edges.push_back({ targetNode, cost });
+			}
+		}
+	}
+}
+
+void HierarchicalGraph::RebuildClusters(const NavGrid& grid, const std::vector<int>& clusters, JobSystem* jobSystem) {
+	const int numClusters = numClustersX * numClustersY;
+
+	// The borders of the rebuilt clusters, [vector index = cluster] of their left or top side
+	std::vector<uint8_t> isVerticalBorderChanged(numClusters, 0);
+	std::vector<uint8_t> isHorizontalBorderChanged(numClusters, 0);
+	std::vector<uint8_t> isClusterAffected(numClusters, 0);
+	std::vector<int> affectedClusters;
+	auto markAffected = [&](int cluster) {
+		if (!isClusterAffected[cluster]) {
+			isClusterAffected[cluster] = 1;
+			affectedClusters.push_back(cluster);
+		}
+	};
+
+	std::vector<int> changedVerticalBorders;
+	std::vector<int> changedHorizontalBorders;
+	for (int cluster : clusters) {
+		const int clusterX = cluster % numClustersX;
+		const int clusterY = cluster / numClustersX;
+		const int leftBorders[2] = { clusterX > 0 ? cluster - 1 : -1, clusterX < numClustersX - 1 ? cluster : -1 };
+		const int topBorders[2] = { clusterY > 0 ? cluster - numClustersX : -1, clusterY < numClustersY - 1 ? cluster : -1 };
+		for (int border : leftBorders) {
+			if (border >= 0 && !isVerticalBorderChanged[border]) {
+				isVerticalBorderChanged[border] = 1;
+				changedVerticalBorders.push_back(border);
+				markAffected(border);
+				markAffected(border + 1);
+			}
+		}
+		for (int border : topBorders) {
+			if (border >= 0 && !isHorizontalBorderChanged[border]) {
+				isHorizontalBorderChanged[border] = 1;
+				changedHorizontalBorders.push_back(border);
+				markAffected(border);
+				markAffected(border + numClustersX);
+			}
+		}
+		markAffected(cluster);
+	}
+
+	// Unlink the old transitions of the borders, then find the new ones
+	auto replaceTransitions = [&](int border, bool isVertical) {
+		auto& transitions = isVertical ? verticalBorders[border] : horizontalBorders[border];
+		for (const auto& transition : transitions) {
+			const int nodeA = nodeOfCell[transition.cellA];
+			const int nodeB = nodeOfCell[transition.cellB];
+			RemoveInterEdge(nodeA, nodeB);
+			RemoveInterEdge(nodeB, nodeA);
+		}
+		FindTransitions(grid, border, isVertical, transitions);
+	};
+	for (int border : changedVerticalBorders) {
+		replaceTransitions(border, true);
+	}
+	for (int border : changedHorizontalBorders) {
+		replaceTransitions(border, false);
+	}
+
+	// The nodes of a cluster are the cells of the transitions on its four borders
+	std::vector<int> cells;
+	for (int cluster : affectedClusters) {
+		const int clusterX = cluster % numClustersX;
+		const int clusterY = cluster / numClustersX;
+		cells.clear();
+		for (const auto& transition : verticalBorders[cluster]) {
+			cells.push_back(transition.cellA);
+		}
+		for (const auto& transition : horizontalBorders[cluster]) {
+			cells.push_back(transition.cellA);
+		}
+		if (clusterX > 0) {
+			for (const auto& transition : verticalBorders[cluster - 1]) {
+				cells.push_back(transition.cellB);
+			}
+		}
+		if (clusterY > 0) {
+			for (const auto& transition : horizontalBorders[cluster - numClustersX]) {
+				cells.push_back(transition.cellB);
+			}
+		}
+		std::sort(cells.begin(), cells.end());
+		cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+		for (int node : clusterNodes[cluster]) {
+			if (!std::binary_search(cells.begin(), cells.end(), nodes[node].cell)) {
+				FreeNode(node);
+			}
+		}
+		clusterNodes[cluster].clear();
+		for (int cell : cells) {
+			clusterNodes[cluster].push_back(GetOrCreateNode(cell, cluster));
+		}
+	}
+
+	// Crossing a border is one straight move, that pays for the cell it enters
+	auto linkTransitions = [&](const std::vector<Transition>& transitions) {
+		for (const auto& transition : transitions) {
+			const int nodeA = nodeOfCell[transition.cellA];
+			const int nodeB = nodeOfCell[transition.cellB];
+			nodes[nodeA].interEdges.push_back({ nodeB, static_cast<float>(grid.GetCost(transition.cellB % numCols, transition.cellB / numCols)) });
+			nodes[nodeB].interEdges.push_back({ nodeA, static_cast<float>(grid.GetCost(transition.cellA % numCols, transition.cellA / numCols)) });
+		}
+	};
+	for (int border : changedVerticalBorders) {
+		linkTransitions(verticalBorders[border]);
+	}
+	for (int border : changedHorizontalBorders) {
+		linkTransitions(horizontalBorders[border]);
+	}
+
+	// The paths inside the clusters are the expensive part, every cluster only writes the edges of its own nodes
+	auto updateClusters = [&](int first, int last) {
+		thread_local ClusterSearch search;
+		for (int i = first; i < last; i++) {
+			UpdateIntraEdges(grid, affectedClusters[i], search);
+		}
+	};
+	if (jobSystem) {
+		jobSystem->ParallelFor(static_cast<int>(affectedClusters.size()), 16, updateClusters);
+	}
+	else {
+		updateClusters(0, static_cast<int>(affectedClusters.size()));
+	}
+}
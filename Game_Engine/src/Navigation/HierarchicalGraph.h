@@ -0,0 +1,162 @@
+#ifndef HIERARCHICALGRAPH_H
+#define HIERARCHICALGRAPH_H
+
+#include "NavGrid.h"
+#include "../JobSystem/JobSystem.h"
+#include <cfloat>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+const int DEFAULT_CLUSTER_SIZE = 32;
+
+// An opening between two clusters this wide or wider gets a transition at both ends, a narrower one in its middle
+const int MIN_DOUBLE_ENTRANCE_WIDTH = 6;
+
+struct ClusterBounds {
+	int minCol, minRow;
+	// Inclusive
+	int maxCol, maxRow;
+
+	bool Contains(int col, int row) const { return col >= minCol && row >= minRow && col <= maxCol && row <= maxRow; }
+};
+
+struct HierarchicalEdge {
+	int targetNode;
+	float cost;
+};
+
+/// <summary>
+/// A cell on the border of a cluster where paths cross to the next cluster
+/// </summary>
+struct HierarchicalNode {
+	// -1 when the slot is free
+	int cell;
+	int cluster;
+	// Paths to the other nodes of the cluster, that stay inside it
+	std::vector<HierarchicalEdge> intraEdges;
+	// One straight move to the node on the other side of the border
+	std::vector<HierarchicalEdge> interEdges;
+};
+
+/// <summary>
+/// Scratch memory of a search restricted to one cluster, Dijkstra from a cell or A* to a goal.
+/// The costs of the cluster are copied with a blocked border around them, so the moves need no
+/// bounds checks; the cells beside a diagonal move are always inside the cluster with it.
+/// </summary>
+class ClusterSearch {
+private:
+	struct OpenNode {
+		float estimatedCost;
+		float costSoFar;
+		int cell;
+	};
+
+	// Cluster whose costs are in localCosts
+	const NavGrid* grid;
+	int gridVersion;
+	ClusterBounds bounds;
+	int paddedWidth;
+
+	// [vector index = local cell], the cluster plus one blocked cell on every side
+	std::vector<uint8_t> localCosts;
+	int neighbourOffsets[NAV_NUM_DIRECTIONS];
+
+	// [vector index = local cell], only valid where openedSearch / closedSearch equals searchNumber
+	std::vector<float> costsSoFar;
+	std::vector<int> parents;
+	std::vector<uint32_t> openedSearch;
+	std::vector<uint32_t> closedSearch;
+	std::vector<uint32_t> targetSearch;
+	uint32_t searchNumber;
+	std::vector<OpenNode> openNodes;
+
+	int GetLocalCell(int col, int row) const { return (row - bounds.minRow + 1) * paddedWidth + (col - bounds.minCol + 1); }
+	void LoadCluster(const NavGrid& grid, const ClusterBounds& bounds);
+
+public:
+	ClusterSearch();
+
+	// Searches the cheapest paths from the source, or to it when isReversed. With a goal the search
+	// stops as soon as it is reached, and only the way to the goal is complete. With target cells
+	// it stops once all of them are reached.
+	void Search(const NavGrid& grid, const ClusterBounds& bounds, glm::ivec2 source, bool isReversed, glm::ivec2 goal = glm::ivec2(-1),
+		const int* targetCells = nullptr, int numTargets = 0);
+
+	// FLT_MAX when the cell wasn't reached
+	float GetCostTo(int col, int row) const;
+	// Appends the cells after the source up to (col, row), for a search that isn't reversed
+	void AppendPath(int col, int row, std::vector<glm::ivec2>& cells) const;
+};
+
+/// <summary>
+/// Abstraction of a NavGrid for paths across large maps (HPA*). The grid is cut in square
+/// clusters, and the openings between two clusters become pairs of nodes linked by one move.
+/// The nodes of a cluster are linked by the cost of the path between them inside the cluster,
+/// so a long search only visits border cells, and the path is refined cluster by cluster.
+/// When cells change, only their clusters and the neighbours sharing a border are rebuilt.
+/// </summary>
+class HierarchicalGraph {
+private:
+	struct Transition {
+		// First cell in the left or top cluster, second in the right or bottom one
+		int cellA;
+		int cellB;
+	};
+
+	int numCols;
+	int numRows;
+	int clusterSize;
+	int numClustersX;
+	int numClustersY;
+
+	std::vector<HierarchicalNode> nodes;
+	std::vector<int> freeNodes;
+	// [key = cell]
+	std::unordered_map<int, int> nodeOfCell;
+	// [vector index = cluster], nodes sorted by cell
+	std::vector<std::vector<int>> clusterNodes;
+
+	// [vector index = cluster], border with the cluster on the right / below
+	std::vector<std::vector<Transition>> verticalBorders;
+	std::vector<std::vector<Transition>> horizontalBorders;
+
+	std::vector<int> dirtyClusters;
+	std::vector<uint8_t> isClusterDirty;
+
+	void FindTransitions(const NavGrid& grid, int cluster, bool isVertical, std::vector<Transition>& transitions) const;
+	int GetOrCreateNode(int cell, int cluster);
+	void FreeNode(int node);
+	void RemoveInterEdge(int node, int targetNode);
+	void UpdateIntraEdges(const NavGrid& grid, int cluster, ClusterSearch& search);
+	void RebuildClusters(const NavGrid& grid, const std::vector<int>& clusters, JobSystem* jobSystem);
+
+public:
+	HierarchicalGraph(int clusterSize = DEFAULT_CLUSTER_SIZE);
+
+	// The job system, when given, computes the paths inside the clusters in parallel
+	void Build(const NavGrid& grid, JobSystem* jobSystem = nullptr);
+
+	// Call after changing the cost of a cell (NavGrid::SetCellChangedCallback() does it), the graph is fixed by Update()
+	void OnCellChanged(int col, int row);
+	// Rebuilds the dirty clusters a few at a time until maxMilliseconds is spent, the graph stays
+	// dirty until they all are. A cluster is rebuilt from the grid, so the order doesn't matter.
+	void Update(const NavGrid& grid, JobSystem* jobSystem = nullptr, double maxMilliseconds = DBL_MAX);
+	bool IsDirty() const { return !dirtyClusters.empty(); }
+	// The nodes and edges of a dirty cluster may not match the grid until Update() rebuilds it
+	bool IsClusterDirty(int cluster) const { return isClusterDirty[cluster] != 0; }
+
+	int GetClusterSize() const { return clusterSize; }
+	int GetNumClusters() const { return numClustersX * numClustersY; }
+	int GetClusterIndex(int col, int row) const { return (row / clusterSize) * numClustersX + col / clusterSize; }
+	ClusterBounds GetClusterBounds(int cluster) const;
+
+	// Node IDs go up to GetNumNodeSlots() - 1, the free slots have a cell of -1
+	int GetNumNodeSlots() const { return static_cast<int>(nodes.size()); }
+	int GetNumNodes() const { return static_cast<int>(nodes.size() - freeNodes.size()); }
+	const HierarchicalNode& GetNode(int node) const { return nodes[node]; }
+	const std::vector<int>& GetClusterNodes(int cluster) const { return clusterNodes[cluster]; }
+};
+
+#endif // !HIERARCHICALGRAPH_H
@@ -0,0 +1,192 @@
+#include "HierarchicalPathSearch.h"
+#include "PathSearch.h"
+#include <algorithm>
+#include <cfloat>
+
+HierarchicalPathSearch::HierarchicalPathSearch() {
+	searchNumber = 0;
+	numExpanded = 0;
+}
+
+void HierarchicalPathSearch::BeginSearch(int numNodes) {
+	if (static_cast<int>(costsSoFar.size()) < numNodes) {
+		costsSoFar.resize(numNodes);
+		parents.resize(numNodes);
+		openedSearch.assign(numNodes, 0);
+		closedSearch.assign(numNodes, 0);
+		searchNumber = 0;
+	}
+	if (++searchNumber == 0) {
+		std::fill(openedSearch.begin(), openedSearch.end(), 0);
+		std::fill(closedSearch.begin(), closedSearch.end(), 0);
+		searchNumber = 1;
+	}
+	openNodes.clear();
+	startEdges.clear();
+	goalEdges.clear();
+	abstractPath.clear();
+	numExpanded = 0;
+}
+
+bool HierarchicalPathSearch::FindPath(const NavGrid& grid, const HierarchicalGraph& graph, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints) {
+	waypoints.clear();
+	if (!grid.IsWalkable(start.x, start.y) || !grid.IsWalkable(goal.x, goal.y)) {
+		return false;
+	}
+
+	const int numCols = grid.GetNumCols();
+	const int startNode = graph.GetNumNodeSlots();
+	const int goalNode = startNode + 1;
+	BeginSearch(goalNode + 1);
+
+	// Link the start to the nodes of its cluster, and the nodes of the goal cluster to the goal
+	const int startCluster = graph.GetClusterIndex(start.x, start.y);
+	const int goalCluster = graph.GetClusterIndex(goal.x, goal.y);
+	const ClusterBounds startBounds = graph.GetClusterBounds(startCluster);
+	const ClusterBounds goalBounds = graph.GetClusterBounds(goalCluster);
+
+	clusterSearch.Search(grid, startBounds, start, false);
+	for (int node : graph.GetClusterNodes(startCluster)) {
+		const int cell = graph.GetNode(node).cell;
+		const float cost = clusterSearch.GetCostTo(cell % numCols, cell / numCols);
+		if (cost < FLT_MAX) {
+			startEdges.push_back({ node, cost });
+		}
+	}
+	// the way inside the cluster can be the shortest, or the only one
+	if (startCluster == goalCluster && clusterSearch.GetCostTo(goal.x, goal.y) < FLT_MAX) {
+		startEdges.push_back({ goalNode, clusterSearch.GetCostTo(goal.x, goal.y) });
+	}
+
+	clusterSearch.Search(grid, goalBounds, goal, true);
+	for (int node : graph.GetClusterNodes(goalCluster)) {
+		const int cell = graph.GetNode(node).cell;
+		const float cost = clusterSearch.GetCostTo(cell % numCols, cell / numCols);
+		if (cost < FLT_MAX) {
+			goalEdges.push_back({ node, cost });
+		}
+	}
+
+	// A* on the graph
+	auto isFarther = [](const OpenNode& a, const OpenNode& b) {
+		if (a.estimatedCost != b.estimatedCost) {
+			return a.estimatedCost > b.estimatedCost;
+		}
+		if (a.costSoFar != b.costSoFar) {
+			return a.costSoFar < b.costSoFar;
+		}
+		return a.node > b.node;
+	};
+	const float minCost = grid.GetMinCost();
+	auto open = [&](int node, float costSoFar, int parent) {
+		if (closedSearch[node] == searchNumber || (openedSearch[node] == searchNumber && costsSoFar[node] <= costSoFar)) {
+			return;
+		}
+		openedSearch[node] = searchNumber;
+		costsSoFar[node] = costSoFar;
+		parents[node] = parent;
+
+		const int cell = node == goalNode ? grid.GetCellIndex(goal.x, goal.y) : graph.GetNode(node).cell;
+		const float heuristic = GetOctileDistance(goal.x - cell % numCols, goal.y - cell / numCols) * minCost;
+		openNodes.push_back({ costSoFar + heuristic, costSoFar, node });
+		std::push_heap(openNodes.begin(), openNodes.end(), isFarther);
+	};
+
+	bool isFound = false;
+	open(startNode, 0.0f, -1);
+	while (!openNodes.empty()) {
+		std::pop_heap(openNodes.begin(), openNodes.end(), isFarther);
+		const OpenNode current = openNodes.back();
+		openNodes.pop_back();
+		if (closedSearch[current.node] == searchNumber) {
+			continue;
+		}
+		closedSearch[current.node] = searchNumber;
+		numExpanded++;
+
+		if (current.node == goalNode) {
+			isFound = true;
+			break;
+		}
+
+		if (current.node == startNode) {
+			for (const auto& edge : startEdges) {
+				open(edge.targetNode, edge.cost, startNode);
+			}
+			continue;
+		}
+
+		const HierarchicalNode& node = graph.GetNode(current.node);
+		for (const auto& edge : node.intraEdges) {
+			open(edge.targetNode, current.costSoFar + edge.cost, current.node);
+		}
+		for (const auto& edge : node.interEdges) {
+			open(edge.targetNode, current.costSoFar + edge.cost, current.node);
+		}
+		if (node.cluster == goalCluster) {
+			for (const auto& edge : goalEdges) {
+				if (edge.targetNode == current.node) {
+					open(goalNode, current.costSoFar + edge.cost, current.node);
+				}
+			}
+		}
+	}
+	if (!isFound) {
+		return false;
+	}
+
+	for (int node = goalNode; node >= 0; node = parents[node]) {
+		abstractPath.push_back(node);
+	}
+	std::reverse(abstractPath.begin(), abstractPath.end());
+
+	// Refine: a step across a border is one move, a step inside a cluster is searched in that cluster
+	auto getCell = [&](int node) {
+		if (node == startNode) {
+			return start;
+		}
+		if (node == goalNode) {
+			return goal;
+		}
+		const int cell = graph.GetNode(node).cell;
+		return glm::ivec2(cell % numCols, cell / numCols);
+	};
+	auto getCluster = [&](int node) {
+		if (node == startNode) {
+			return startCluster;
+		}
+		if (node == goalNode) {
+			return goalCluster;
+		}
+		return graph.GetNode(node).cluster;
+	};
+
+	waypoints.push_back(start);
+	for (size_t i = 1; i < abstractPath.size(); i++) {
+		const glm::ivec2 from = getCell(abstractPath[i - 1]);
+		const glm::ivec2 to = getCell(abstractPath[i]);
+		if (from == to) {
+			continue;
+		}
+		const int fromCluster = getCluster(abstractPath[i - 1]);
+		if (fromCluster != getCluster(abstractPath[i])) {
+			waypoints.push_back(to);
+			continue;
+		}
+		clusterSearch.Search(grid, graph.GetClusterBounds(fromCluster), from, false, to);
+		clusterSearch.AppendPath(to.x, to.y, waypoints);
+	}
+
+	RemoveStraightWaypoints(waypoints);
+	return true;
+}
+
+bool HierarchicalPathSearch::CrossesDirtyCluster(const HierarchicalGraph& graph) const {
+	// the start and the goal are the two slots past the nodes of the graph
+	for (int node : abstractPath) {
+		if (node < graph.GetNumNodeSlots() && graph.IsClusterDirty(graph.GetNode(node).cluster)) {
+			return true;
+		}
+	}
+	return false;
+}
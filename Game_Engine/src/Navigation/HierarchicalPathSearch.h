@@ -0,0 +1,56 @@
+#ifndef HIERARCHICALPATHSEARCH_H
+#define HIERARCHICALPATHSEARCH_H
+
+#include "NavGrid.h"
+#include "HierarchicalGraph.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Scratch memory of the searches on a HierarchicalGraph. The start and the goal are linked to
+/// the nodes of their clusters, A* runs on the graph, then every step between two nodes is
+/// replaced by the cells of its path inside the cluster. The path is close to the cheapest one
+/// (it only crosses the borders at the transitions), for a fraction of the cells visited.
+/// </summary>
+class HierarchicalPathSearch {
+private:
+	struct OpenNode {
+		float estimatedCost;
+		float costSoFar;
+		int node;
+	};
+
+	ClusterSearch clusterSearch;
+
+	// [vector index = node], the two last slots are the start and the goal
+	std::vector<float> costsSoFar;
+	std::vector<int> parents;
+	std::vector<uint32_t> openedSearch;
+	std::vector<uint32_t> closedSearch;
+	uint32_t searchNumber;
+	std::vector<OpenNode> openNodes;
+
+	std::vector<HierarchicalEdge> startEdges;
+	// From a node of the goal cluster to the goal
+	std::vector<HierarchicalEdge> goalEdges;
+	std::vector<int> abstractPath;
+
+	int numExpanded;
+
+	void BeginSearch(int numNodes);
+
+public:
+	HierarchicalPathSearch();
+
+	// Same waypoints as PathSearch::FindPath(), the path is right if it only crosses clusters up to date with the grid
+	bool FindPath(const NavGrid& grid, const HierarchicalGraph& graph, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints);
+
+	// Whether the path of the last search goes through a cluster that changed since it was rebuilt
+	bool CrossesDirtyCluster(const HierarchicalGraph& graph) const;
+
+	// Graph nodes taken out of the open list by the last search
+	int GetNumExpanded() const { return numExpanded; }
+};
+
+#endif // !HIERARCHICALPATHSEARCH_H
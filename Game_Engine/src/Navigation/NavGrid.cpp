@@ -0,0 +1,89 @@
+#include "NavGrid.h"
+#include <algorithm>
+#include <cmath>
+
+NavGrid::NavGrid() {
+	numCols = 0;
+	numRows = 0;
+	cellSize = 1.0f;
+	inverseCellSize = 1.0f;
+	minCost = NAV_DEFAULT_COST;
+	isUniform = true;
+	version = 0;
+	std::fill(numCellsWithCost, numCellsWithCost + 256, 0);
+}
+
+void NavGrid::Build(const TileMap& tileMap) {
+	numCols = tileMap.GetNumCols();
+	numRows = tileMap.GetNumRows();
+	cellSize = tileMap.GetTileSize();
+	inverseCellSize = 1.0f / cellSize;
+
+	costs.resize(numCols * numRows);
+	std::fill(numCellsWithCost, numCellsWithCost + 256, 0);
+	for (int row = 0; row < numRows; row++) {
+		for (int col = 0; col < numCols; col++) {
+			const uint8_t cost = tileMap.IsSolidTile(col, row) ? NAV_BLOCKED : NAV_DEFAULT_COST;
+			costs[row * numCols + col] = cost;
+			numCellsWithCost[cost]++;
+		}
+	}
+
+	UpdateCostStats();
+	version++;
+}
+
+void NavGrid::Build(int numCols, int numRows, float cellSize) {
+	this->numCols = numCols;
+	this->numRows = numRows;
+	this->cellSize = cellSize;
+	inverseCellSize = 1.0f / cellSize;
+
+	costs.assign(numCols * numRows, NAV_DEFAULT_COST);
+	std::fill(numCellsWithCost, numCellsWithCost + 256, 0);
+	numCellsWithCost[NAV_DEFAULT_COST] = numCols * numRows;
+
+	UpdateCostStats();
+	version++;
+}
+
+void NavGrid::SetCost(int col, int row, uint8_t cost) {
+	if (!IsInside(col, row) || costs[row * numCols + col] == cost) {
+		return;
+	}
+	numCellsWithCost[costs[row * numCols + col]]--;
+	numCellsWithCost[cost]++;
+	costs[row * numCols + col] = cost;
+
+	UpdateCostStats();
+	version++;
+	if (onCellChanged) {
+		onCellChanged(col, row);
+	}
+}
+
+void NavGrid::SetCellChangedCallback(CellChangedCallback onCellChanged) {
+	this->onCellChanged = std::move(onCellChanged);
+}
+
+void NavGrid::UpdateCostStats() {
+	// Reads the counts instead of the cells, so changing a tile stays cheap on large maps
+	uint8_t lowest = 255;
+	uint8_t highest = 0;
+	for (int cost = 1; cost < 256; cost++) {
+		if (numCellsWithCost[cost] > 0) {
+			lowest = std::min(lowest, static_cast<uint8_t>(cost));
+			highest = static_cast<uint8_t>(cost);
+		}
+	}
+	minCost = highest > 0 ? lowest : NAV_DEFAULT_COST;
+	isUniform = highest == 0 || lowest == highest;
+}
+
+glm::ivec2 NavGrid::WorldToCell(const glm::vec2& position) const {
+	return glm::ivec2(static_cast<int>(std::floor(position.x * inverseCellSize)), static_cast<int>(std::floor(position.y * inverseCellSize)));
+}
+
+glm::vec2 NavGrid::CellToWorld(int col, int row) const {
+	return glm::vec2((col + 0.5f) * cellSize, (row + 0.5f) * cellSize);
+}
@@ -0,0 +1,103 @@
+#ifndef NAVGRID_H
+#define NAVGRID_H
+
+#include "../TileMap/TileMap.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+// A cell with this cost can't be entered
+const uint8_t NAV_BLOCKED = 0;
+const uint8_t NAV_DEFAULT_COST = 1;
+
+// The 8 moves between neighbouring cells, the first 4 are straight and the last 4 diagonal
+const int NAV_NUM_DIRECTIONS = 8;
+const int NAV_DIRECTIONS_X[NAV_NUM_DIRECTIONS] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+const int NAV_DIRECTIONS_Y[NAV_NUM_DIRECTIONS] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+const float NAV_DIAGONAL_LENGTH = 1.41421356f;
+
+typedef std::function<void(int col, int row)> CellChangedCallback;
+
+inline float GetMoveLength(int directionX, int directionY) {
+	return directionX != 0 && directionY != 0 ? NAV_DIAGONAL_LENGTH : 1.0f;
+}
+
+// Length of the shortest 8-connected path between two cells on an empty grid
+inline float GetOctileDistance(int deltaX, int deltaY) {
+	deltaX = deltaX < 0 ? -deltaX : deltaX;
+	deltaY = deltaY < 0 ? -deltaY : deltaY;
+	const int numDiagonal = deltaX < deltaY ? deltaX : deltaY;
+	const int numStraight = (deltaX > deltaY ? deltaX : deltaY) - numDiagonal;
+	return static_cast<float>(numStraight) + NAV_DIAGONAL_LENGTH * numDiagonal;
+}
+
+/// <summary>
+/// Walkability of the map for the pathfinding, one byte per tile in a flat array.
+/// Entering a cell costs its value times the length of the move (1 straight, sqrt(2) diagonal).
+/// Diagonal moves are only allowed when both cells beside the move are walkable, so paths never
+/// cut the corner of a blocked tile.
+/// </summary>
+class NavGrid {
+private:
+	int numCols;
+	int numRows;
+	float cellSize;
+	float inverseCellSize;
+
+	// [vector index = row * numCols + col]
+	std::vector<uint8_t> costs;
+	// [array index = cost], number of cells with that cost
+	int numCellsWithCost[256];
+
+	// Lowest cost of a walkable cell, the heuristic of the searches is scaled by it
+	uint8_t minCost;
+	// Every walkable cell has the same cost, jump point search is only exact in that case
+	bool isUniform;
+	// Incremented on every change, so the cached results can tell they are stale
+	int version;
+	// Told about each cell whose cost changed, so the graphs built over the grid only fix those
+	CellChangedCallback onCellChanged;
+
+	void UpdateCostStats();
+
+public:
+	NavGrid();
+
+	// Solid tiles are blocked, the others get the default cost
+	void Build(const TileMap& tileMap);
+	// An open grid, every cell gets the default cost
+	void Build(int numCols, int numRows, float cellSize);
+	void SetCost(int col, int row, uint8_t cost);
+	void SetCellChangedCallback(CellChangedCallback onCellChanged);
+
+	int GetNumCols() const { return numCols; }
+	int GetNumRows() const { return numRows; }
+	int GetNumCells() const { return numCols * numRows; }
+	float GetCellSize() const { return cellSize; }
+	uint8_t GetMinCost() const { return minCost; }
+	bool IsUniform() const { return isUniform; }
+	int GetVersion() const { return version; }
+
+	bool IsInside(int col, int row) const { return col >= 0 && row >= 0 && col < numCols && row < numRows; }
+	int GetCellIndex(int col, int row) const { return row * numCols + col; }
+
+	// The outside of the map is blocked
+	uint8_t GetCost(int col, int row) const { return IsInside(col, row) ? costs[row * numCols + col] : NAV_BLOCKED; }
+	bool IsWalkable(int col, int row) const { return GetCost(col, row) != NAV_BLOCKED; }
+
+	// Checks the cell and, for a diagonal move, the two cells it passes between
+	bool CanMove(int col, int row, int directionX, int directionY) const {
+		if (!IsWalkable(col + directionX, row + directionY)) {
+			return false;
+		}
+		return directionX == 0 || directionY == 0 || (IsWalkable(col + directionX, row) && IsWalkable(col, row + directionY));
+	}
+
+	// Cell under a world position, which can be outside of the map
+	glm::ivec2 WorldToCell(const glm::vec2& position) const;
+	glm::vec2 CellToWorld(int col, int row) const;
+};
+
+#endif // !NAVGRID_H
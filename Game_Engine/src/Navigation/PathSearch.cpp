@@ -0,0 +1,332 @@
+#include "PathSearch.h"
+#include <algorithm>
+#include <cfloat>
+
+static int GetSign(int value) {
+	return (value > 0) - (value < 0);
+}
+
+static int GetDirectionIndex(int directionX, int directionY) {
+	for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+		if (NAV_DIRECTIONS_X[direction] == directionX && NAV_DIRECTIONS_Y[direction] == directionY) {
+			return direction;
+		}
+	}
+	return -1;
+}
+
+void RemoveStraightWaypoints(std::vector<glm::ivec2>& waypoints) {
+	size_t numKept = std::min<size_t>(waypoints.size(), 1);
+	for (size_t i = 1; i < waypoints.size(); i++) {
+		const bool isLast = i + 1 == waypoints.size();
+		if (!isLast) {
+			const glm::ivec2 incoming = waypoints[i] - waypoints[numKept - 1];
+			const glm::ivec2 outgoing = waypoints[i + 1] - waypoints[i];
+			if (GetSign(incoming.x) == GetSign(outgoing.x) && GetSign(incoming.y) == GetSign(outgoing.y)) {
+				continue;
+			}
+		}
+		waypoints[numKept++] = waypoints[i];
+	}
+	waypoints.resize(numKept);
+}
+
+PathSearch::PathSearch() {
+	grid = nullptr;
+	goalCol = 0;
+	goalRow = 0;
+	searchNumber = 0;
+	numExpanded = 0;
+}
+
+void PathSearch::BeginSearch(const NavGrid& grid) {
+	this->grid = &grid;
+
+	const size_t numCells = grid.GetNumCells();
+	if (costsSoFar.size() != numCells) {
+		costsSoFar.assign(numCells, 0.0f);
+		parents.assign(numCells, -1);
+		openedSearch.assign(numCells, 0);
+		closedSearch.assign(numCells, 0);
+		searchNumber = 0;
+	}
+
+	// after 4 billion searches the stamps wrap around, and the old ones must not look recent
+	if (++searchNumber == 0) {
+		std::fill(openedSearch.begin(), openedSearch.end(), 0);
+		std::fill(closedSearch.begin(), closedSearch.end(), 0);
+		searchNumber = 1;
+	}
+
+	openNodes.clear();
+	numExpanded = 0;
+}
+
+// The deeper node is preferred between equal estimates, it is usually closer to the goal
+bool PathSearch::IsFarther(const OpenNode& a, const OpenNode& b) {
+	if (a.estimatedCost != b.estimatedCost) {
+		return a.estimatedCost > b.estimatedCost;
+	}
+	if (a.costSoFar != b.costSoFar) {
+		return a.costSoFar < b.costSoFar;
+	}
+	return a.cell > b.cell;
+}
+
+void PathSearch::Open(int cell, float costSoFar, int parent, float heuristic) {
+	if (closedSearch[cell] == searchNumber || (openedSearch[cell] == searchNumber && costsSoFar[cell] <= costSoFar)) {
+		return;
+	}
+	openedSearch[cell] = searchNumber;
+	costsSoFar[cell] = costSoFar;
+	parents[cell] = parent;
+
+	openNodes.push_back({ costSoFar + heuristic, costSoFar, cell });
+	std::push_heap(openNodes.begin(), openNodes.end(), IsFarther);
+}
+
+bool PathSearch::PopClosest(OpenNode& node) {
+	while (!openNodes.empty()) {
+		std::pop_heap(openNodes.begin(), openNodes.end(), IsFarther);
+		node = openNodes.back();
+		openNodes.pop_back();
+
+		// a cell that was improved after this entry was pushed is already closed
+		if (closedSearch[node.cell] != searchNumber) {
+			closedSearch[node.cell] = searchNumber;
+			numExpanded++;
+			return true;
+		}
+	}
+	return false;
+}
+
+float PathSearch::Heuristic(int col, int row) const {
+	return GetOctileDistance(goalCol - col, goalRow - row) * grid->GetMinCost();
+}
+
+void PathSearch::BuildWaypoints(int goalCell, std::vector<glm::ivec2>& waypoints) const {
+	const int numCols = grid->GetNumCols();
+
+	waypoints.clear();
+	for (int cell = goalCell; cell >= 0; cell = parents[cell]) {
+		waypoints.emplace_back(cell % numCols, cell / numCols);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+
+	RemoveStraightWaypoints(waypoints);
+}
+
+bool PathSearch::FindPath(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints) {
+	if (grid.IsUniform()) {
+		return FindPathJPS(grid, start, goal, waypoints);
+	}
+	return FindPathAStar(grid, start, goal, waypoints);
+}
+
+bool PathSearch::FindPathAStar(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints) {
+	BeginSearch(grid);
+	waypoints.clear();
+	if (!grid.IsWalkable(start.x, start.y) || !grid.IsWalkable(goal.x, goal.y)) {
+		return false;
+	}
+
+	goalCol = goal.x;
+	goalRow = goal.y;
+	const int goalCell = grid.GetCellIndex(goal.x, goal.y);
+	Open(grid.GetCellIndex(start.x, start.y), 0.0f, -1, Heuristic(start.x, start.y));
+
+	const int numCols = grid.GetNumCols();
+	OpenNode node;
+	while (PopClosest(node)) {
+		if (node.cell == goalCell) {
+			BuildWaypoints(goalCell, waypoints);
+			return true;
+		}
+
+		const int col = node.cell % numCols;
+		const int row = node.cell / numCols;
+		for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+			const int directionX = NAV_DIRECTIONS_X[direction];
+			const int directionY = NAV_DIRECTIONS_Y[direction];
+			if (!grid.CanMove(col, row, directionX, directionY)) {
+				continue;
+			}
+			const int neighbourCol = col + directionX;
+			const int neighbourRow = row + directionY;
+			const float cost = node.costSoFar + GetMoveLength(directionX, directionY) * grid.GetCost(neighbourCol, neighbourRow);
+			Open(grid.GetCellIndex(neighbourCol, neighbourRow), cost, node.cell, Heuristic(neighbourCol, neighbourRow));
+		}
+	}
+	return false;
+}
+
+int PathSearch::Jump(int col, int row, int directionX, int directionY) const {
+	while (true) {
+		if (!grid->IsWalkable(col, row)) {
+			return -1;
+		}
+		if (col == goalCol && row == goalRow) {
+			return grid->GetCellIndex(col, row);
+		}
+
+		// A cell is a jump point when a path that doesn't come from the parent has to go through it.
+		// Without corner cutting, a straight move only finds one where a wall beside it ends.
+		if (directionX != 0 && directionY != 0) {
+			if (Jump(col + directionX, row, directionX, 0) >= 0 || Jump(col, row + directionY, 0, directionY) >= 0) {
+				return grid->GetCellIndex(col, row);
+			}
+			if (!grid->IsWalkable(col + directionX, row) || !grid->IsWalkable(col, row + directionY)) {
+				return -1;
+			}
+		}
+		else if (directionX != 0) {
+			if ((grid->IsWalkable(col, row - 1) && !grid->IsWalkable(col - directionX, row - 1)) ||
+				(grid->IsWalkable(col, row + 1) && !grid->IsWalkable(col - directionX, row + 1))) {
+				return grid->GetCellIndex(col, row);
+			}
+		}
+		else {
+			if ((grid->IsWalkable(col - 1, row) && !grid->IsWalkable(col - 1, row - directionY)) ||
+				(grid->IsWalkable(col + 1, row) && !grid->IsWalkable(col + 1, row - directionY))) {
+				return grid->GetCellIndex(col, row);
+			}
+		}
+
+		col += directionX;
+		row += directionY;
+	}
+}
+
+bool PathSearch::FindPathJPS(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints) {
+	BeginSearch(grid);
+	waypoints.clear();
+	if (!grid.IsWalkable(start.x, start.y) || !grid.IsWalkable(goal.x, goal.y)) {
+		return false;
+	}
+
+	goalCol = goal.x;
+	goalRow = goal.y;
+	const int goalCell = grid.GetCellIndex(goal.x, goal.y);
+	Open(grid.GetCellIndex(start.x, start.y), 0.0f, -1, Heuristic(start.x, start.y));
+
+	const int numCols = grid.GetNumCols();
+	const float cost = grid.GetMinCost();
+	int numNeighbours;
+	glm::ivec2 neighbours[NAV_NUM_DIRECTIONS];
+
+	OpenNode node;
+	while (PopClosest(node)) {
+		if (node.cell == goalCell) {
+			BuildWaypoints(goalCell, waypoints);
+			return true;
+		}
+
+		const int col = node.cell % numCols;
+		const int row = node.cell / numCols;
+
+		// Only the directions that a path through the parent can't reach as cheaply are followed
+		numNeighbours = 0;
+		const int parent = parents[node.cell];
+		if (parent < 0) {
+			for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+				if (grid.CanMove(col, row, NAV_DIRECTIONS_X[direction], NAV_DIRECTIONS_Y[direction])) {
+					neighbours[numNeighbours++] = glm::ivec2(NAV_DIRECTIONS_X[direction], NAV_DIRECTIONS_Y[direction]);
+				}
+			}
+		}
+		else {
+			const int directionX = GetSign(col - parent % numCols);
+			const int directionY = GetSign(row - parent / numCols);
+			if (directionX != 0 && directionY != 0) {
+				const bool canMoveX = grid.IsWalkable(col + directionX, row);
+				const bool canMoveY = grid.IsWalkable(col, row + directionY);
+				if (canMoveX) {
+					neighbours[numNeighbours++] = glm::ivec2(directionX, 0);
+				}
+				if (canMoveY) {
+					neighbours[numNeighbours++] = glm::ivec2(0, directionY);
+				}
+				if (canMoveX && canMoveY) {
+					neighbours[numNeighbours++] = glm::ivec2(directionX, directionY);
+				}
+			}
+			else {
+				// the two sides of a straight move, perpendicular to it
+				const glm::ivec2 forward(directionX, directionY);
+				const glm::ivec2 side(directionY, directionX);
+				const bool canMoveForward = grid.IsWalkable(col + forward.x, row + forward.y);
+				const bool canMoveSide = grid.IsWalkable(col + side.x, row + side.y);
+				const bool canMoveOtherSide = grid.IsWalkable(col - side.x, row - side.y);
+				if (canMoveForward) {
+					neighbours[numNeighbours++] = forward;
+					if (canMoveSide) {
+						neighbours[numNeighbours++] = forward + side;
+					}
+					if (canMoveOtherSide) {
+						neighbours[numNeighbours++] = forward - side;
+					}
+				}
+				if (canMoveSide) {
+					neighbours[numNeighbours++] = side;
+				}
+				if (canMoveOtherSide) {
+					neighbours[numNeighbours++] = -side;
+				}
+			}
+		}
+
+		for (int i = 0; i < numNeighbours; i++) {
+			const int jumpPoint = Jump(col + neighbours[i].x, row + neighbours[i].y, neighbours[i].x, neighbours[i].y);
+			if (jumpPoint < 0) {
+				continue;
+			}
+			const int jumpCol = jumpPoint % numCols;
+			const int jumpRow = jumpPoint / numCols;
+			const float jumpCost = node.costSoFar + GetOctileDistance(jumpCol - col, jumpRow - row) * cost;
+			Open(jumpPoint, jumpCost, node.cell, Heuristic(jumpCol, jumpRow));
+		}
+	}
+	return false;
+}
+
+void PathSearch::BuildFlowField(const NavGrid& grid, glm::ivec2 goal, FlowField& flowField) {
+	BeginSearch(grid);
+
+	const int numCols = grid.GetNumCols();
+	const int numCells = grid.GetNumCells();
+	flowField.goal = goal;
+	flowField.version = grid.GetVersion();
+	flowField.numCols = numCols;
+	flowField.numRows = grid.GetNumRows();
+	flowField.cellSize = grid.GetCellSize();
+	flowField.distances.assign(numCells, FLT_MAX);
+	flowField.directions.assign(numCells, -1);
+	if (!grid.IsWalkable(goal.x, goal.y)) {
+		return;
+	}
+
+	// Dijkstra outwards from the goal: reaching a neighbour costs the cell that is entered on the way back.
+	// A cell is closed by its cheapest way to the goal, which starts with the move to its parent.
+	Open(grid.GetCellIndex(goal.x, goal.y), 0.0f, -1, 0.0f);
+	OpenNode node;
+	while (PopClosest(node)) {
+		flowField.distances[node.cell] = node.costSoFar;
+
+		const int col = node.cell % numCols;
+		const int row = node.cell / numCols;
+		const int parent = parents[node.cell];
+		if (parent >= 0) {
+			flowField.directions[node.cell] = static_cast<int8_t>(GetDirectionIndex(parent % numCols - col, parent / numCols - row));
+		}
+
+		const float cost = grid.GetCost(col, row);
+		for (int direction = 0; direction < NAV_NUM_DIRECTIONS; direction++) {
+			const int directionX = NAV_DIRECTIONS_X[direction];
+			const int directionY = NAV_DIRECTIONS_Y[direction];
+			if (grid.CanMove(col, row, directionX, directionY)) {
+				Open(grid.GetCellIndex(col + directionX, row + directionY), node.costSoFar + GetMoveLength(directionX, directionY) * cost, node.cell, 0.0f);
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#ifndef PATHSEARCH_H
+#define PATHSEARCH_H
+
+#include "NavGrid.h"
+#include "FlowField.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Keeps the first and last cells of a path, and the cells where it changes direction
+void RemoveStraightWaypoints(std::vector<glm::ivec2>& waypoints);
+
+/// <summary>
+/// Scratch memory of the grid searches. The per-cell arrays are stamped with the number of the
+/// search instead of being cleared, so a search only touches the cells it visits. A PathSearch
+/// is used by one thread at a time; each worker of the PathfindingService has its own.
+/// </summary>
+class PathSearch {
+private:
+	struct OpenNode {
+		float estimatedCost;
+		float costSoFar;
+		int cell;
+	};
+
+	const NavGrid* grid;
+	int goalCol;
+	int goalRow;
+
+	// [vector index = cell], only valid where openedSearch / closedSearch equals searchNumber
+	std::vector<float> costsSoFar;
+	std::vector<int> parents;
+	std::vector<uint32_t> openedSearch;
+	std::vector<uint32_t> closedSearch;
+	uint32_t searchNumber;
+
+	// Binary min-heap on the estimated cost; an improved cell is pushed again, the old entry is skipped
+	std::vector<OpenNode> openNodes;
+
+	int numExpanded;
+
+	static bool IsFarther(const OpenNode& a, const OpenNode& b);
+	void BeginSearch(const NavGrid& grid);
+	void Open(int cell, float costSoFar, int parent, float heuristic);
+	bool PopClosest(OpenNode& node);
+	float Heuristic(int col, int row) const;
+
+	// Moves from (col, row) in the direction until a jump point, returns its cell or -1
+	int Jump(int col, int row, int directionX, int directionY) const;
+
+	// Follows the parents back from the goal, and keeps only the cells where the direction changes
+	void BuildWaypoints(int goalCell, std::vector<glm::ivec2>& waypoints) const;
+
+public:
+	PathSearch();
+
+	// Waypoints from the start cell to the goal cell, including both, at every change of direction.
+	// The path is the cheapest one; jump point search is used when the grid allows it.
+	bool FindPath(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints);
+	bool FindPathAStar(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints);
+	// Only exact on a uniform grid, see NavGrid::IsUniform()
+	bool FindPathJPS(const NavGrid& grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2>& waypoints);
+
+	// Dijkstra from the goal over the whole grid
+	void BuildFlowField(const NavGrid& grid, glm::ivec2 goal, FlowField& flowField);
+
+	// Cells taken out of the open list by the last search
+	int GetNumExpanded() const { return numExpanded; }
+};
+
+#endif // !PATHSEARCH_H
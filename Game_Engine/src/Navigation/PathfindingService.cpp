@@ -0,0 +1,214 @@
+#include "PathfindingService.h"
+#include "../Profiler/Profiler.h"
+#include <SDL.h>
+#include <algorithm>
+#include <iterator>
+
+PathfindingService::PathfindingService(const NavGrid& navGrid, int maxCachedFlowFields) : navGrid(navGrid) {
+	this->maxCachedFlowFields = std::max(maxCachedFlowFields, 1);
+	hierarchicalGraph = nullptr;
+	nextRequestID = 0;
+	frameNumber = 0;
+}
+
+void PathfindingService::SetHierarchicalGraph(HierarchicalGraph* hierarchicalGraph) {
+	this->hierarchicalGraph = hierarchicalGraph;
+}
+
+int PathfindingService::RequestPath(const glm::vec2& start, const glm::vec2& goal, PathCallback onDone) {
+	const int requestID = nextRequestID++;
+	pathRequests.push_back({ requestID, navGrid.WorldToCell(start), navGrid.WorldToCell(goal), std::move(onDone) });
+	return requestID;
+}
+
+void PathfindingService::RequestFlowField(const glm::vec2& goal, FlowFieldCallback onDone) {
+	const glm::ivec2 goalCell = navGrid.WorldToCell(goal);
+	flowFieldRequests.push_back({ goalCell, std::move(onDone) });
+
+	if (!FindFlowField(goalCell) && std::find(pendingFlowFieldGoals.begin(), pendingFlowFieldGoals.end(), goalCell) == pendingFlowFieldGoals.end()) {
+		pendingFlowFieldGoals.push_back(goalCell);
+	}
+}
+
+std::shared_ptr<const FlowField> PathfindingService::GetCachedFlowField(const glm::vec2& goal) {
+	return FindFlowField(navGrid.WorldToCell(goal));
+}
+
+int PathfindingService::GetNumPendingRequests() const {
+	return static_cast<int>(pathRequests.size() + flowFieldRequests.size());
+}
+
+std::shared_ptr<const FlowField> PathfindingService::FindFlowField(glm::ivec2 goal) {
+	if (!navGrid.IsInside(goal.x, goal.y)) {
+		return nullptr;
+	}
+
+	auto cachedFlowField = cachedFlowFields.find(navGrid.GetCellIndex(goal.x, goal.y));
+	if (cachedFlowField == cachedFlowFields.end()) {
+		return nullptr;
+	}
+	// the grid changed since the field was computed
+	if (cachedFlowField->second.flowField->version != navGrid.GetVersion()) {
+		cachedFlowFields.erase(cachedFlowField);
+		return nullptr;
+	}
+	cachedFlowField->second.lastUsedFrame = frameNumber;
+	return cachedFlowField->second.flowField;
+}
+
+void PathfindingService::CacheFlowField(const std::shared_ptr<const FlowField>& flowField) {
+	// The least recently used field makes room, the units still holding it keep it alive
+	if (static_cast<int>(cachedFlowFields.size()) >= maxCachedFlowFields) {
+		auto oldest = std::min_element(cachedFlowFields.begin(), cachedFlowFields.end(), [](const auto& a, const auto& b) {
+			return a.second.lastUsedFrame < b.second.lastUsedFrame;
+		});
+		cachedFlowFields.erase(oldest);
+	}
+	cachedFlowFields[navGrid.GetCellIndex(flowField->goal.x, flowField->goal.y)] = { flowField, frameNumber };
+}
+
+void PathfindingService::AnswerFlowFieldRequests() {
+	// the callbacks can make new requests, they are added to the emptied list
+	std::vector<FlowFieldRequest> waitingRequests;
+	waitingRequests.swap(flowFieldRequests);
+
+	for (auto& request : waitingRequests) {
+		std::shared_ptr<const FlowField> flowField = FindFlowField(request.goal);
+
+		// a goal outside of the map never gets a field
+		if (!flowField && navGrid.IsInside(request.goal.x, request.goal.y)) {
+			// the cached field can go stale while the request waits
+			if (std::find(pendingFlowFieldGoals.begin(), pendingFlowFieldGoals.end(), request.goal) == pendingFlowFieldGoals.end()) {
+				pendingFlowFieldGoals.push_back(request.goal);
+			}
+			flowFieldRequests.push_back(std::move(request));
+			continue;
+		}
+
+		if (request.onDone) {
+			request.onDone(flowField);
+		}
+	}
+}
+
+void PathfindingService::AnswerFlowFieldRequests(const std::shared_ptr<const FlowField>& flowField) {
+	std::vector<FlowFieldRequest> waitingRequests;
+	waitingRequests.swap(flowFieldRequests);
+
+	for (auto& request : waitingRequests) {
+		if (request.goal != flowField->goal) {
+			flowFieldRequests.push_back(std::move(request));
+			continue;
+		}
+		if (request.onDone) {
+			request.onDone(flowField);
+		}
+	}
+}
+
+void PathfindingService::FinishJob(PathJob& job) {
+	if (job.isFlowField) {
+		CacheFlowField(job.flowField);
+		// The fields computed in the same Update() are all as recently used, with more goals than
+		// the cache holds the next ones would evict this field before its requests see it
+		AnswerFlowFieldRequests(job.flowField);
+		return;
+	}
+
+	PathResult result;
+	result.requestID = job.request.requestID;
+	result.isFound = job.isFound;
+	for (const auto& cell : job.cells) {
+		result.waypoints.push_back(navGrid.CellToWorld(cell.x, cell.y));
+	}
+	if (job.request.onDone) {
+		job.request.onDone(result);
+	}
+}
+
+void PathfindingService::Update(JobSystem& jobSystem, double maxMilliseconds) {
+	frameNumber++;
+	AnswerFlowFieldRequests();
+
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	const double millisecsPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+
+	// The clusters where tiles changed are rebuilt within the budget
+	if (hierarchicalGraph) {
+		hierarchicalGraph->Update(navGrid, &jobSystem, maxMilliseconds);
+	}
+	if (pathRequests.empty() && pendingFlowFieldGoals.empty()) {
+		return;
+	}
+
+	PROFILE_FUNCTION();
+
+	const int numThreads = jobSystem.GetNumThreads();
+	if (static_cast<int>(searches.size()) < numThreads) {
+		searches.resize(numThreads);
+		hierarchicalSearches.resize(numThreads);
+	}
+
+	// Run at least one wave per call, the remaining requests wait for the next frame once the budget is spent
+	while (!pathRequests.empty() || !pendingFlowFieldGoals.empty()) {
+		// the flow fields go first, a single one can answer many units
+		wave.resize(std::min<size_t>(numThreads, pathRequests.size() + pendingFlowFieldGoals.size()));
+		for (auto& job : wave) {
+			if (!pendingFlowFieldGoals.empty()) {
+				job.isFlowField = true;
+				job.request = { -1, glm::ivec2(0), pendingFlowFieldGoals.front(), nullptr };
+				pendingFlowFieldGoals.pop_front();
+			}
+			else {
+				job.isFlowField = false;
+				job.request = std::move(pathRequests.front());
+				pathRequests.pop_front();
+			}
+		}
+
+		jobSystem.ParallelFor(static_cast<int>(wave.size()), 1, [this](int first, int last) {
+			for (int i = first; i < last; i++) {
+				PathJob& job = wave[i];
+				job.isWaiting = false;
+				if (job.isFlowField) {
+					job.flowField = std::make_shared<FlowField>();
+					searches[i].BuildFlowField(navGrid, job.request.goal, *job.flowField);
+				}
+				else if (hierarchicalGraph && navGrid.IsInside(job.request.start.x, job.request.start.y) && navGrid.IsInside(job.request.goal.x, job.request.goal.y) &&
+					hierarchicalGraph->GetClusterIndex(job.request.start.x, job.request.start.y) != hierarchicalGraph->GetClusterIndex(job.request.goal.x, job.request.goal.y)) {
+					const int startCluster = hierarchicalGraph->GetClusterIndex(job.request.start.x, job.request.start.y);
+					const int goalCluster = hierarchicalGraph->GetClusterIndex(job.request.goal.x, job.request.goal.y);
+					if (hierarchicalGraph->IsClusterDirty(startCluster) || hierarchicalGraph->IsClusterDirty(goalCluster)) {
+						job.isWaiting = true;
+						continue;
+					}
+					job.isFound = hierarchicalSearches[i].FindPath(navGrid, *hierarchicalGraph, job.request.start, job.request.goal, job.cells);
+					// A path through a changed cluster may be blocked, and one that was not found may go through it now
+					job.isWaiting = hierarchicalGraph->IsDirty() && (!job.isFound || hierarchicalSearches[i].CrossesDirtyCluster(*hierarchicalGraph));
+				}
+				else {
+					job.isFound = searches[i].FindPath(navGrid, job.request.start, job.request.goal, job.cells);
+				}
+			}
+		});
+
+		for (auto& job : wave) {
+			if (job.isWaiting) {
+				waitingPathRequests.push_back(std::move(job.request));
+				continue;
+			}
+			FinishJob(job);
+		}
+
+		const double elapsedMilliseconds = (SDL_GetPerformanceCounter() - startCounter) * millisecsPerCount;
+		if (elapsedMilliseconds >= maxMilliseconds) {
+			break;
+		}
+	}
+
+	// The waiting requests keep their place, ahead of the ones made since
+	pathRequests.insert(pathRequests.begin(), std::make_move_iterator(waitingPathRequests.begin()), std::make_move_iterator(waitingPathRequests.end()));
+	waitingPathRequests.clear();
+
+	AnswerFlowFieldRequests();
+}
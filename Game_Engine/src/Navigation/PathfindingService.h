@@ -0,0 +1,115 @@
+#ifndef PATHFINDINGSERVICE_H
+#define PATHFINDINGSERVICE_H
+
+#include "NavGrid.h"
+#include "FlowField.h"
+#include "PathSearch.h"
+#include "HierarchicalGraph.h"
+#include "HierarchicalPathSearch.h"
+#include "../JobSystem/JobSystem.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+const int DEFAULT_MAX_CACHED_FLOW_FIELDS = 16;
+
+struct PathResult {
+	int requestID;
+	bool isFound;
+	// Centers of the cells where the path changes direction, from the start cell to the goal cell
+	std::vector<glm::vec2> waypoints;
+};
+
+typedef std::function<void(const PathResult& result)> PathCallback;
+typedef std::function<void(const std::shared_ptr<const FlowField>& flowField)> FlowFieldCallback;
+
+/// <summary>
+/// Answers the path and flow field requests of the gameplay code a few frames later. The
+/// requests are queued, and every frame Update() searches them in waves of one request per
+/// thread of the job system until the time budget is spent. The callbacks are called from
+/// Update(), on the main thread, which is also the only thread allowed to make requests.
+/// Flow fields are cached by goal, so all the units heading to one place share a single field.
+/// </summary>
+class PathfindingService {
+private:
+	struct PathRequest {
+		int requestID;
+		glm::ivec2 start;
+		glm::ivec2 goal;
+		PathCallback onDone;
+	};
+
+	struct FlowFieldRequest {
+		glm::ivec2 goal;
+		FlowFieldCallback onDone;
+	};
+
+	struct CachedFlowField {
+		std::shared_ptr<const FlowField> flowField;
+		int lastUsedFrame;
+	};
+
+	// One search of a wave, written by the worker that runs it
+	struct PathJob {
+		bool isFlowField;
+		PathRequest request;
+		std::vector<glm::ivec2> cells;
+		bool isFound;
+		// The graph is out of date where the path goes, the request waits for its clusters
+		bool isWaiting;
+		std::shared_ptr<FlowField> flowField;
+	};
+
+	const NavGrid& navGrid;
+	// Optional, used for the paths between two clusters
+	HierarchicalGraph* hierarchicalGraph;
+
+	std::deque<PathRequest> pathRequests;
+	// Taken out of the queue by Update() until it returns, they go back to its front
+	std::vector<PathRequest> waitingPathRequests;
+	// Waiting callbacks, and the goals whose field still has to be computed (each goal once)
+	std::vector<FlowFieldRequest> flowFieldRequests;
+	std::deque<glm::ivec2> pendingFlowFieldGoals;
+
+	// [key = goal cell]
+	std::unordered_map<int, CachedFlowField> cachedFlowFields;
+	int maxCachedFlowFields;
+
+	// [vector index = job of the wave]
+	std::vector<PathJob> wave;
+	std::vector<PathSearch> searches;
+	std::vector<HierarchicalPathSearch> hierarchicalSearches;
+
+	int nextRequestID;
+	int frameNumber;
+
+	std::shared_ptr<const FlowField> FindFlowField(glm::ivec2 goal);
+	void CacheFlowField(const std::shared_ptr<const FlowField>& flowField);
+	void AnswerFlowFieldRequests();
+	// Answers the requests waiting for the goal of a field that was just computed
+	void AnswerFlowFieldRequests(const std::shared_ptr<const FlowField>& flowField);
+	void FinishJob(PathJob& job);
+
+public:
+	PathfindingService(const NavGrid& navGrid, int maxCachedFlowFields = DEFAULT_MAX_CACHED_FLOW_FIELDS);
+
+	// Long paths are searched on the graph once it is set, it is brought up to date by Update().
+	// Meanwhile only the paths that go through changed clusters wait for them.
+	void SetHierarchicalGraph(HierarchicalGraph* hierarchicalGraph);
+
+	// Returns the ID given to the result
+	int RequestPath(const glm::vec2& start, const glm::vec2& goal, PathCallback onDone);
+	void RequestFlowField(const glm::vec2& goal, FlowFieldCallback onDone);
+
+	// The field already computed for the goal, or nullptr; it never starts a search
+	std::shared_ptr<const FlowField> GetCachedFlowField(const glm::vec2& goal);
+
+	void Update(JobSystem& jobSystem, double maxMilliseconds);
+
+	int GetNumPendingRequests() const;
+};
+
+#endif // !PATHFINDINGSERVICE_H
@@ -0,0 +1,183 @@
+#include "ReplicationClient.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cstring>
+
+ReplicationClient::ReplicationClient() {
+	viewCenter = glm::vec2(0.0f);
+	snapshots.resize(REPLICATION_SNAPSHOT_RING_SIZE);
+	for (auto& snapshot : snapshots) {
+		snapshot.isValid = false;
+	}
+	latestSequence = 0;
+	hasSnapshot = false;
+	numBytesReceived = 0;
+	numPacketsReceived = 0;
+	numPacketsDropped = 0;
+}
+
+bool ReplicationClient::Connect(const NetworkAddress& serverAddress) {
+	if (!socket.Open()) {
+		Logger::Err("Can't open the socket of the replication client");
+		return false;
+	}
+	this->serverAddress = serverAddress;
+	SendAck();
+	return true;
+}
+
+void ReplicationClient::Disconnect() {
+	socket.Close();
+	for (auto& snapshot : snapshots) {
+		snapshot.isValid = false;
+	}
+	hasSnapshot = false;
+}
+
+void ReplicationClient::SetViewCenter(const glm::vec2& viewCenter) {
+	this->viewCenter = viewCenter;
+}
+
+void ReplicationClient::SetSimulatedPacketLoss(float packetLossRate, uint64_t seed) {
+	socket.SetSimulatedPacketLoss(packetLossRate, seed);
+}
+
+bool ReplicationClient::ReadSnapshot(const uint8_t* data, size_t size) {
+	BitReader reader(data, size);
+	if (reader.ReadBits(REPLICATION_PROTOCOL_ID_BITS) != REPLICATION_PROTOCOL_ID || reader.ReadBits(REPLICATION_PACKET_TYPE_BITS) != REPLICATION_PACKET_SNAPSHOT) {
+		return false;
+	}
+	const uint32_t sequence = reader.ReadBits(32);
+	const int tick = static_cast<int>(reader.ReadBits(32));
+	const bool hasBaseline = reader.ReadBool();
+	const uint32_t baselineAge = hasBaseline ? reader.ReadBits(REPLICATION_BASELINE_AGE_BITS) : 0;
+	if (!reader.IsValid() || (hasSnapshot && static_cast<int32_t>(sequence - latestSequence) <= 0)) {
+		return false;
+	}
+
+	const ReplicationSnapshot* baseline = nullptr;
+	if (hasBaseline) {
+		const uint32_t baselineSequence = sequence - baselineAge;
+		baseline = &snapshots[baselineSequence % REPLICATION_SNAPSHOT_RING_SIZE];
+		if (baselineAge == 0 || !baseline->isValid || baseline->sequence != baselineSequence) {
+			return false;
+		}
+	}
+
+	// The removals are increasing network IDs, the baseline entities are sorted the same way
+	const uint32_t numRemovals = ReadVarUInt(reader);
+	if (!baseline && numRemovals > 0) {
+		return false;
+	}
+	decoded.entities.clear();
+	size_t baselineIndex = 0;
+	uint32_t removedID = 0;
+	for (uint32_t i = 0; i < numRemovals && reader.IsValid(); i++) {
+		removedID += ReadVarUInt(reader);
+		while (baselineIndex < baseline->entities.size() && baseline->entities[baselineIndex].networkID < removedID) {
+			decoded.entities.push_back(baseline->entities[baselineIndex++]);
+		}
+		if (baselineIndex < baseline->entities.size() && baseline->entities[baselineIndex].networkID == removedID) {
+			baselineIndex++;
+		}
+	}
+	if (baseline) {
+		decoded.entities.insert(decoded.entities.end(), baseline->entities.begin() + baselineIndex, baseline->entities.end());
+	}
+
+	// The changed and new entities, in the order the server sent them
+	const size_t numKeptEntities = decoded.entities.size();
+	while (reader.IsValid() && reader.ReadBool()) {
+		const uint32_t networkID = ReadVarUInt(reader);
+		const ReplicatedEntity* baselineEntity = baseline ? FindReplicatedEntity(*baseline, networkID) : nullptr;
+		ReplicatedEntity entity;
+		entity.networkID = networkID;
+		ReadTransform(reader, baselineEntity ? &baselineEntity->transform : nullptr, entity.transform);
+
+		auto keptEntity = std::lower_bound(decoded.entities.begin(), decoded.entities.begin() + numKeptEntities, networkID, [](const ReplicatedEntity& entity, uint32_t networkID) {
+			return entity.networkID < networkID;
+		});
+		if (keptEntity != decoded.entities.begin() + numKeptEntities && keptEntity->networkID == networkID) {
+			keptEntity->transform = entity.transform;
+		}
+		else {
+			decoded.entities.push_back(entity);
+		}
+	}
+	if (!reader.IsValid()) {
+		return false;
+	}
+	std::sort(decoded.entities.begin(), decoded.entities.end(), [](const ReplicatedEntity& entity, const ReplicatedEntity& otherEntity) {
+		return entity.networkID < otherEntity.networkID;
+	});
+
+	ReplicationSnapshot& snapshot = snapshots[sequence % REPLICATION_SNAPSHOT_RING_SIZE];
+	snapshot.sequence = sequence;
+	snapshot.tick = tick;
+	snapshot.isValid = true;
+	snapshot.entities.swap(decoded.entities);
+	latestSequence = sequence;
+	hasSnapshot = true;
+	return true;
+}
+
+void ReplicationClient::SendAck() {
+	uint32_t viewCenterX;
+	uint32_t viewCenterY;
+	std::memcpy(&viewCenterX, &viewCenter.x, sizeof(float));
+	std::memcpy(&viewCenterY, &viewCenter.y, sizeof(float));
+
+	uint8_t ack[16];
+	BitWriter writer(ack, sizeof(ack));
+	writer.WriteBits(REPLICATION_PROTOCOL_ID, REPLICATION_PROTOCOL_ID_BITS);
+	writer.WriteBits(REPLICATION_PACKET_ACK, REPLICATION_PACKET_TYPE_BITS);
+	writer.WriteBool(hasSnapshot);
+	if (hasSnapshot) {
+		writer.WriteBits(latestSequence, 32);
+	}
+	writer.WriteBits(viewCenterX, 32);
+	writer.WriteBits(viewCenterY, 32);
+	socket.Send(serverAddress, ack, writer.GetNumBytes());
+}
+
+void ReplicationClient::Update() {
+	if (!socket.IsOpen()) {
+		return;
+	}
+
+	NetworkAddress sender;
+	int packetSize;
+	while ((packetSize = socket.Receive(packet, sizeof(packet), sender)) > 0) {
+		if (sender != serverAddress) {
+			continue;
+		}
+		numBytesReceived += packetSize;
+		numPacketsReceived++;
+		if (!ReadSnapshot(packet, packetSize)) {
+			numPacketsDropped++;
+		}
+	}
+
+	// Sent even without a new snapshot, it keeps the client connected and the view center up to date
+	SendAck();
+}
+
+bool ReplicationClient::HasSnapshot() const {
+	return hasSnapshot;
+}
+
+const ReplicationSnapshot& ReplicationClient::GetLatestSnapshot() const {
+	return snapshots[latestSequence % REPLICATION_SNAPSHOT_RING_SIZE];
+}
+
+uint64_t ReplicationClient::GetNumBytesReceived() const {
+	return numBytesReceived;
+}
+
+int ReplicationClient::GetNumPacketsReceived() const {
+	return numPacketsReceived;
+}
+
+int ReplicationClient::GetNumPacketsDropped() const {
+	return numPacketsDropped;
+}
@@ -0,0 +1,63 @@
+#ifndef REPLICATIONCLIENT_H
+#define REPLICATIONCLIENT_H
+
+#include "ReplicationFormat.h"
+#include "UdpSocket.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+/// <summary>
+/// Receives the world state sent by a ReplicationServer. Every snapshot packet is decoded
+/// against the snapshot it was written from, which the client keeps in a ring of the last
+/// ones it received, and each update tells the server the newest snapshot received and
+/// where the client looks. Packets that arrive late or reference a snapshot the client no
+/// longer has are dropped, a newer packet always follows.
+/// </summary>
+class ReplicationClient {
+private:
+	UdpSocket socket;
+	NetworkAddress serverAddress;
+	glm::vec2 viewCenter;
+
+	// [index = sequence % REPLICATION_SNAPSHOT_RING_SIZE]
+	std::vector<ReplicationSnapshot> snapshots;
+	// Newest snapshot decoded, valid if hasSnapshot
+	uint32_t latestSequence;
+	bool hasSnapshot;
+	// The packet is decoded here, it only replaces a snapshot of the ring once it is read without error
+	ReplicationSnapshot decoded;
+
+	uint8_t packet[MAX_PACKET_SIZE];
+	uint64_t numBytesReceived;
+	int numPacketsReceived;
+	int numPacketsDropped;
+
+	bool ReadSnapshot(const uint8_t* data, size_t size);
+	void SendAck();
+
+public:
+	ReplicationClient();
+
+	bool Connect(const NetworkAddress& serverAddress);
+	void Disconnect();
+
+	// Center of the area the server sends the entities of
+	void SetViewCenter(const glm::vec2& viewCenter);
+	// Drops this share of the packets sent, to test the replication over a bad network
+	void SetSimulatedPacketLoss(float packetLossRate, uint64_t seed);
+
+	// Decodes the packets received since the last update, then acknowledges the newest snapshot
+	void Update();
+
+	bool HasSnapshot() const;
+	// The replicated entities around the view center, sorted by network ID
+	const ReplicationSnapshot& GetLatestSnapshot() const;
+
+	uint64_t GetNumBytesReceived() const;
+	int GetNumPacketsReceived() const;
+	// Packets received too late or without their baseline
+	int GetNumPacketsDropped() const;
+};
+
+#endif // !REPLICATIONCLIENT_H
@@ -0,0 +1,106 @@
+#include "ReplicationFormat.h"
+#include <algorithm>
+
+const ReplicatedEntity* FindReplicatedEntity(const ReplicationSnapshot& snapshot, uint32_t networkID) {
+	auto entity = std::lower_bound(snapshot.entities.begin(), snapshot.entities.end(), networkID, [](const ReplicatedEntity& entity, uint32_t networkID) {
+		return entity.networkID < networkID;
+	});
+	return entity != snapshot.entities.end() && entity->networkID == networkID ? &*entity : nullptr;
+}
+
+void WriteVarUInt(BitWriter& writer, uint32_t value) {
+	if (value < (1u << 4)) {
+		writer.WriteBits(0, 2);
+		writer.WriteBits(value, 4);
+	}
+	else if (value < (1u << 8)) {
+		writer.WriteBits(1, 2);
+		writer.WriteBits(value, 8);
+	}
+	else if (value < (1u << 16)) {
+		writer.WriteBits(2, 2);
+		writer.WriteBits(value, 16);
+	}
+	else {
+		writer.WriteBits(3, 2);
+		writer.WriteBits(value, 32);
+	}
+}
+
+uint32_t ReadVarUInt(BitReader& reader) {
+	const int numBits[] = { 4, 8, 16, 32 };
+	return reader.ReadBits(numBits[reader.ReadBits(2)]);
+}
+
+void WriteVarInt(BitWriter& writer, int32_t value) {
+	WriteVarUInt(writer, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+int32_t ReadVarInt(BitReader& reader) {
+	const uint32_t value = ReadVarUInt(reader);
+	return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// Bits of the changed fields mask
+const uint32_t TRANSFORM_POSITION_CHANGED = 1;
+const uint32_t TRANSFORM_SCALE_CHANGED = 2;
+const uint32_t TRANSFORM_ROTATION_CHANGED = 4;
+
+void WriteTransform(BitWriter& writer, const QuantizedTransform* baseline, const QuantizedTransform& transform) {
+	if (!baseline) {
+		WriteVarInt(writer, transform.positionX);
+		WriteVarInt(writer, transform.positionY);
+		WriteVarInt(writer, transform.scaleX);
+		WriteVarInt(writer, transform.scaleY);
+		writer.WriteBits(transform.rotation, REPLICATION_ROTATION_BITS);
+		return;
+	}
+
+	uint32_t changedFields = 0;
+	if (transform.positionX != baseline->positionX || transform.positionY != baseline->positionY) {
+		changedFields |= TRANSFORM_POSITION_CHANGED;
+	}
+	if (transform.scaleX != baseline->scaleX || transform.scaleY != baseline->scaleY) {
+		changedFields |= TRANSFORM_SCALE_CHANGED;
+	}
+	if (transform.rotation != baseline->rotation) {
+		changedFields |= TRANSFORM_ROTATION_CHANGED;
+	}
+	writer.WriteBits(changedFields, 3);
+	if (changedFields & TRANSFORM_POSITION_CHANGED) {
+		WriteVarInt(writer, transform.positionX - baseline->positionX);
+		WriteVarInt(writer, transform.positionY - baseline->positionY);
+	}
+	if (changedFields & TRANSFORM_SCALE_CHANGED) {
+		WriteVarInt(writer, transform.scaleX - baseline->scaleX);
+		WriteVarInt(writer, transform.scaleY - baseline->scaleY);
+	}
+	if (changedFields & TRANSFORM_ROTATION_CHANGED) {
+		writer.WriteBits(transform.rotation, REPLICATION_ROTATION_BITS);
+	}
+}
+
+void ReadTransform(BitReader& reader, const QuantizedTransform* baseline, QuantizedTransform& transform) {
+	if (!baseline) {
+		transform.positionX = ReadVarInt(reader);
+		transform.positionY = ReadVarInt(reader);
+		transform.scaleX = ReadVarInt(reader);
+		transform.scaleY = ReadVarInt(reader);
+		transform.rotation = reader.ReadBits(REPLICATION_ROTATION_BITS);
+		return;
+	}
+
+	transform = *baseline;
+	const uint32_t changedFields = reader.ReadBits(3);
+	if (changedFields & TRANSFORM_POSITION_CHANGED) {
+		transform.positionX += ReadVarInt(reader);
+		transform.positionY += ReadVarInt(reader);
+	}
+	if (changedFields & TRANSFORM_SCALE_CHANGED) {
+		transform.scaleX += ReadVarInt(reader);
+		transform.scaleY += ReadVarInt(reader);
+	}
+	if (changedFields & TRANSFORM_ROTATION_CHANGED) {
+		transform.rotation = reader.ReadBits(REPLICATION_ROTATION_BITS);
+	}
+}
@@ -0,0 +1,96 @@
+#ifndef REPLICATIONFORMAT_H
+#define REPLICATIONFORMAT_H
+
+#include "../Components/TransformComponent.h"
+#include "../Utils/BitStream.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Every packet starts with the protocol ID, so stray packets sent to the port are ignored
+const uint32_t REPLICATION_PROTOCOL_ID = 0x5250;
+const int REPLICATION_PROTOCOL_ID_BITS = 16;
+
+enum ReplicationPacketType {
+	// Server to client: the entities around the client, as changes from a snapshot the client acknowledged
+	REPLICATION_PACKET_SNAPSHOT,
+	// Client to server: the last snapshot received and where the client looks, it also connects the client
+	REPLICATION_PACKET_ACK
+};
+const int REPLICATION_PACKET_TYPE_BITS = 2;
+
+// Snapshots kept to encode and decode the changes, an acknowledgment older than that is ignored
+const int REPLICATION_SNAPSHOT_RING_SIZE = 32;
+const int REPLICATION_BASELINE_AGE_BITS = 5;
+
+// Positions in 1/16 of a pixel, scales in 1/256, rotations in 1/65536 of a turn
+const float REPLICATION_POSITION_PRECISION = 16.0f;
+const float REPLICATION_SCALE_PRECISION = 256.0f;
+const int REPLICATION_ROTATION_BITS = 16;
+
+// Clients only receive the entities within this distance of their view center
+const float REPLICATION_INTEREST_RADIUS = 1000.0f;
+const int MAX_REPLICATION_CLIENTS = 16;
+// A client that sent nothing for this many server updates (5 seconds at 60 per second) is dropped
+const int REPLICATION_CLIENT_TIMEOUT_UPDATES = 300;
+
+struct QuantizedTransform {
+	int32_t positionX;
+	int32_t positionY;
+	int32_t scaleX;
+	int32_t scaleY;
+	uint32_t rotation;
+
+	bool operator == (const QuantizedTransform& other) const {
+		return positionX == other.positionX && positionY == other.positionY && scaleX == other.scaleX
+			&& scaleY == other.scaleY && rotation == other.rotation;
+	}
+	bool operator != (const QuantizedTransform& other) const { return !(*this == other); }
+};
+
+inline QuantizedTransform QuantizeTransform(const TransformComponent& transform) {
+	const double turns = transform.rotation / 360.0 - std::floor(transform.rotation / 360.0);
+	QuantizedTransform quantized;
+	quantized.positionX = static_cast<int32_t>(std::lround(transform.position.x * REPLICATION_POSITION_PRECISION));
+	quantized.positionY = static_cast<int32_t>(std::lround(transform.position.y * REPLICATION_POSITION_PRECISION));
+	quantized.scaleX = static_cast<int32_t>(std::lround(transform.scale.x * REPLICATION_SCALE_PRECISION));
+	quantized.scaleY = static_cast<int32_t>(std::lround(transform.scale.y * REPLICATION_SCALE_PRECISION));
+	quantized.rotation = static_cast<uint32_t>(std::llround(turns * (1 << REPLICATION_ROTATION_BITS))) & ((1u << REPLICATION_ROTATION_BITS) - 1);
+	return quantized;
+}
+
+inline TransformComponent DequantizeTransform(const QuantizedTransform& quantized) {
+	return TransformComponent(
+		glm::vec2(quantized.positionX, quantized.positionY) / REPLICATION_POSITION_PRECISION,
+		glm::vec2(quantized.scaleX, quantized.scaleY) / REPLICATION_SCALE_PRECISION,
+		quantized.rotation * 360.0 / (1 << REPLICATION_ROTATION_BITS));
+}
+
+struct ReplicatedEntity {
+	uint32_t networkID;
+	QuantizedTransform transform;
+};
+
+// What a client knows of the world after a snapshot packet, the entities sorted by network ID
+struct ReplicationSnapshot {
+	uint32_t sequence;
+	int tick;
+	bool isValid;
+	std::vector<ReplicatedEntity> entities;
+};
+
+// The entity of that network ID in a snapshot, or nullptr
+const ReplicatedEntity* FindReplicatedEntity(const ReplicationSnapshot& snapshot, uint32_t networkID);
+
+// Small values on few bits: a 2 bit prefix tells if the value takes 4, 8, 16 or 32 bits
+void WriteVarUInt(BitWriter& writer, uint32_t value);
+uint32_t ReadVarUInt(BitReader& reader);
+// Signed values are zigzag encoded, so the small negative values are small too
+void WriteVarInt(BitWriter& writer, int32_t value);
+int32_t ReadVarInt(BitReader& reader);
+
+// Without a baseline every field is written, otherwise a mask of the changed fields and their difference
+void WriteTransform(BitWriter& writer, const QuantizedTransform* baseline, const QuantizedTransform& transform);
+void ReadTransform(BitReader& reader, const QuantizedTransform* baseline, QuantizedTransform& transform);
+
+#endif // !REPLICATIONFORMAT_H
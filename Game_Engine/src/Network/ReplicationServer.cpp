@@ -0,0 +1,283 @@
+#include "ReplicationServer.h"
+#include "../Components/ReplicatedComponent.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+// The removals that don't fit wait for the next packet, the client keeps these entities until then
+const int MAX_REPLICATION_REMOVALS_PER_PACKET = 128;
+
+// Newer sequence numbers, even once they wrap around
+static bool IsSequenceNewer(uint32_t sequence, uint32_t otherSequence) {
+	return static_cast<int32_t>(sequence - otherSequence) > 0;
+}
+
+static bool CompareNetworkIDs(const ReplicatedEntity& entity, const ReplicatedEntity& otherEntity) {
+	return entity.networkID < otherEntity.networkID;
+}
+
+ReplicationServer::ReplicationServer() {
+	nextSequence = 1;
+	numUpdates = 0;
+	worldBounds = { glm::vec2(-FLT_MAX), glm::vec2(FLT_MAX) };
+}
+
+bool ReplicationServer::Start(uint16_t port) {
+	if (!socket.Open(port)) {
+		Logger::Err("Can't start the replication server on port " + std::to_string(port));
+		return false;
+	}
+	Logger::Log("Replication server listening on port " + std::to_string(socket.GetPort()));
+	return true;
+}
+
+void ReplicationServer::Stop() {
+	socket.Close();
+	clients.clear();
+}
+
+uint16_t ReplicationServer::GetPort() const {
+	return socket.GetPort();
+}
+
+void ReplicationServer::SetSimulatedPacketLoss(float packetLossRate, uint64_t seed) {
+	socket.SetSimulatedPacketLoss(packetLossRate, seed);
+}
+
+void ReplicationServer::SetWorldBounds(const AABB& bounds) {
+	worldBounds = bounds;
+}
+
+ReplicationServer::Client* ReplicationServer::FindClient(const NetworkAddress& address) {
+	for (auto& client : clients) {
+		if (client.address == address) {
+			return &client;
+		}
+	}
+	return nullptr;
+}
+
+void ReplicationServer::ReceiveAcks() {
+	NetworkAddress sender;
+	int packetSize;
+	while ((packetSize = socket.Receive(packet, sizeof(packet), sender)) > 0) {
+		BitReader reader(packet, packetSize);
+		if (reader.ReadBits(REPLICATION_PROTOCOL_ID_BITS) != REPLICATION_PROTOCOL_ID || reader.ReadBits(REPLICATION_PACKET_TYPE_BITS) != REPLICATION_PACKET_ACK) {
+			continue;
+		}
+		const bool hasAck = reader.ReadBool();
+		const uint32_t ackedSequence = hasAck ? reader.ReadBits(32) : 0;
+		const uint32_t viewCenterX = reader.ReadBits(32);
+		const uint32_t viewCenterY = reader.ReadBits(32);
+		glm::vec2 viewCenter;
+		std::memcpy(&viewCenter.x, &viewCenterX, sizeof(float));
+		std::memcpy(&viewCenter.y, &viewCenterY, sizeof(float));
+		// The view center goes to the spatial queries, a NaN or infinite one is never trusted
+		if (!reader.IsValid() || !std::isfinite(viewCenter.x) || !std::isfinite(viewCenter.y)) {
+			continue;
+		}
+
+		// The first packet of an address connects it
+		Client* client = FindClient(sender);
+		if (!client) {
+			if (static_cast<int>(clients.size()) >= MAX_REPLICATION_CLIENTS) {
+				continue;
+			}
+			clients.emplace_back();
+			client = &clients.back();
+			client->address = sender;
+			client->hasAck = false;
+			client->ackedSequence = 0;
+			client->snapshots.resize(REPLICATION_SNAPSHOT_RING_SIZE);
+			for (auto& snapshot : client->snapshots) {
+				snapshot.isValid = false;
+			}
+			client->numBytesSent = 0;
+			client->numPacketsSent = 0;
+			Logger::Log("Replication client " + sender.ToString() + " connected");
+		}
+		client->lastReceivedUpdate = numUpdates;
+		client->viewCenter = glm::clamp(viewCenter, worldBounds.min, worldBounds.max);
+
+		// The acknowledgments may arrive out of order, only a newer snapshot that was sent moves the baseline
+		if (hasAck && IsSequenceNewer(nextSequence, ackedSequence) && (!client->hasAck || IsSequenceNewer(ackedSequence, client->ackedSequence))) {
+			client->ackedSequence = ackedSequence;
+			client->hasAck = true;
+		}
+	}
+}
+
+void ReplicationServer::FindInterestEntities(Registry& registry, const SpatialQuerySystem& spatialQuery, const glm::vec2& viewCenter) {
+	queryResults.resize(registry.GetNumEntities());
+	const int numResults = spatialQuery.QueryRadius(viewCenter, REPLICATION_INTEREST_RADIUS, queryResults.data(), static_cast<int>(queryResults.size()));
+
+	interestEntities.clear();
+	for (int i = 0; i < numResults; i++) {
+		const Entity entity(queryResults[i]);
+		if (!registry.HasComponent<ReplicatedComponent>(entity)) {
+			continue;
+		}
+		const TransformComponent& transform = registry.GetComponent<TransformComponent>(entity);
+		const glm::vec2 offset = transform.position - viewCenter;
+		interestEntities.push_back({ registry.GetComponent<ReplicatedComponent>(entity).networkID, QuantizeTransform(transform), glm::dot(offset, offset) });
+	}
+}
+
+void ReplicationServer::SendSnapshot(Client& client, int tick) {
+	const uint32_t sequence = nextSequence;
+	const ReplicationSnapshot* baseline = nullptr;
+	if (client.hasAck && sequence - client.ackedSequence < static_cast<uint32_t>(REPLICATION_SNAPSHOT_RING_SIZE)) {
+		const ReplicationSnapshot& ackedSnapshot = client.snapshots[client.ackedSequence % REPLICATION_SNAPSHOT_RING_SIZE];
+		if (ackedSnapshot.isValid && ackedSnapshot.sequence == client.ackedSequence) {
+			baseline = &ackedSnapshot;
+		}
+	}
+
+	// What the client will know if it receives the packet
+	ReplicationSnapshot& snapshot = client.snapshots[sequence % REPLICATION_SNAPSHOT_RING_SIZE];
+	snapshot.sequence = sequence;
+	snapshot.tick = tick;
+	snapshot.isValid = true;
+	snapshot.entities.clear();
+
+	BitWriter writer(packet, sizeof(packet));
+	writer.WriteBits(REPLICATION_PROTOCOL_ID, REPLICATION_PROTOCOL_ID_BITS);
+	writer.WriteBits(REPLICATION_PACKET_SNAPSHOT, REPLICATION_PACKET_TYPE_BITS);
+	writer.WriteBits(sequence, 32);
+	writer.WriteBits(static_cast<uint32_t>(tick), 32);
+	writer.WriteBool(baseline != nullptr);
+	if (baseline) {
+		writer.WriteBits(sequence - baseline->sequence, REPLICATION_BASELINE_AGE_BITS);
+	}
+
+	// The entities of the baseline that left the area, in increasing order so only the gaps are written
+	interestIDs.clear();
+	for (const auto& interestEntity : interestEntities) {
+		interestIDs.push_back(interestEntity.networkID);
+	}
+	std::sort(interestIDs.begin(), interestIDs.end());
+	int numRemovals = 0;
+	if (baseline) {
+		for (const auto& entity : baseline->entities) {
+			if (!std::binary_search(interestIDs.begin(), interestIDs.end(), entity.networkID)) {
+				numRemovals++;
+			}
+		}
+	}
+	const int numRemovalsSent = std::min(numRemovals, MAX_REPLICATION_REMOVALS_PER_PACKET);
+	WriteVarUInt(writer, static_cast<uint32_t>(numRemovalsSent));
+	if (baseline) {
+		int numRemovalsWritten = 0;
+		uint32_t previousID = 0;
+		for (const auto& entity : baseline->entities) {
+			if (std::binary_search(interestIDs.begin(), interestIDs.end(), entity.networkID)) {
+				continue;
+			}
+			if (numRemovalsWritten < numRemovalsSent) {
+				WriteVarUInt(writer, entity.networkID - previousID);
+				previousID = entity.networkID;
+				numRemovalsWritten++;
+			}
+			else {
+				snapshot.entities.push_back(entity);
+			}
+		}
+	}
+
+	// The nearest entities first, the last bit of the packet is kept for the end marker
+	const size_t maxBits = MAX_PACKET_SIZE * 8 - 1;
+	std::sort(interestEntities.begin(), interestEntities.end());
+	for (const auto& interestEntity : interestEntities) {
+		const ReplicatedEntity* baselineEntity = baseline ? FindReplicatedEntity(*baseline, interestEntity.networkID) : nullptr;
+		if (baselineEntity && baselineEntity->transform == interestEntity.transform) {
+			snapshot.entities.push_back(*baselineEntity);
+			continue;
+		}
+
+		const size_t startBits = writer.GetNumBits();
+		writer.WriteBool(true);
+		WriteVarUInt(writer, interestEntity.networkID);
+		WriteTransform(writer, baselineEntity ? &baselineEntity->transform : nullptr, interestEntity.transform);
+		if (writer.IsOverflowed() || writer.GetNumBits() > maxBits) {
+			// It waits for the next packet, until then the client keeps what it had
+			writer.Rewind(startBits);
+			if (baselineEntity) {
+				snapshot.entities.push_back(*baselineEntity);
+			}
+			continue;
+		}
+		snapshot.entities.push_back({ interestEntity.networkID, interestEntity.transform });
+	}
+	writer.WriteBool(false);
+	std::sort(snapshot.entities.begin(), snapshot.entities.end(), CompareNetworkIDs);
+
+	if (socket.Send(client.address, packet, writer.GetNumBytes())) {
+		client.numBytesSent += writer.GetNumBytes();
+		client.numPacketsSent++;
+	}
+}
+
+void ReplicationServer::Update(Registry& registry, const SpatialQuerySystem& spatialQuery, int tick) {
+	PROFILE_FUNCTION();
+
+	if (!socket.IsOpen()) {
+		return;
+	}
+	numUpdates++;
+	ReceiveAcks();
+
+	// The clients that stopped answering are forgotten
+	for (size_t i = 0; i < clients.size();) {
+		if (numUpdates - clients[i].lastReceivedUpdate > REPLICATION_CLIENT_TIMEOUT_UPDATES) {
+			Logger::Log("Replication client " + clients[i].address.ToString() + " timed out");
+			clients.erase(clients.begin() + i);
+		}
+		else {
+			i++;
+		}
+	}
+
+	for (auto& client : clients) {
+		FindInterestEntities(registry, spatialQuery, client.viewCenter);
+		SendSnapshot(client, tick);
+	}
+	nextSequence++;
+}
+
+void ReplicationServer::GetInterestSnapshot(Registry& registry, const SpatialQuerySystem& spatialQuery, const glm::vec2& viewCenter, ReplicationSnapshot& snapshot) {
+	FindInterestEntities(registry, spatialQuery, viewCenter);
+	snapshot.entities.clear();
+	for (const auto& interestEntity : interestEntities) {
+		snapshot.entities.push_back({ interestEntity.networkID, interestEntity.transform });
+	}
+	std::sort(snapshot.entities.begin(), snapshot.entities.end(), CompareNetworkIDs);
+	snapshot.isValid = true;
+}
+
+int ReplicationServer::GetNumClients() const {
+	return static_cast<int>(clients.size());
+}
+
+uint64_t ReplicationServer::GetNumBytesSent() const {
+	uint64_t numBytesSent = 0;
+	for (const auto& client : clients) {
+		numBytesSent += client.numBytesSent;
+	}
+	return numBytesSent;
+}
+
+int ReplicationServer::GetNumPacketsSent() const {
+	int numPacketsSent = 0;
+	for (const auto& client : clients) {
+		numPacketsSent += client.numPacketsSent;
+	}
+	return numPacketsSent;
+}
+
+int ReplicationServer::GetNumDroppedPackets() const {
+	return socket.GetNumDroppedPackets();
+}
@@ -0,0 +1,93 @@
+#ifndef REPLICATIONSERVER_H
+#define REPLICATIONSERVER_H
+
+#include "ReplicationFormat.h"
+#include "UdpSocket.h"
+#include "../Collision/Broadphase.h"
+#include "../ECS/ECS.h"
+#include "../Systems/SpatialQuerySystem.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+/// <summary>
+/// Sends the state of the authoritative world to the clients, over UDP. Each server update
+/// sends every client one packet with the replicated entities around its view center, written
+/// as the changes from the last snapshot the client acknowledged: the entities that left its
+/// area, the changed fields of the ones it has and the new ones in full, with the transforms
+/// quantized and bit packed. A lost packet is never sent again, the next one is simply written
+/// against an older snapshot. When the changes don't fit in a packet the nearest entities go
+/// first and the others wait for the next update.
+/// </summary>
+class ReplicationServer {
+private:
+	struct Client {
+		NetworkAddress address;
+		glm::vec2 viewCenter;
+		// Last snapshot the client received, valid if hasAck
+		uint32_t ackedSequence;
+		bool hasAck;
+		int lastReceivedUpdate;
+		// [index = sequence % REPLICATION_SNAPSHOT_RING_SIZE], what the client knows if it received the packet
+		std::vector<ReplicationSnapshot> snapshots;
+		uint64_t numBytesSent;
+		int numPacketsSent;
+	};
+
+	// Entity of the area of interest of a client, and its distance to the view center
+	struct InterestEntity {
+		uint32_t networkID;
+		QuantizedTransform transform;
+		float distanceSquared;
+
+		bool operator < (const InterestEntity& other) const {
+			return distanceSquared < other.distanceSquared;
+		}
+	};
+
+	UdpSocket socket;
+	std::vector<Client> clients;
+	// The view centers of the clients are clamped to it
+	AABB worldBounds;
+	uint32_t nextSequence;
+	int numUpdates;
+
+	// Reused between the clients
+	std::vector<int> queryResults;
+	std::vector<InterestEntity> interestEntities;
+	std::vector<uint32_t> interestIDs;
+	uint8_t packet[MAX_PACKET_SIZE];
+
+	void ReceiveAcks();
+	Client* FindClient(const NetworkAddress& address);
+	void FindInterestEntities(Registry& registry, const SpatialQuerySystem& spatialQuery, const glm::vec2& viewCenter);
+	void SendSnapshot(Client& client, int tick);
+
+public:
+	ReplicationServer();
+
+	// Port 0 lets the system pick a free one
+	bool Start(uint16_t port = 0);
+	void Stop();
+	uint16_t GetPort() const;
+
+	// Drops this share of the packets sent, to test the replication over a bad network
+	void SetSimulatedPacketLoss(float packetLossRate, uint64_t seed);
+
+	// Area the clients can look at, unbounded by default
+	void SetWorldBounds(const AABB& bounds);
+
+	// Reads the acknowledgments, then sends a snapshot of the entities with a ReplicatedComponent to every client.
+	// To be called after the tick, once the spatial queries see the new positions.
+	void Update(Registry& registry, const SpatialQuerySystem& spatialQuery, int tick);
+
+	// The state the server sees around a view center, as the client should see it once it is up to date
+	void GetInterestSnapshot(Registry& registry, const SpatialQuerySystem& spatialQuery, const glm::vec2& viewCenter, ReplicationSnapshot& snapshot);
+
+	int GetNumClients() const;
+	uint64_t GetNumBytesSent() const;
+	int GetNumPacketsSent() const;
+	int GetNumDroppedPackets() const;
+};
+
+#endif // !REPLICATIONSERVER_H
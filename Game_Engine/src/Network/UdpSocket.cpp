@@ -0,0 +1,154 @@
+#include "UdpSocket.h"
+#include "../Logger/Logger.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+typedef SOCKET SocketHandle;
+static const intptr_t INVALID_HANDLE = static_cast<intptr_t>(INVALID_SOCKET);
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+static const intptr_t INVALID_HANDLE = -1;
+#endif
+
+std::string NetworkAddress::ToString() const {
+	return std::to_string((ip >> 24) & 0xFF) + "." + std::to_string((ip >> 16) & 0xFF) + "." + std::to_string((ip >> 8) & 0xFF) + "."
+		+ std::to_string(ip & 0xFF) + ":" + std::to_string(port);
+}
+
+UdpSocket::UdpSocket() {
+#ifdef _WIN32
+	// Winsock counts the startups, each socket starts it and stops it once
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		Logger::Err("Error initializing Winsock");
+	}
+#endif
+	handle = INVALID_HANDLE;
+	port = 0;
+	packetLossRate = 0.0f;
+	numDroppedPackets = 0;
+}
+
+UdpSocket::~UdpSocket() {
+	Close();
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+bool UdpSocket::Open(uint16_t port) {
+	Close();
+
+	handle = static_cast<intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+	if (handle == INVALID_HANDLE) {
+		Logger::Err("Error creating a UDP socket");
+		Close();
+		return false;
+	}
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if (bind(static_cast<SocketHandle>(handle), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+		Logger::Err("Error binding a UDP socket to port " + std::to_string(port));
+		Close();
+		return false;
+	}
+
+	// The game loop polls the socket, it never waits for a packet
+#ifdef _WIN32
+	u_long isNonBlocking = 1;
+	const bool isNonBlockingSet = ioctlsocket(static_cast<SocketHandle>(handle), FIONBIO, &isNonBlocking) == 0;
+#else
+	const bool isNonBlockingSet = fcntl(static_cast<SocketHandle>(handle), F_SETFL, O_NONBLOCK) == 0;
+#endif
+	if (!isNonBlockingSet) {
+		Logger::Err("Error making a UDP socket non-blocking");
+		Close();
+		return false;
+	}
+
+	sockaddr_in boundAddress = {};
+	socklen_t boundAddressSize = sizeof(boundAddress);
+	getsockname(static_cast<SocketHandle>(handle), reinterpret_cast<sockaddr*>(&boundAddress), &boundAddressSize);
+	this->port = ntohs(boundAddress.sin_port);
+	return true;
+}
+
+void UdpSocket::Close() {
+	if (handle != INVALID_HANDLE) {
+#ifdef _WIN32
+		closesocket(static_cast<SocketHandle>(handle));
+#else
+		close(static_cast<SocketHandle>(handle));
+#endif
+		handle = INVALID_HANDLE;
+	}
+	port = 0;
+}
+
+bool UdpSocket::IsOpen() const {
+	return handle != INVALID_HANDLE;
+}
+
+uint16_t UdpSocket::GetPort() const {
+	return port;
+}
+
+bool UdpSocket::Send(const NetworkAddress& address, const uint8_t* data, size_t size) {
+	if (handle == INVALID_HANDLE || size > MAX_PACKET_SIZE) {
+		return false;
+	}
+	if (packetLossRate > 0.0f && lossRandom.NextFloat() < packetLossRate) {
+		numDroppedPackets++;
+		return true;
+	}
+
+	sockaddr_in destination = {};
+	destination.sin_family = AF_INET;
+	destination.sin_addr.s_addr = htonl(address.ip);
+	destination.sin_port = htons(address.port);
+	const int numBytesSent = sendto(static_cast<SocketHandle>(handle), reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+		reinterpret_cast<const sockaddr*>(&destination), sizeof(destination));
+	return numBytesSent == static_cast<int>(size);
+}
+
+int UdpSocket::Receive(uint8_t* data, size_t capacity, NetworkAddress& sender) {
+	if (handle == INVALID_HANDLE) {
+		return -1;
+	}
+
+	sockaddr_in source = {};
+	socklen_t sourceSize = sizeof(source);
+	const int numBytesReceived = recvfrom(static_cast<SocketHandle>(handle), reinterpret_cast<char*>(data), static_cast<int>(capacity), 0,
+		reinterpret_cast<sockaddr*>(&source), &sourceSize);
+	if (numBytesReceived < 0) {
+#ifdef _WIN32
+		const int error = WSAGetLastError();
+		// A packet sent to a closed port comes back as a reset on Windows, it is not an error of this socket
+		return error == WSAEWOULDBLOCK || error == WSAECONNRESET ? 0 : -1;
+#else
+		return errno == EWOULDBLOCK || errno == EAGAIN ? 0 : -1;
+#endif
+	}
+	sender = NetworkAddress(ntohl(source.sin_addr.s_addr), ntohs(source.sin_port));
+	return numBytesReceived;
+}
+
+void UdpSocket::SetSimulatedPacketLoss(float packetLossRate, uint64_t seed) {
+	this->packetLossRate = packetLossRate;
+	lossRandom.Seed(seed);
+}
+
+int UdpSocket::GetNumDroppedPackets() const {
+	return numDroppedPackets;
+}
@@ -0,0 +1,68 @@
+#ifndef UDPSOCKET_H
+#define UDPSOCKET_H
+
+#include "../Utils/Random.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Largest payload sent in one packet, below the usual MTU so the packets are never fragmented
+const size_t MAX_PACKET_SIZE = 1200;
+
+// IPv4 address and port, in host byte order
+struct NetworkAddress {
+	uint32_t ip;
+	uint16_t port;
+
+	NetworkAddress(uint32_t ip = 0, uint16_t port = 0) {
+		this->ip = ip;
+		this->port = port;
+	}
+
+	static NetworkAddress Localhost(uint16_t port) {
+		return NetworkAddress(0x7F000001, port);
+	}
+
+	bool operator == (const NetworkAddress& other) const { return ip == other.ip && port == other.port; }
+	bool operator != (const NetworkAddress& other) const { return !(*this == other); }
+
+	std::string ToString() const;
+};
+
+/// <summary>
+/// Non-blocking UDP socket, on Winsock or on BSD sockets. For the tests it can drop a share of
+/// the packets it sends, so the protocols above it are tried against a lossy network on localhost.
+/// </summary>
+class UdpSocket {
+private:
+	// SOCKET on Windows, a file descriptor elsewhere
+	intptr_t handle;
+	uint16_t port;
+
+	float packetLossRate;
+	Random lossRandom;
+	int numDroppedPackets;
+
+public:
+	UdpSocket();
+	~UdpSocket();
+
+	UdpSocket(const UdpSocket&) = delete;
+	UdpSocket& operator = (const UdpSocket&) = delete;
+
+	// Port 0 lets the system pick a free one, GetPort() tells which
+	bool Open(uint16_t port = 0);
+	void Close();
+	bool IsOpen() const;
+	uint16_t GetPort() const;
+
+	bool Send(const NetworkAddress& address, const uint8_t* data, size_t size);
+	// Size of the packet received, 0 when there is none waiting, -1 on error
+	int Receive(uint8_t* data, size_t capacity, NetworkAddress& sender);
+
+	// Share of the sent packets silently dropped, from 0 to 1
+	void SetSimulatedPacketLoss(float packetLossRate, uint64_t seed);
+	int GetNumDroppedPackets() const;
+};
+
+#endif // !UDPSOCKET_H
@@ -0,0 +1,63 @@
+#include "BodyBatch.h"
+#include "../Profiler/Profiler.h"
+#include "../Utils/SIMD.h"
+
+void BodyBatch::Resize(int numBodies) {
+	const int size = (numBodies + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+	positionsX.resize(size, 0.0f);
+	positionsY.resize(size, 0.0f);
+	velocitiesX.resize(size, 0.0f);
+	velocitiesY.resize(size, 0.0f);
+	accelerationsX.resize(size, 0.0f);
+	accelerationsY.resize(size, 0.0f);
+	dampings.resize(size, 1.0f);
+}
+
+static void IntegrateScalar(BodyBatch& batch, int first, int last, float deltaTime) {
+	for (int i = first; i < last; i++) {
+		batch.velocitiesX[i] = (batch.velocitiesX[i] + batch.accelerationsX[i] * deltaTime) * batch.dampings[i];
+		batch.velocitiesY[i] = (batch.velocitiesY[i] + batch.accelerationsY[i] * deltaTime) * batch.dampings[i];
+		batch.positionsX[i] = batch.positionsX[i] + batch.velocitiesX[i] * deltaTime;
+		batch.positionsY[i] = batch.positionsY[i] + batch.velocitiesY[i] * deltaTime;
+	}
+}
+
+void IntegrateBodies(BodyBatch& batch, int numBodies, float deltaTime, int numSubsteps) {
+	PROFILE_FUNCTION();
+
+	const float substepTime = deltaTime / static_cast<float>(numSubsteps);
+
+#ifdef USE_SSE2
+	const int numBatched = numBodies / SIMD_WIDTH * SIMD_WIDTH;
+	const __m128 dt = _mm_set1_ps(substepTime);
+
+	// every body stays in registers for all of its substeps
+	for (int i = 0; i < numBatched; i += SIMD_WIDTH) {
+		__m128 positionX = _mm_loadu_ps(&batch.positionsX[i]);
+		__m128 positionY = _mm_loadu_ps(&batch.positionsY[i]);
+		__m128 velocityX = _mm_loadu_ps(&batch.velocitiesX[i]);
+		__m128 velocityY = _mm_loadu_ps(&batch.velocitiesY[i]);
+		const __m128 accelerationX = _mm_loadu_ps(&batch.accelerationsX[i]);
+		const __m128 accelerationY = _mm_loadu_ps(&batch.accelerationsY[i]);
+		const __m128 damping = _mm_loadu_ps(&batch.dampings[i]);
+
+		for (int substep = 0; substep < numSubsteps; substep++) {
+			velocityX = _mm_mul_ps(_mm_add_ps(velocityX, _mm_mul_ps(accelerationX, dt)), damping);
+			velocityY = _mm_mul_ps(_mm_add_ps(velocityY, _mm_mul_ps(accelerationY, dt)), damping);
+			positionX = _mm_add_ps(positionX, _mm_mul_ps(velocityX, dt));
+			positionY = _mm_add_ps(positionY, _mm_mul_ps(velocityY, dt));
+		}
+
+		_mm_storeu_ps(&batch.positionsX[i], positionX);
+		_mm_storeu_ps(&batch.positionsY[i], positionY);
+		_mm_storeu_ps(&batch.velocitiesX[i], velocityX);
+		_mm_storeu_ps(&batch.velocitiesY[i], velocityY);
+	}
+#else
+	const int numBatched = 0;
+#endif
+
+	for (int substep = 0; substep < numSubsteps; substep++) {
+		IntegrateScalar(batch, numBatched, numBodies, substepTime);
+	}
+}
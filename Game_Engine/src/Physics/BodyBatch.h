@@ -0,0 +1,26 @@
+#ifndef BODYBATCH_H
+#define BODYBATCH_H
+
+#include <vector>
+
+/// <summary>
+/// Awake rigid bodies copied to structure-of-arrays, one array per value, so the integration
+/// runs over contiguous floats and processes several bodies with each SIMD instruction.
+/// </summary>
+struct BodyBatch {
+	std::vector<float> positionsX, positionsY;
+	std::vector<float> velocitiesX, velocitiesY;
+	// Constant acceleration (gravity) plus force / mass, for the whole tick
+	std::vector<float> accelerationsX, accelerationsY;
+	// Velocity multiplier per substep, 1 / (1 + dt * damping)
+	std::vector<float> dampings;
+
+	// Keeps a multiple of SIMD_WIDTH floats in every array, so the last batch can be loaded whole
+	void Resize(int numBodies);
+};
+
+// Semi-implicit Euler: the velocity is updated first, then the position moves with the new velocity.
+// The operations are the same on the SIMD and scalar paths, so the result is identical on both.
+void IntegrateBodies(BodyBatch& batch, int numBodies, float deltaTime, int numSubsteps);
+
+#endif // !BODYBATCH_H
@@ -0,0 +1,96 @@
+#include "FrameStats.h"
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <cfloat>
+
+// Buckets are narrower around the frame budget (16.7 ms), where stutters are noticed first
+static const float bucketLimits[NUM_FRAME_TIME_BUCKETS] = { 4.0f, 8.0f, 12.0f, 16.7f, 20.0f, 33.3f, 50.0f, 100.0f, FLT_MAX };
+
+FrameStats::FrameStats() {
+	frameMilliseconds.assign(FRAME_STATS_WINDOW, 0.0f);
+	numFrames = 0;
+	std::fill(bucketCounts, bucketCounts + NUM_FRAME_TIME_BUCKETS, 0);
+}
+
+int FrameStats::GetBucket(float milliseconds) {
+	int bucket = 0;
+	while (bucket < NUM_FRAME_TIME_BUCKETS - 1 && milliseconds >= bucketLimits[bucket]) {
+		bucket++;
+	}
+	return bucket;
+}
+
+float FrameStats::GetBucketLimit(int bucket) {
+	return bucketLimits[bucket];
+}
+
+void FrameStats::AddFrame(float milliseconds) {
+	const int index = numFrames % FRAME_STATS_WINDOW;
+
+	// the oldest frame leaves the window, so the histogram stays rolling without a rebuild
+	if (numFrames >= FRAME_STATS_WINDOW) {
+		bucketCounts[GetBucket(frameMilliseconds[index])]--;
+	}
+
+	frameMilliseconds[index] = milliseconds;
+	bucketCounts[GetBucket(milliseconds)]++;
+	numFrames++;
+}
+
+FrameTimeSummary FrameStats::GetSummary() const {
+	FrameTimeSummary summary = {};
+	summary.numFrames = std::min(numFrames, FRAME_STATS_WINDOW);
+	std::copy(bucketCounts, bucketCounts + NUM_FRAME_TIME_BUCKETS, summary.bucketCounts);
+	if (summary.numFrames == 0) {
+		return summary;
+	}
+
+	std::vector<float> sorted(frameMilliseconds.begin(), frameMilliseconds.begin() + summary.numFrames);
+	auto percentile = [&sorted](float fraction) {
+		size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5f);
+		std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+		return sorted[rank];
+	};
+
+	float total = 0.0f;
+	for (float milliseconds : sorted) {
+		total += milliseconds;
+		summary.maximum = std::max(summary.maximum, milliseconds);
+	}
+	summary.average = total / summary.numFrames;
+	summary.p50 = percentile(0.50f);
+	summary.p95 = percentile(0.95f);
+	summary.p99 = percentile(0.99f);
+	return summary;
+}
+
+void FrameStats::DrawPanel() const {
+	if (!ImGui::Begin("Frame times")) {
+		ImGui::End();
+		return;
+	}
+
+	const FrameTimeSummary summary = GetSummary();
+	ImGui::Text("Last %d frames", summary.numFrames);
+	ImGui::Text("avg %.2f ms  p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms",
+		summary.average, summary.p50, summary.p95, summary.p99, summary.maximum);
+
+	float bucketValues[NUM_FRAME_TIME_BUCKETS];
+	for (int bucket = 0; bucket < NUM_FRAME_TIME_BUCKETS; bucket++) {
+		bucketValues[bucket] = static_cast<float>(summary.bucketCounts[bucket]);
+	}
+	ImGui::PlotHistogram("##buckets", bucketValues, NUM_FRAME_TIME_BUCKETS, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 80));
+
+	float lowerLimit = 0.0f;
+	for (int bucket = 0; bucket < NUM_FRAME_TIME_BUCKETS; bucket++) {
+		if (bucket < NUM_FRAME_TIME_BUCKETS - 1) {
+			ImGui::Text("%6.1f - %6.1f ms: %d", lowerLimit, bucketLimits[bucket], summary.bucketCounts[bucket]);
+		}
+		else {
+			ImGui::Text("%6.1f ms and more: %d", lowerLimit, summary.bucketCounts[bucket]);
+		}
+		lowerLimit = bucketLimits[bucket];
+	}
+
+	ImGui::End();
+}
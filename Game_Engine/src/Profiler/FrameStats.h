@@ -0,0 +1,44 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include <vector>
+
+// Number of frames the statistics are computed on (10 seconds at 60 FPS)
+const int FRAME_STATS_WINDOW = 600;
+const int NUM_FRAME_TIME_BUCKETS = 9;
+
+struct FrameTimeSummary {
+	int numFrames;
+	float average;
+	float p50;
+	float p95;
+	float p99;
+	float maximum;
+	int bucketCounts[NUM_FRAME_TIME_BUCKETS];
+};
+
+/// <summary>
+/// Keeps the duration of the last frames, to compute their percentiles and a histogram
+/// </summary>
+class FrameStats {
+private:
+	// Ring buffer of frame durations [index = frame number % FRAME_STATS_WINDOW]
+	std::vector<float> frameMilliseconds;
+	int numFrames;
+	int bucketCounts[NUM_FRAME_TIME_BUCKETS];
+
+	static int GetBucket(float milliseconds);
+
+public:
+	FrameStats();
+
+	void AddFrame(float milliseconds);
+	FrameTimeSummary GetSummary() const;
+
+	// Upper limit (exclusive) of a histogram bucket, the last one has no limit
+	static float GetBucketLimit(int bucket);
+
+	void DrawPanel() const;
+};
+
+#endif // !FRAMESTATS_H
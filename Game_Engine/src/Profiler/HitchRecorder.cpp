@@ -0,0 +1,81 @@
+#include "HitchRecorder.h"
+#include "../ECS/ECS.h"
+#include "../Logger/Logger.h"
+#include <filesystem>
+
+HitchRecorder::HitchRecorder(double thresholdMilliseconds, const std::string& folderPath) {
+	this->thresholdMilliseconds = thresholdMilliseconds;
+	this->folderPath = folderPath;
+	this->isCapturePending = false;
+	this->hitchMilliseconds = 0.0;
+	this->lastCaptureNanoseconds = 0;
+	this->numCaptures = 0;
+}
+
+HitchRecorder::~HitchRecorder() {
+	if (writerThread.joinable()) {
+		writerThread.join();
+	}
+}
+
+int HitchRecorder::GetNumCaptures() const {
+	return numCaptures;
+}
+
+void HitchRecorder::AddFrame(double milliseconds) {
+	if (milliseconds < thresholdMilliseconds || isCapturePending) {
+		return;
+	}
+
+	const int64_t now = Profiler::Now();
+	if (numCaptures > 0 && now - lastCaptureNanoseconds < MILLISECS_HITCH_COOLDOWN * 1000000LL) {
+		return;
+	}
+
+	isCapturePending = true;
+	hitchMilliseconds = milliseconds;
+}
+
+void HitchRecorder::CaptureIfPending(const Registry& registry) {
+	if (!isCapturePending) {
+		return;
+	}
+	isCapturePending = false;
+	lastCaptureNanoseconds = Profiler::Now();
+	numCaptures++;
+
+	// Copy the frames now, the profiler history keeps moving while the file is written
+	std::vector<FrameProfile> frames;
+	for (const auto* frame : Profiler::GetFrameHistory(HITCH_CAPTURE_FRAMES)) {
+		frames.push_back(*frame);
+	}
+
+	std::map<std::string, std::string> otherData;
+	otherData["hitchMilliseconds"] = std::to_string(hitchMilliseconds);
+	otherData["thresholdMilliseconds"] = std::to_string(thresholdMilliseconds);
+	otherData["numEntities"] = std::to_string(registry.GetNumEntities());
+	otherData["numSystems"] = std::to_string(registry.GetNumSystems());
+	for (const auto& systemEntityCount : registry.GetSystemEntityCounts()) {
+		otherData["entities in " + systemEntityCount.first] = std::to_string(systemEntityCount.second);
+	}
+
+	const int frameNumber = frames.empty() ? 0 : frames.back().frameNumber;
+	const std::string filePath = folderPath + "/hitch_" + std::to_string(frameNumber) + ".json";
+
+	Logger::Log("Hitch of " + std::to_string(hitchMilliseconds) + " ms detected, writing " + filePath);
+
+	if (writerThread.joinable()) {
+		writerThread.join();
+	}
+	std::error_code error;
+	std::filesystem::create_directories(folderPath, error);
+	writerThread = std::thread(&HitchRecorder::WriteCapture, std::move(frames), filePath, std::move(otherData));
+}
+
+void HitchRecorder::WriteCapture(std::vector<FrameProfile> frames, std::string filePath, std::map<std::string, std::string> otherData) {
+	std::vector<const FrameProfile*> frameHistory;
+	for (const auto& frame : frames) {
+		frameHistory.push_back(&frame);
+	}
+	Profiler::WriteChromeTrace(frameHistory, filePath, otherData);
+}
@@ -0,0 +1,48 @@
+#ifndef HITCHRECORDER_H
+#define HITCHRECORDER_H
+
+#include "Profiler.h"
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Registry;
+
+// Number of frames of profiler markers written for each hitch
+const int HITCH_CAPTURE_FRAMES = 120;
+
+// Minimum time between two captures, so a long stall doesn't flood the disk
+const int MILLISECS_HITCH_COOLDOWN = 5000;
+
+/// <summary>
+/// When a frame takes longer than the threshold, the hitch recorder writes the last frames
+/// of profiler markers together with the entity/system counts to a Chrome trace file.
+/// The file is written on a background thread so the capture doesn't cause another hitch.
+/// </summary>
+class HitchRecorder {
+private:
+	double thresholdMilliseconds;
+	std::string folderPath;
+
+	bool isCapturePending;
+	double hitchMilliseconds;
+	int64_t lastCaptureNanoseconds;
+	int numCaptures;
+
+	std::thread writerThread;
+
+	static void WriteCapture(std::vector<FrameProfile> frames, std::string filePath, std::map<std::string, std::string> otherData);
+
+public:
+	HitchRecorder(double thresholdMilliseconds, const std::string& folderPath = "./hitches");
+	~HitchRecorder();
+
+	// Checks the duration of the frame, the capture happens once the profiler closed the frame
+	void AddFrame(double milliseconds);
+	void CaptureIfPending(const Registry& registry);
+
+	int GetNumCaptures() const;
+};
+
+#endif // !HITCHRECORDER_H
@@ -0,0 +1,315 @@
+#include "Profiler.h"
+#include "../Logger/Logger.h"
+#include <imgui/imgui.h>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+std::mutex Profiler::threadsMutex;
+std::vector<std::unique_ptr<ThreadProfile>> Profiler::threads;
+
+int Profiler::frameNumber = 0;
+int64_t Profiler::frameStartNanoseconds = 0;
+bool Profiler::isPaused = false;
+
+std::vector<FrameProfile> Profiler::frames(PROFILER_HISTORY_SIZE);
+std::vector<float> Profiler::frameMilliseconds(PROFILER_HISTORY_SIZE, 0.0f);
+std::map<std::string, TimingHistory> Profiler::timings;
+std::unordered_map<const char*, TimingHistory*> Profiler::timingsByName;
+
+static const auto profilerEpoch = std::chrono::steady_clock::now();
+
+int64_t Profiler::Now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profilerEpoch).count();
+}
+
+ThreadProfile& Profiler::GetThreadProfile() {
+	// The profiler owns the buffers, so the markers of a thread that exits are still collected
+	thread_local ThreadProfile* threadProfile = nullptr;
+	if (!threadProfile) {
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		threads.push_back(std::make_unique<ThreadProfile>());
+		threadProfile = threads.back().get();
+		threadProfile->threadIndex = static_cast<int>(threads.size()) - 1;
+		threadProfile->threadName = "Thread " + std::to_string(threadProfile->threadIndex);
+		threadProfile->depth = 0;
+	}
+	return *threadProfile;
+}
+
+void Profiler::SetThreadName(const std::string& threadName) {
+	ThreadProfile& threadProfile = GetThreadProfile();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	threadProfile.threadName = threadName;
+}
+
+std::string Profiler::GetThreadName(int threadIndex) {
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	if (threadIndex < 0 || threadIndex >= static_cast<int>(threads.size())) {
+		return "Unknown";
+	}
+	return threads[threadIndex]->threadName;
+}
+
+void Profiler::AddMarker(ThreadProfile& threadProfile, const char* name, int64_t startNanoseconds, int64_t endNanoseconds) {
+	// Only the main thread takes this lock too, once per frame
+	std::lock_guard<std::mutex> lock(threadProfile.markersMutex);
+	threadProfile.markers.push_back({ name, startNanoseconds, endNanoseconds, threadProfile.depth, threadProfile.threadIndex });
+}
+
+void Profiler::BeginFrame() {
+	frameStartNanoseconds = Now();
+}
+
+void Profiler::EndFrame() {
+	const int64_t frameEndNanoseconds = Now();
+	const int historyIndex = frameNumber % PROFILER_HISTORY_SIZE;
+
+	// When paused the history is frozen, but the thread buffers still need to be emptied
+	FrameProfile discardedFrame;
+	FrameProfile& frame = isPaused ? discardedFrame : frames[historyIndex];
+	frame.frameNumber = frameNumber;
+	frame.startNanoseconds = frameStartNanoseconds;
+	frame.endNanoseconds = frameEndNanoseconds;
+	frame.markers.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (auto& thread : threads) {
+			std::lock_guard<std::mutex> markersLock(thread->markersMutex);
+			frame.markers.insert(frame.markers.end(), thread->markers.begin(), thread->markers.end());
+			thread->markers.clear();
+		}
+	}
+
+	if (isPaused) {
+		return;
+	}
+
+	// Markers are added when they end, sort them so parents come before their children
+	std::sort(frame.markers.begin(), frame.markers.end(), [](const ProfileMarker& a, const ProfileMarker& b) {
+		if (a.threadIndex != b.threadIndex) {
+			return a.threadIndex < b.threadIndex;
+		}
+		if (a.startNanoseconds != b.startNanoseconds) {
+			return a.startNanoseconds < b.startNanoseconds;
+		}
+		return a.depth < b.depth;
+	});
+
+	frameMilliseconds[historyIndex] = (frameEndNanoseconds - frameStartNanoseconds) / 1000000.0f;
+	RecordTimings(frame);
+
+	frameNumber++;
+}
+
+void Profiler::RecordTimings(const FrameProfile& frame) {
+	const int historyIndex = frame.frameNumber % PROFILER_HISTORY_SIZE;
+	for (auto& timing : timings) {
+		timing.second.milliseconds[historyIndex] = 0.0f;
+	}
+
+	for (const auto& marker : frame.markers) {
+		TimingHistory*& timing = timingsByName[marker.name];
+		if (!timing) {
+			// The same name can come from different string literals, so group them by content
+			timing = &timings[marker.name];
+			if (timing->milliseconds.empty()) {
+				timing->name = marker.name;
+				timing->milliseconds.assign(PROFILER_HISTORY_SIZE, 0.0f);
+			}
+		}
+		timing->milliseconds[historyIndex] += (marker.endNanoseconds - marker.startNanoseconds) / 1000000.0f;
+	}
+}
+
+std::vector<const FrameProfile*> Profiler::GetFrameHistory(int maxFrames) {
+	const int numFrames = std::min({ maxFrames, frameNumber, PROFILER_HISTORY_SIZE });
+	std::vector<const FrameProfile*> frameHistory;
+	frameHistory.reserve(numFrames);
+	for (int number = frameNumber - numFrames; number < frameNumber; number++) {
+		frameHistory.push_back(&frames[number % PROFILER_HISTORY_SIZE]);
+	}
+	return frameHistory;
+}
+
+void Profiler::DrawPanel() {
+	if (!ImGui::Begin("Profiler")) {
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Checkbox("Pause", &isPaused);
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome trace")) {
+		ExportChromeTrace("profile_trace.json");
+	}
+
+	if (frameNumber == 0) {
+		ImGui::End();
+		return;
+	}
+
+	const int lastIndex = (frameNumber - 1) % PROFILER_HISTORY_SIZE;
+	const int plotOffset = frameNumber % PROFILER_HISTORY_SIZE;
+	const int numValues = std::min(frameNumber, PROFILER_HISTORY_SIZE);
+
+	ImGui::Text("Frame %d: %.3f ms", frames[lastIndex].frameNumber, frameMilliseconds[lastIndex]);
+	ImGui::PlotLines("##frame", frameMilliseconds.data(), numValues, numValues < PROFILER_HISTORY_SIZE ? 0 : plotOffset, nullptr, 0.0f, 33.3f, ImVec2(0, 60));
+
+	if (ImGui::CollapsingHeader("Timings", ImGuiTreeNodeFlags_DefaultOpen)) {
+		for (const auto& timing : timings) {
+			const std::vector<float>& values = timing.second.milliseconds;
+			float total = 0.0f;
+			float maximum = 0.0f;
+			for (int i = 0; i < numValues; i++) {
+				total += values[i];
+				maximum = std::max(maximum, values[i]);
+			}
+
+			ImGui::Text("%-32s %7.3f ms  avg %7.3f  max %7.3f", timing.first.c_str(), values[lastIndex], total / numValues, maximum);
+			ImGui::PushID(timing.first.c_str());
+			ImGui::PlotLines("", values.data(), numValues, numValues < PROFILER_HISTORY_SIZE ? 0 : plotOffset, nullptr, 0.0f, FLT_MAX, ImVec2(0, 24));
+			ImGui::PopID();
+		}
+	}
+
+	if (ImGui::CollapsingHeader("Flame graph", ImGuiTreeNodeFlags_DefaultOpen)) {
+		DrawFlameGraph(frames[lastIndex]);
+	}
+
+	ImGui::End();
+}
+
+void Profiler::DrawFlameGraph(const FrameProfile& frame) {
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	const float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+	const double frameDuration = static_cast<double>(std::max<int64_t>(frame.endNanoseconds - frame.startNanoseconds, 1));
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	float laneTop = origin.y;
+
+	// One lane per thread, one row per depth
+	size_t first = 0;
+	while (first < frame.markers.size()) {
+		const int threadIndex = frame.markers[first].threadIndex;
+		size_t last = first;
+		int maxDepth = 0;
+		while (last < frame.markers.size() && frame.markers[last].threadIndex == threadIndex) {
+			maxDepth = std::max(maxDepth, frame.markers[last].depth);
+			last++;
+		}
+
+		drawList->AddText(ImVec2(origin.x, laneTop), IM_COL32(200, 200, 200, 255), GetThreadName(threadIndex).c_str());
+		laneTop += rowHeight;
+
+		for (size_t i = first; i < last; i++) {
+			const ProfileMarker& marker = frame.markers[i];
+			const float x0 = origin.x + static_cast<float>((marker.startNanoseconds - frame.startNanoseconds) / frameDuration * width);
+			const float x1 = origin.x + static_cast<float>((marker.endNanoseconds - frame.startNanoseconds) / frameDuration * width);
+			const float y0 = laneTop + marker.depth * rowHeight;
+			const ImVec2 minimum(std::max(x0, origin.x), y0);
+			const ImVec2 maximum(std::max(std::min(x1, origin.x + width), minimum.x + 1.0f), y0 + rowHeight - 1.0f);
+
+			// The color only depends on the name, so a marker keeps its color between frames
+			const float hue = (std::hash<std::string>()(marker.name) % 360) / 360.0f;
+			drawList->AddRectFilled(minimum, maximum, ImColor::HSV(hue, 0.5f, 0.7f));
+
+			const char* label = marker.name;
+			if (ImGui::CalcTextSize(label).x < maximum.x - minimum.x - 4.0f) {
+				drawList->AddText(ImVec2(minimum.x + 2.0f, minimum.y + 2.0f), IM_COL32(0, 0, 0, 255), label);
+			}
+
+			if (ImGui::IsMouseHoveringRect(minimum, maximum)) {
+				ImGui::SetTooltip("%s\n%.3f ms", marker.name, (marker.endNanoseconds - marker.startNanoseconds) / 1000000.0);
+			}
+		}
+
+		laneTop += (maxDepth + 1) * rowHeight + 4.0f;
+		first = last;
+	}
+
+	ImGui::Dummy(ImVec2(width, laneTop - origin.y));
+}
+
+// Escapes the characters that are not valid inside a JSON string
+static std::string JsonEscape(const std::string& text) {
+	std::string escaped;
+	escaped.reserve(text.size());
+	for (char ch : text) {
+		if (ch == '"' || ch == '\\') {
+			escaped += '\\';
+			escaped += ch;
+		}
+		else if (static_cast<unsigned char>(ch) < 0x20) {
+			char code[8];
+			std::snprintf(code, sizeof(code), "\\u%04x", ch);
+			escaped += code;
+		}
+		else {
+			escaped += ch;
+		}
+	}
+	return escaped;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filePath) {
+	return WriteChromeTrace(GetFrameHistory(), filePath);
+}
+
+bool Profiler::WriteChromeTrace(const std::vector<const FrameProfile*>& frameHistory, const std::string& filePath, const std::map<std::string, std::string>& otherData) {
+	std::ofstream file(filePath);
+	if (!file) {
+		Logger::Err("Could not write the profiler trace to " + filePath);
+		return false;
+	}
+
+	// Chrome trace event format, timestamps in microseconds (load it in chrome://tracing or Perfetto)
+	file << std::fixed;
+	file.precision(3);
+	file << "{\"traceEvents\":[";
+	bool isFirstEvent = true;
+
+	std::vector<int> threadIndices;
+	for (const auto* frame : frameHistory) {
+		for (const auto& marker : frame->markers) {
+			if (std::find(threadIndices.begin(), threadIndices.end(), marker.threadIndex) == threadIndices.end()) {
+				threadIndices.push_back(marker.threadIndex);
+			}
+		}
+	}
+	for (int threadIndex : threadIndices) {
+		file << (isFirstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadIndex
+			<< ",\"args\":{\"name\":\"" << JsonEscape(GetThreadName(threadIndex)) << "\"}}";
+		isFirstEvent = false;
+	}
+
+	for (const auto* frame : frameHistory) {
+		file << (isFirstEvent ? "" : ",") << "\n{\"name\":\"Frame " << frame->frameNumber << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":-1"
+			<< ",\"ts\":" << frame->startNanoseconds / 1000.0 << ",\"dur\":" << (frame->endNanoseconds - frame->startNanoseconds) / 1000.0 << "}";
+		isFirstEvent = false;
+
+		for (const auto& marker : frame->markers) {
+			file << ",\n{\"name\":\"" << JsonEscape(marker.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << marker.threadIndex
+				<< ",\"ts\":" << marker.startNanoseconds / 1000.0 << ",\"dur\":" << (marker.endNanoseconds - marker.startNanoseconds) / 1000.0 << "}";
+		}
+	}
+	file << "\n]";
+
+	if (!otherData.empty()) {
+		file << ",\n\"otherData\":{";
+		bool isFirstEntry = true;
+		for (const auto& entry : otherData) {
+			file << (isFirstEntry ? "" : ",") << "\n\"" << JsonEscape(entry.first) << "\":\"" << JsonEscape(entry.second) << "\"";
+			isFirstEntry = false;
+		}
+		file << "\n}";
+	}
+	file << "}\n";
+
+	Logger::Log("Profiler trace exported to " + filePath);
+	return true;
+}
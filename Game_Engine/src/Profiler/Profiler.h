@@ -0,0 +1,126 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Number of frames kept in the profiler history
+const int PROFILER_HISTORY_SIZE = 240;
+
+/// <summary>
+/// A named section of code that was timed, in nanoseconds since the profiler started
+/// </summary>
+struct ProfileMarker {
+	const char* name;
+	int64_t startNanoseconds;
+	int64_t endNanoseconds;
+	int depth;
+	int threadIndex;
+};
+
+/// <summary>
+/// Every marker that was completed during one frame, on any thread
+/// </summary>
+struct FrameProfile {
+	int frameNumber;
+	int64_t startNanoseconds;
+	int64_t endNanoseconds;
+	std::vector<ProfileMarker> markers;
+};
+
+/// <summary>
+/// The markers of a thread are recorded in its own buffer, so threads never compete
+/// with each other; the main thread collects all of them at the end of the frame.
+/// </summary>
+struct ThreadProfile {
+	int threadIndex;
+	std::string threadName;
+	int depth;
+	std::mutex markersMutex;
+	std::vector<ProfileMarker> markers;
+};
+
+/// <summary>
+/// Total time spent per frame in markers with the same name, for the history graphs
+/// </summary>
+struct TimingHistory {
+	std::string name;
+	std::vector<float> milliseconds;
+};
+
+class Profiler {
+private:
+	static std::mutex threadsMutex;
+	static std::vector<std::unique_ptr<ThreadProfile>> threads;
+
+	static int frameNumber;
+	static int64_t frameStartNanoseconds;
+	static bool isPaused;
+
+	// Ring buffers of the last frames [index = frame number % PROFILER_HISTORY_SIZE]
+	static std::vector<FrameProfile> frames;
+	static std::vector<float> frameMilliseconds;
+	static std::map<std::string, TimingHistory> timings;
+	static std::unordered_map<const char*, TimingHistory*> timingsByName;
+
+	static void RecordTimings(const FrameProfile& frame);
+	static void DrawFlameGraph(const FrameProfile& frame);
+
+public:
+	static int64_t Now();
+	static ThreadProfile& GetThreadProfile();
+	static void SetThreadName(const std::string& threadName);
+	static void AddMarker(ThreadProfile& threadProfile, const char* name, int64_t startNanoseconds, int64_t endNanoseconds);
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	// Returns the frames still in the history, from the oldest to the newest
+	static std::vector<const FrameProfile*> GetFrameHistory(int maxFrames = PROFILER_HISTORY_SIZE);
+	static std::string GetThreadName(int threadIndex);
+
+	static void DrawPanel();
+	static bool ExportChromeTrace(const std::string& filePath);
+	// The otherData entries are written as strings in the "otherData" object of the trace
+	static bool WriteChromeTrace(const std::vector<const FrameProfile*>& frameHistory, const std::string& filePath, const std::map<std::string, std::string>& otherData = {});
+};
+
+/// <summary>
+/// Times the enclosing scope and records it as a marker of the current thread
+/// </summary>
+class ProfileScope {
+private:
+	const char* name;
+	int64_t startNanoseconds;
+	ThreadProfile& threadProfile;
+
+public:
+	ProfileScope(const char* name) : name(name), threadProfile(Profiler::GetThreadProfile()) {
+		threadProfile.depth++;
+		startNanoseconds = Profiler::Now();
+	}
+
+	~ProfileScope() {
+		threadProfile.depth--;
+		Profiler::AddMarker(threadProfile, name, startNanoseconds, Profiler::Now());
+	}
+};
+
+// The markers are compiled out entirely unless ENABLE_PROFILER is defined.
+// Marker names must outlive the profiler history (string literals or __FUNCTION__).
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
+
+#endif // !PROFILER_H
@@ -0,0 +1,43 @@
+#ifndef REPLAYFORMAT_H
+#define REPLAYFORMAT_H
+
+#include "../Input/InputManager.h"
+#include <cstddef>
+#include <cstdint>
+
+// A replay file starts with a ReplayHeader, followed by one record per physics tick.
+// Each record starts with a byte of REPLAY_RECORD_* flags telling which values follow it,
+// so the ticks where nothing changed take a single byte. Values are stored in native (little) endian.
+const char REPLAY_MAGIC[4] = { 'R', 'P', 'L', 'Y' };
+const uint32_t REPLAY_VERSION = 5;
+
+// The tick is the first one of a frame, the game updated the registry before it
+const uint8_t REPLAY_RECORD_NEW_FRAME = 1 << 0;
+// Followed by the down, pressed and released action bits (3 x uint32)
+const uint8_t REPLAY_RECORD_ACTIONS = 1 << 1;
+// Followed by the mouse position (2 x int32)
+const uint8_t REPLAY_RECORD_MOUSE = 1 << 2;
+// Preceded by a keyframe: its size (uint32) and the snapshot of the simulation before the tick.
+// A keyframe record always stores the whole input too, so the reading can start there.
+const uint8_t REPLAY_RECORD_KEYFRAME = 1 << 3;
+// Last record of the file, a file without it was cut short
+const uint8_t REPLAY_RECORD_END = 1 << 7;
+
+struct ReplayHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t ticksPerSecond;
+	int32_t level;
+	// Seed of the simulation's Random, everything else is derived from the inputs
+	uint64_t seed;
+};
+
+struct ReplayTick {
+	bool isNewFrame;
+	InputSnapshot input;
+	// Inside the ReplayPlayer's data, nullptr when the tick has no keyframe
+	const uint8_t* keyframe;
+	size_t keyframeSize;
+};
+
+#endif // !REPLAYFORMAT_H
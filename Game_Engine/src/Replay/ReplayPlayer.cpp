@@ -0,0 +1,162 @@
+#include "ReplayPlayer.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+ReplayPlayer::ReplayPlayer() {
+	readPosition = 0;
+	std::memset(&header, 0, sizeof(header));
+	nextTick = 0;
+	numTicks = 0;
+}
+
+template <typename T>
+bool ReplayPlayer::Read(T& value) {
+	if (readPosition + sizeof(T) > data.size()) {
+		return false;
+	}
+	std::memcpy(&value, data.data() + readPosition, sizeof(T));
+	readPosition += sizeof(T);
+	return true;
+}
+
+bool ReplayPlayer::Open(const std::string& filePath) {
+	data.clear();
+	keyframes.clear();
+	readPosition = 0;
+	nextTick = 0;
+	numTicks = 0;
+	previousInput = InputSnapshot();
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file) {
+		Logger::Err("Can't open the replay file " + filePath);
+		return false;
+	}
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	if (!Read(header) || std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0) {
+		Logger::Err(filePath + " is not a replay file");
+		data.clear();
+		return false;
+	}
+	if (header.version != REPLAY_VERSION) {
+		Logger::Err(filePath + " is a replay of version " + std::to_string(header.version) + ", this build reads version " + std::to_string(REPLAY_VERSION));
+		data.clear();
+		return false;
+	}
+
+	// One pass over the records to find the keyframes, their snapshots are skipped
+	const size_t firstRecordPosition = readPosition;
+	ReplayTick tick;
+	for (;;) {
+		const size_t recordPosition = readPosition;
+		uint8_t flags = 0;
+		if (!ReadRecord(tick, flags)) {
+			Logger::Err("The replay is cut short after " + std::to_string(numTicks) + " ticks");
+			break;
+		}
+		if (flags & REPLAY_RECORD_END) {
+			break;
+		}
+		if (flags & REPLAY_RECORD_KEYFRAME) {
+			keyframes.push_back({ numTicks, recordPosition });
+		}
+		numTicks++;
+	}
+
+	readPosition = firstRecordPosition;
+	previousInput = InputSnapshot();
+	return true;
+}
+
+bool ReplayPlayer::IsOpen() const {
+	return !data.empty();
+}
+
+int ReplayPlayer::GetTicksPerSecond() const {
+	return static_cast<int>(header.ticksPerSecond);
+}
+
+int ReplayPlayer::GetLevel() const {
+	return header.level;
+}
+
+uint64_t ReplayPlayer::GetSeed() const {
+	return header.seed;
+}
+
+int ReplayPlayer::GetNumTicks() const {
+	return numTicks;
+}
+
+bool ReplayPlayer::ReadRecord(ReplayTick& tick, uint8_t& flags) {
+	if (!Read(flags)) {
+		return false;
+	}
+	if (flags & REPLAY_RECORD_END) {
+		return true;
+	}
+
+	tick.keyframe = nullptr;
+	tick.keyframeSize = 0;
+	if (flags & REPLAY_RECORD_KEYFRAME) {
+		uint32_t keyframeSize = 0;
+		if (!Read(keyframeSize) || keyframeSize > data.size() - readPosition) {
+			return false;
+		}
+		tick.keyframe = data.data() + readPosition;
+		tick.keyframeSize = keyframeSize;
+		readPosition += keyframeSize;
+		previousInput = InputSnapshot();
+	}
+
+	InputSnapshot input = previousInput;
+	input.actionsPressed = 0;
+	input.actionsReleased = 0;
+	if (flags & REPLAY_RECORD_ACTIONS) {
+		if (!Read(input.actionsDown) || !Read(input.actionsPressed) || !Read(input.actionsReleased)) {
+			return false;
+		}
+	}
+	if (flags & REPLAY_RECORD_MOUSE) {
+		int32_t mouseX = 0;
+		int32_t mouseY = 0;
+		if (!Read(mouseX) || !Read(mouseY)) {
+			return false;
+		}
+		input.mousePosition = glm::ivec2(mouseX, mouseY);
+	}
+
+	tick.isNewFrame = (flags & REPLAY_RECORD_NEW_FRAME) != 0;
+	tick.input = input;
+	previousInput = input;
+	return true;
+}
+
+bool ReplayPlayer::ReadTick(ReplayTick& tick) {
+	// the records after numTicks are the end marker or a damaged tick, Open() already told
+	uint8_t flags = 0;
+	if (nextTick >= numTicks || !ReadRecord(tick, flags)) {
+		return false;
+	}
+	tick.input.tick = nextTick;
+	nextTick++;
+	return true;
+}
+
+int ReplayPlayer::SeekToKeyframe(int tick) {
+	// the keyframes are in tick order, find the last one that isn't after the tick
+	auto keyframe = std::upper_bound(keyframes.begin(), keyframes.end(), tick, [](int tick, const KeyframeEntry& entry) { return tick < entry.tick; });
+	if (keyframe == keyframes.begin()) {
+		return -1;
+	}
+	--keyframe;
+
+	readPosition = keyframe->recordPosition;
+	nextTick = keyframe->tick;
+	previousInput = InputSnapshot();
+	return keyframe->tick;
+}
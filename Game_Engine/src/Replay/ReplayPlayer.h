@@ -0,0 +1,53 @@
+#ifndef REPLAYPLAYER_H
+#define REPLAYPLAYER_H
+
+#include "ReplayFormat.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Reads back the ticks of a replay file. The whole file is loaded at once, a minute of inputs
+/// is a few kilobytes, so reading a tick never waits for the disk. Opening the file indexes its
+/// keyframes, so seeking jumps to the last one before the tick instead of reading from the start.
+/// </summary>
+class ReplayPlayer {
+private:
+	struct KeyframeEntry {
+		int tick;
+		size_t recordPosition;
+	};
+
+	std::vector<uint8_t> data;
+	size_t readPosition;
+	ReplayHeader header;
+	InputSnapshot previousInput;
+	int nextTick;
+	int numTicks;
+	std::vector<KeyframeEntry> keyframes;
+
+	template <typename T>
+	bool Read(T& value);
+	// Returns false when the record is cut short
+	bool ReadRecord(ReplayTick& tick, uint8_t& flags);
+
+public:
+	ReplayPlayer();
+
+	bool Open(const std::string& filePath);
+	bool IsOpen() const;
+
+	int GetTicksPerSecond() const;
+	int GetLevel() const;
+	uint64_t GetSeed() const;
+	int GetNumTicks() const;
+
+	// Returns false after the last tick, or if the file is cut short
+	bool ReadTick(ReplayTick& tick);
+
+	// The next ReadTick() returns the last keyframe at or before the tick. Returns the tick of
+	// that keyframe, or -1 if there is none
+	int SeekToKeyframe(int tick);
+};
+
+#endif // !REPLAYPLAYER_H
@@ -0,0 +1,104 @@
+#include "ReplayRecorder.h"
+#include "../Logger/Logger.h"
+#include <cstring>
+
+ReplayRecorder::ReplayRecorder() {
+	isNewFrame = false;
+	numTicks = 0;
+}
+
+ReplayRecorder::~ReplayRecorder() {
+	Close();
+}
+
+bool ReplayRecorder::Open(const std::string& filePath, int ticksPerSecond, int level, uint64_t seed) {
+	Close();
+
+	file.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		Logger::Err("Can't open the replay file " + filePath + " for writing");
+		return false;
+	}
+	this->filePath = filePath;
+
+	ReplayHeader header;
+	std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+	header.version = REPLAY_VERSION;
+	header.ticksPerSecond = static_cast<uint32_t>(ticksPerSecond);
+	header.level = level;
+	header.seed = seed;
+	Write(header);
+
+	isNewFrame = false;
+	previousInput = InputSnapshot();
+	numTicks = 0;
+	Logger::Log("Recording the inputs to " + filePath);
+	return true;
+}
+
+void ReplayRecorder::Close() {
+	if (!file.is_open()) {
+		return;
+	}
+	Write(REPLAY_RECORD_END);
+	file.close();
+	Logger::Log("Recorded " + std::to_string(numTicks) + " ticks to " + filePath);
+}
+
+bool ReplayRecorder::IsOpen() const {
+	return file.is_open();
+}
+
+void ReplayRecorder::BeginFrame() {
+	isNewFrame = true;
+}
+
+void ReplayRecorder::WriteTick(const InputSnapshot& input, const std::vector<uint8_t>* keyframe) {
+	if (!file.is_open()) {
+		return;
+	}
+
+	// A keyframe doesn't depend on the previous records, its input is written whole
+	if (keyframe) {
+		previousInput = InputSnapshot();
+	}
+
+	uint8_t flags = 0;
+	if (isNewFrame) {
+		flags |= REPLAY_RECORD_NEW_FRAME;
+	}
+	if (keyframe) {
+		flags |= REPLAY_RECORD_KEYFRAME;
+	}
+	const bool hasActions = keyframe || input.actionsDown != previousInput.actionsDown || input.actionsPressed != 0 || input.actionsReleased != 0;
+	if (hasActions) {
+		flags |= REPLAY_RECORD_ACTIONS;
+	}
+	const bool hasMouse = keyframe || input.mousePosition != previousInput.mousePosition;
+	if (hasMouse) {
+		flags |= REPLAY_RECORD_MOUSE;
+	}
+
+	Write(flags);
+	if (keyframe) {
+		Write(static_cast<uint32_t>(keyframe->size()));
+		file.write(reinterpret_cast<const char*>(keyframe->data()), keyframe->size());
+	}
+	if (hasActions) {
+		Write(input.actionsDown);
+		Write(input.actionsPressed);
+		Write(input.actionsReleased);
+	}
+	if (hasMouse) {
+		Write(static_cast<int32_t>(input.mousePosition.x));
+		Write(static_cast<int32_t>(input.mousePosition.y));
+	}
+
+	isNewFrame = false;
+	previousInput = input;
+	numTicks++;
+}
+
+int ReplayRecorder::GetNumTicks() const {
+	return numTicks;
+}
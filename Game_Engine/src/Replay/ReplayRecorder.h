@@ -0,0 +1,42 @@
+#ifndef REPLAYRECORDER_H
+#define REPLAYRECORDER_H
+
+#include "ReplayFormat.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Writes the input of every physics tick to a replay file. The simulation only depends on
+/// these inputs and on the seed, so the ReplayPlayer can run the same session again.
+/// </summary>
+class ReplayRecorder {
+private:
+	std::ofstream file;
+	std::string filePath;
+	bool isNewFrame;
+	InputSnapshot previousInput;
+	int numTicks;
+
+	template <typename T>
+	void Write(const T& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+public:
+	ReplayRecorder();
+	~ReplayRecorder();
+
+	bool Open(const std::string& filePath, int ticksPerSecond, int level, uint64_t seed);
+	void Close();
+	bool IsOpen() const;
+
+	// The next tick written starts a frame
+	void BeginFrame();
+	// With a keyframe, the snapshot of the simulation before this tick
+	void WriteTick(const InputSnapshot& input, const std::vector<uint8_t>* keyframe = nullptr);
+
+	int GetNumTicks() const;
+};
+
+#endif // !REPLAYRECORDER_H
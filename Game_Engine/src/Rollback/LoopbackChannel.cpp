@@ -0,0 +1,34 @@
+#include "LoopbackChannel.h"
+#include <algorithm>
+#include <functional>
+
+LoopbackChannel::LoopbackChannel(double latencyMilliseconds, double jitterMilliseconds, uint64_t seed) : random(seed) {
+	this->latencyMilliseconds = std::max(latencyMilliseconds, 0.0);
+	this->jitterMilliseconds = std::max(jitterMilliseconds, 0.0);
+	nextSequence = 0;
+}
+
+void LoopbackChannel::Send(double time, const RollbackInputMessage& message) {
+	const double jitter = jitterMilliseconds * (2.0 * random.NextFloat() - 1.0);
+	PendingMessage pendingMessage;
+	pendingMessage.deliveryTime = time + std::max(latencyMilliseconds + jitter, 0.0);
+	pendingMessage.sequence = nextSequence++;
+	pendingMessage.message = message;
+
+	pendingMessages.push_back(pendingMessage);
+	std::push_heap(pendingMessages.begin(), pendingMessages.end(), std::greater<PendingMessage>());
+}
+
+bool LoopbackChannel::Receive(double time, RollbackInputMessage& message) {
+	if (pendingMessages.empty() || pendingMessages.front().deliveryTime > time) {
+		return false;
+	}
+	message = pendingMessages.front().message;
+	std::pop_heap(pendingMessages.begin(), pendingMessages.end(), std::greater<PendingMessage>());
+	pendingMessages.pop_back();
+	return true;
+}
+
+int LoopbackChannel::GetNumPendingMessages() const {
+	return static_cast<int>(pendingMessages.size());
+}
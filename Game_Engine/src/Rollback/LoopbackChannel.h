@@ -0,0 +1,52 @@
+#ifndef LOOPBACKCHANNEL_H
+#define LOOPBACKCHANNEL_H
+
+#include "../Input/InputManager.h"
+#include "../Utils/Random.h"
+#include <cstdint>
+#include <vector>
+
+// Input of one player for one tick, as the peers send it to each other
+struct RollbackInputMessage {
+	int player;
+	int tick;
+	InputSnapshot input;
+};
+
+/// <summary>
+/// Stands in for the network between two peers of the same process, in one direction. Every
+/// message is delivered after the latency, plus or minus a random jitter, so the messages sent
+/// close together can arrive out of order like on a real connection. Time is given by the
+/// caller in milliseconds, the tests run on a simulated clock as fast as possible.
+/// </summary>
+class LoopbackChannel {
+private:
+	struct PendingMessage {
+		double deliveryTime;
+		// Order of sending, for the messages delivered at the same time
+		int sequence;
+		RollbackInputMessage message;
+
+		bool operator > (const PendingMessage& other) const {
+			return deliveryTime != other.deliveryTime ? deliveryTime > other.deliveryTime : sequence > other.sequence;
+		}
+	};
+
+	// Heap of the messages in flight, the next one to deliver first
+	std::vector<PendingMessage> pendingMessages;
+	double latencyMilliseconds;
+	double jitterMilliseconds;
+	int nextSequence;
+	Random random;
+
+public:
+	LoopbackChannel(double latencyMilliseconds, double jitterMilliseconds, uint64_t seed);
+
+	void Send(double time, const RollbackInputMessage& message);
+	// Takes the next message delivered by that time, false when there is none
+	bool Receive(double time, RollbackInputMessage& message);
+
+	int GetNumPendingMessages() const;
+};
+
+#endif // !LOOPBACKCHANNEL_H
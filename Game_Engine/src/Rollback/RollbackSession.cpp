@@ -0,0 +1,194 @@
+#include "RollbackSession.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <string>
+
+RollbackSession::RollbackSession(int numPlayers, int localPlayer, const SaveStateCallback& saveState, const LoadStateCallback& loadState,
+	const SimulateTickCallback& simulateTick, int startTick) {
+	if (numPlayers < 1 || numPlayers > MAX_PLAYERS) {
+		Logger::Err("A rollback session has from 1 to " + std::to_string(MAX_PLAYERS) + " players, not " + std::to_string(numPlayers));
+		numPlayers = std::min(std::max(numPlayers, 1), MAX_PLAYERS);
+	}
+	this->numPlayers = numPlayers;
+	this->localPlayer = std::min(std::max(localPlayer, 0), numPlayers - 1);
+	this->saveState = saveState;
+	this->loadState = loadState;
+	this->simulateTick = simulateTick;
+
+	currentTick = startTick;
+	firstMispredictedTick = -1;
+	states.resize(ROLLBACK_STATE_RING_SIZE);
+	for (auto& state : states) {
+		state.tick = -1;
+	}
+	inputs.resize(numPlayers * ROLLBACK_INPUT_RING_SIZE);
+	for (auto& tickInput : inputs) {
+		tickInput.tick = -1;
+		tickInput.isConfirmed = false;
+	}
+	confirmedTicks.assign(numPlayers, startTick - 1);
+	confirmedInputs.assign(numPlayers, InputSnapshot(startTick - 1));
+	tickInputs.resize(numPlayers);
+
+	numRollbacks = 0;
+	numResimulatedTicks = 0;
+	maxRollbackTicks = 0;
+	resimulationCounter = 0;
+}
+
+RollbackSession::TickInput& RollbackSession::GetTickInput(int player, int tick) {
+	return inputs[player * ROLLBACK_INPUT_RING_SIZE + tick % ROLLBACK_INPUT_RING_SIZE];
+}
+
+void RollbackSession::ConfirmInput(int player, int tick, const InputSnapshot& input) {
+	TickInput& tickInput = GetTickInput(player, tick);
+
+	// A tick that already ran with another prediction runs again from there
+	if (tickInput.tick == tick && !tickInput.isConfirmed && tick < currentTick && !tickInput.input.HasSameActions(input)) {
+		if (firstMispredictedTick < 0 || tick < firstMispredictedTick) {
+			firstMispredictedTick = tick;
+		}
+	}
+	tickInput.tick = tick;
+	tickInput.input = input;
+	tickInput.input.tick = tick;
+	tickInput.isConfirmed = true;
+
+	// The inputs may arrive out of order, the confirmed tick only moves over the ones without a gap
+	while (true) {
+		const TickInput& nextInput = GetTickInput(player, confirmedTicks[player] + 1);
+		if (nextInput.tick != confirmedTicks[player] + 1 || !nextInput.isConfirmed) {
+			break;
+		}
+		confirmedTicks[player]++;
+		confirmedInputs[player] = nextInput.input;
+	}
+}
+
+void RollbackSession::SimulateTick() {
+	SavedState& state = states[currentTick % ROLLBACK_STATE_RING_SIZE];
+	state.tick = currentTick;
+	state.data.clear();
+	saveState(state.data);
+
+	// A missing input repeats the actions held in the last known one, without pressing or releasing anything
+	for (int player = 0; player < numPlayers; player++) {
+		TickInput& tickInput = GetTickInput(player, currentTick);
+		if (tickInput.tick != currentTick || !tickInput.isConfirmed) {
+			tickInput.tick = currentTick;
+			tickInput.input = confirmedInputs[player];
+			tickInput.input.tick = currentTick;
+			tickInput.input.actionsPressed = 0;
+			tickInput.input.actionsReleased = 0;
+			tickInput.isConfirmed = false;
+		}
+		tickInputs[player] = tickInput.input;
+	}
+
+	simulateTick(tickInputs.data(), numPlayers);
+	currentTick++;
+}
+
+int RollbackSession::GetCurrentTick() const {
+	return currentTick;
+}
+
+int RollbackSession::GetConfirmedTick() const {
+	int confirmedTick = currentTick - 1;
+	for (int player = 0; player < numPlayers; player++) {
+		confirmedTick = std::min(confirmedTick, confirmedTicks[player]);
+	}
+	return confirmedTick;
+}
+
+bool RollbackSession::CanAdvance() const {
+	if (confirmedTicks[localPlayer] < currentTick) {
+		return false;
+	}
+	for (int player = 0; player < numPlayers; player++) {
+		if (currentTick - confirmedTicks[player] > ROLLBACK_MAX_PREDICTION_TICKS) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RollbackSession::AddLocalInput(const InputSnapshot& input) {
+	if (confirmedTicks[localPlayer] >= currentTick) {
+		Logger::Err("The local input of tick " + std::to_string(currentTick) + " was already added");
+		return;
+	}
+	ConfirmInput(localPlayer, currentTick, input);
+}
+
+void RollbackSession::AddRemoteInput(int player, int tick, const InputSnapshot& input) {
+	if (player < 0 || player >= numPlayers || player == localPlayer) {
+		Logger::Err("Received an input for player " + std::to_string(player) + ", who is not a remote player of the session");
+		return;
+	}
+	if (tick <= confirmedTicks[player]) {
+		return;
+	}
+	if (tick >= confirmedTicks[player] + ROLLBACK_INPUT_RING_SIZE) {
+		Logger::Err("Received the input of tick " + std::to_string(tick) + " for player " + std::to_string(player) + ", too far ahead of the session");
+		return;
+	}
+	ConfirmInput(player, tick, input);
+}
+
+void RollbackSession::Synchronize() {
+	if (firstMispredictedTick < 0) {
+		return;
+	}
+	PROFILE_FUNCTION();
+
+	const int rollbackTick = firstMispredictedTick;
+	firstMispredictedTick = -1;
+	const SavedState& state = states[rollbackTick % ROLLBACK_STATE_RING_SIZE];
+	if (state.tick != rollbackTick) {
+		Logger::Err("Can't roll back to tick " + std::to_string(rollbackTick) + ", its state is no longer saved");
+		return;
+	}
+
+	const Uint64 startCounter = SDL_GetPerformanceCounter();
+	if (!loadState(state.data.data(), state.data.size())) {
+		Logger::Err("Can't load the state of tick " + std::to_string(rollbackTick) + " to roll back");
+		return;
+	}
+	const int lastTick = currentTick;
+	currentTick = rollbackTick;
+	while (currentTick < lastTick) {
+		SimulateTick();
+	}
+
+	numRollbacks++;
+	numResimulatedTicks += lastTick - rollbackTick;
+	maxRollbackTicks = std::max(maxRollbackTicks, lastTick - rollbackTick);
+	resimulationCounter += SDL_GetPerformanceCounter() - startCounter;
+}
+
+bool RollbackSession::AdvanceTick() {
+	Synchronize();
+	if (!CanAdvance()) {
+		return false;
+	}
+	SimulateTick();
+	return true;
+}
+
+int RollbackSession::GetNumRollbacks() const {
+	return numRollbacks;
+}
+
+int RollbackSession::GetNumResimulatedTicks() const {
+	return numResimulatedTicks;
+}
+
+int RollbackSession::GetMaxRollbackTicks() const {
+	return maxRollbackTicks;
+}
+
+double RollbackSession::GetResimulationMilliseconds() const {
+	return static_cast<double>(resimulationCounter) * 1000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
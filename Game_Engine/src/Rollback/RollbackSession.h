@@ -0,0 +1,104 @@
+#ifndef ROLLBACKSESSION_H
+#define ROLLBACKSESSION_H
+
+#include "../Input/InputManager.h"
+#include <SDL.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Ticks a peer may simulate past the last tick it has every input of, then it waits for the others
+const int ROLLBACK_MAX_PREDICTION_TICKS = 8;
+
+// One saved state per tick that can still be rolled back to
+const int ROLLBACK_STATE_RING_SIZE = ROLLBACK_MAX_PREDICTION_TICKS + 2;
+
+// Inputs of each player kept around the current tick, the ones sent early by a faster peer included
+const int ROLLBACK_INPUT_RING_SIZE = 4 * ROLLBACK_MAX_PREDICTION_TICKS;
+
+typedef std::function<void(std::vector<uint8_t>& state)> SaveStateCallback;
+typedef std::function<bool(const uint8_t* state, size_t stateSize)> LoadStateCallback;
+typedef std::function<void(const InputSnapshot* inputs, int numPlayers)> SimulateTickCallback;
+
+/// <summary>
+/// Keeps the peers of a multiplayer session in step without waiting for the network. Each tick
+/// runs right away with the local input, and the inputs of the other players that have not
+/// arrived yet are predicted: they keep holding what they held in their last known tick. When an
+/// input arrives that differs from its prediction, the session loads the state saved before that
+/// tick and simulates again up to the current tick. The game provides the state and the step as
+/// callbacks, the simulation must only depend on the saved state and on the inputs.
+/// </summary>
+class RollbackSession {
+private:
+	struct SavedState {
+		int tick;
+		std::vector<uint8_t> data;
+	};
+
+	struct TickInput {
+		int tick;
+		InputSnapshot input;
+		// Received (or local) input, otherwise a prediction already used by the simulation
+		bool isConfirmed;
+	};
+
+	int numPlayers;
+	int localPlayer;
+	// Next tick to simulate
+	int currentTick;
+	// Earliest simulated tick that used a wrong prediction, or -1
+	int firstMispredictedTick;
+
+	// [index = tick % ROLLBACK_STATE_RING_SIZE], state before the tick ran
+	std::vector<SavedState> states;
+	// [index = player * ROLLBACK_INPUT_RING_SIZE + tick % ROLLBACK_INPUT_RING_SIZE]
+	std::vector<TickInput> inputs;
+	// [index = player], last tick whose input and all the inputs before it are known
+	std::vector<int> confirmedTicks;
+	std::vector<InputSnapshot> confirmedInputs;
+	// Inputs of the tick being simulated, given to the step
+	std::vector<InputSnapshot> tickInputs;
+
+	SaveStateCallback saveState;
+	LoadStateCallback loadState;
+	SimulateTickCallback simulateTick;
+
+	int numRollbacks;
+	int numResimulatedTicks;
+	int maxRollbackTicks;
+	Uint64 resimulationCounter;
+
+	TickInput& GetTickInput(int player, int tick);
+	void ConfirmInput(int player, int tick, const InputSnapshot& input);
+	void SimulateTick();
+
+public:
+	// Every peer starts from the same state at startTick, with its own localPlayer
+	RollbackSession(int numPlayers, int localPlayer, const SaveStateCallback& saveState, const LoadStateCallback& loadState,
+		const SimulateTickCallback& simulateTick, int startTick = 0);
+
+	int GetCurrentTick() const;
+	// Last tick simulated with the real input of every player, it will never be rolled back
+	int GetConfirmedTick() const;
+
+	// False while the other players are too far behind, the peer should wait for their inputs
+	bool CanAdvance() const;
+
+	// Input of the local player for the current tick, to be sent to the other peers as well
+	void AddLocalInput(const InputSnapshot& input);
+	// Input of another player, in any order, the ones already known are ignored
+	void AddRemoteInput(int player, int tick, const InputSnapshot& input);
+
+	// Rolls back and simulates again if one of the received inputs was mispredicted
+	void Synchronize();
+	// Synchronizes, then simulates the current tick. Returns false if it can't advance yet.
+	bool AdvanceTick();
+
+	// Cost of the corrections
+	int GetNumRollbacks() const;
+	int GetNumResimulatedTicks() const;
+	int GetMaxRollbackTicks() const;
+	double GetResimulationMilliseconds() const;
+};
+
+#endif // !ROLLBACKSESSION_H
@@ -0,0 +1,297 @@
+#include "Flocking.h"
+#include "../Profiler/Profiler.h"
+#include "../Utils/SIMD.h"
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Agents hashed or copied by each job of the grid build, the work per agent is tiny
+const int FLOCK_GRID_BATCH_SIZE = 4096;
+
+/// <summary>
+/// What an agent sees of its neighbours, the offsets are relative to its position.
+/// With SSE2 every value has one sum per lane, they are only added together once per agent.
+/// </summary>
+struct NeighbourSums {
+#ifdef USE_SSE2
+	__m128 numNeighbours;
+	__m128 offsetX, offsetY;
+	__m128 velocityX, velocityY;
+	__m128 numSeparated;
+	__m128 separationX, separationY;
+#else
+	float numNeighbours;
+	float offsetX, offsetY;
+	float velocityX, velocityY;
+	float numSeparated;
+	float separationX, separationY;
+#endif
+};
+
+void FlockBatch::Resize(int numAgents) {
+	positionsX.resize(numAgents);
+	positionsY.resize(numAgents);
+	velocitiesX.resize(numAgents);
+	velocitiesY.resize(numAgents);
+	flockIDs.resize(numAgents);
+	maxSpeeds.resize(numAgents);
+	maxForces.resize(numAgents);
+	separationWeights.resize(numAgents);
+	alignmentWeights.resize(numAgents);
+	cohesionWeights.resize(numAgents);
+	steeringsX.resize(numAgents);
+	steeringsY.resize(numAgents);
+}
+
+FlockGrid::FlockGrid() {
+	cellSize = 1.0f;
+	inverseCellSize = 1.0f;
+	bucketMask = 0;
+	bucketStarts.assign(2, 0);
+}
+
+int FlockGrid::GetCellCoordinate(float position) const {
+	return static_cast<int>(std::floor(position * inverseCellSize));
+}
+
+uint32_t FlockGrid::GetBucket(int cellX, int cellY) const {
+	return ((static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u)) & bucketMask;
+}
+
+int FlockGrid::GetNumAgents() const {
+	return static_cast<int>(agents.size());
+}
+
+void FlockGrid::Build(const FlockBatch& batch, int numAgents, float neighbourRadius, JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	cellSize = std::max(neighbourRadius, 1.0f);
+	inverseCellSize = 1.0f / cellSize;
+
+	uint32_t numBuckets = 1;
+	while (numBuckets < static_cast<uint32_t>(numAgents) * 2) {
+		numBuckets <<= 1;
+	}
+	bucketMask = numBuckets - 1;
+	bucketStarts.assign(numBuckets + 1, 0);
+
+	// the padding lets the last run of agents be loaded SIMD_WIDTH at a time, it stays at 0
+	const int paddedSize = numAgents + SIMD_WIDTH;
+	positionsX.resize(paddedSize);
+	positionsY.resize(paddedSize);
+	velocitiesX.resize(paddedSize);
+	velocitiesY.resize(paddedSize);
+	flockIDs.resize(paddedSize);
+	std::fill(positionsX.begin() + numAgents, positionsX.end(), 0.0f);
+	std::fill(positionsY.begin() + numAgents, positionsY.end(), 0.0f);
+	std::fill(velocitiesX.begin() + numAgents, velocitiesX.end(), 0.0f);
+	std::fill(velocitiesY.begin() + numAgents, velocitiesY.end(), 0.0f);
+	std::fill(flockIDs.begin() + numAgents, flockIDs.end(), 0);
+	agents.resize(numAgents);
+	buckets.resize(numAgents);
+
+	auto hashAgents = [&](int first, int last) {
+		for (int agent = first; agent < last; agent++) {
+			buckets[agent] = GetBucket(GetCellCoordinate(batch.positionsX[agent]), GetCellCoordinate(batch.positionsY[agent]));
+		}
+	};
+	// the sorted arrays are gathered in order, each job writes its own range
+	auto copyAgents = [&](int first, int last) {
+		for (int slot = first; slot < last; slot++) {
+			const int agent = agents[slot];
+			positionsX[slot] = batch.positionsX[agent];
+			positionsY[slot] = batch.positionsY[agent];
+			velocitiesX[slot] = batch.velocitiesX[agent];
+			velocitiesY[slot] = batch.velocitiesY[agent];
+			flockIDs[slot] = batch.flockIDs[agent];
+		}
+	};
+
+	if (jobSystem) {
+		jobSystem->ParallelFor(numAgents, FLOCK_GRID_BATCH_SIZE, hashAgents);
+	}
+	else {
+		hashAgents(0, numAgents);
+	}
+
+	// Counting sort by bucket, same as the SpatialIndex
+	for (int agent = 0; agent < numAgents; agent++) {
+		bucketStarts[buckets[agent] + 1]++;
+	}
+	for (uint32_t bucket = 0; bucket < numBuckets; bucket++) {
+		bucketStarts[bucket + 1] += bucketStarts[bucket];
+	}
+	for (int agent = 0; agent < numAgents; agent++) {
+		agents[bucketStarts[buckets[agent]]++] = agent;
+	}
+	for (uint32_t bucket = numBuckets; bucket > 0; bucket--) {
+		bucketStarts[bucket] = bucketStarts[bucket - 1];
+	}
+	bucketStarts[0] = 0;
+
+	if (jobSystem) {
+		jobSystem->ParallelFor(numAgents, FLOCK_GRID_BATCH_SIZE, copyAgents);
+	}
+	else {
+		copyAgents(0, numAgents);
+	}
+}
+
+#ifdef USE_SSE2
+static float HorizontalSum(__m128 values) {
+	__m128 sum = _mm_add_ps(values, _mm_movehl_ps(values, values));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+}
+#endif
+
+// Adds the agents of [first, last) that are close to (x, y) to the sums
+static void AccumulateNeighbours(const float* positionsX, const float* positionsY, const float* velocitiesX, const float* velocitiesY, const int* flockIDs,
+	int first, int last, float x, float y, int flockID, float neighbourRadiusSquared, float separationRadiusSquared, NeighbourSums& sums) {
+#ifdef USE_SSE2
+	const __m128 agentX = _mm_set1_ps(x);
+	const __m128 agentY = _mm_set1_ps(y);
+	const __m128 neighbourDistance = _mm_set1_ps(neighbourRadiusSquared);
+	const __m128 separationDistance = _mm_set1_ps(separationRadiusSquared);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128i agentFlock = _mm_set1_epi32(flockID);
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i end = _mm_set1_epi32(last);
+
+	for (int j = first; j < last; j += SIMD_WIDTH) {
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(positionsX + j), agentX);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(positionsY + j), agentY);
+		const __m128 distanceSquared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		// the lanes past the run are masked, and so is the agent itself (at distance 0)
+		const __m128 inRun = _mm_castsi128_ps(_mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(j), lanes), end));
+		const __m128 isOther = _mm_and_ps(inRun, _mm_cmpgt_ps(distanceSquared, zero));
+		const __m128 isSameFlock = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(flockIDs + j)), agentFlock));
+		const __m128 isNeighbour = _mm_and_ps(_mm_and_ps(isOther, isSameFlock), _mm_cmplt_ps(distanceSquared, neighbourDistance));
+		const __m128 isTooClose = _mm_and_ps(isOther, _mm_cmplt_ps(distanceSquared, separationDistance));
+
+		sums.numNeighbours = _mm_add_ps(sums.numNeighbours, _mm_and_ps(isNeighbour, one));
+		sums.offsetX = _mm_add_ps(sums.offsetX, _mm_and_ps(isNeighbour, dx));
+		sums.offsetY = _mm_add_ps(sums.offsetY, _mm_and_ps(isNeighbour, dy));
+		sums.velocityX = _mm_add_ps(sums.velocityX, _mm_and_ps(isNeighbour, _mm_loadu_ps(velocitiesX + j)));
+		sums.velocityY = _mm_add_ps(sums.velocityY, _mm_and_ps(isNeighbour, _mm_loadu_ps(velocitiesY + j)));
+
+		// the push gets stronger as the agents get closer, in 1 / distance
+		const __m128 inverseDistanceSquared = _mm_div_ps(one, _mm_max_ps(distanceSquared, _mm_set1_ps(1e-6f)));
+		sums.numSeparated = _mm_add_ps(sums.numSeparated, _mm_and_ps(isTooClose, one));
+		sums.separationX = _mm_sub_ps(sums.separationX, _mm_and_ps(isTooClose, _mm_mul_ps(dx, inverseDistanceSquared)));
+		sums.separationY = _mm_sub_ps(sums.separationY, _mm_and_ps(isTooClose, _mm_mul_ps(dy, inverseDistanceSquared)));
+	}
+#else
+	for (int j = first; j < last; j++) {
+		const float dx = positionsX[j] - x;
+		const float dy = positionsY[j] - y;
+		const float distanceSquared = dx * dx + dy * dy;
+		if (distanceSquared <= 0.0f) {
+			continue;
+		}
+		if (flockIDs[j] == flockID && distanceSquared < neighbourRadiusSquared) {
+			sums.numNeighbours += 1.0f;
+			sums.offsetX += dx;
+			sums.offsetY += dy;
+			sums.velocityX += velocitiesX[j];
+			sums.velocityY += velocitiesY[j];
+		}
+		if (distanceSquared < separationRadiusSquared) {
+			const float inverseDistanceSquared = 1.0f / std::max(distanceSquared, 1e-6f);
+			sums.numSeparated += 1.0f;
+			sums.separationX -= dx * inverseDistanceSquared;
+			sums.separationY -= dy * inverseDistanceSquared;
+		}
+	}
+#endif
+}
+
+static glm::vec2 ClampLength(glm::vec2 vector, float maxLength) {
+	const float lengthSquared = glm::dot(vector, vector);
+	if (lengthSquared > maxLength * maxLength) {
+		return vector * (maxLength / std::sqrt(lengthSquared));
+	}
+	return vector;
+}
+
+// Reynolds steering: the acceleration that turns the velocity towards the direction at full speed
+static glm::vec2 SteerTowards(glm::vec2 direction, glm::vec2 velocity, float maxSpeed, float maxForce) {
+	const float lengthSquared = glm::dot(direction, direction);
+	if (lengthSquared <= 0.0f) {
+		return glm::vec2(0.0f);
+	}
+	return ClampLength(direction * (maxSpeed / std::sqrt(lengthSquared)) - velocity, maxForce);
+}
+
+void FlockGrid::ComputeSteering(FlockBatch& batch, int first, int last, float separationRadius) const {
+	const float neighbourRadiusSquared = cellSize * cellSize;
+	const float separationRadiusSquared = separationRadius * separationRadius;
+
+	// the agents are visited in bucket order, so consecutive agents read the same cells
+	for (int i = first; i < last; i++) {
+		const float x = positionsX[i];
+		const float y = positionsY[i];
+		const int cellX = GetCellCoordinate(x);
+		const int cellY = GetCellCoordinate(y);
+
+		NeighbourSums sums;
+#ifdef USE_SSE2
+		sums.numNeighbours = sums.offsetX = sums.offsetY = sums.velocityX = sums.velocityY = _mm_setzero_ps();
+		sums.numSeparated = sums.separationX = sums.separationY = _mm_setzero_ps();
+#else
+		sums = {};
+#endif
+		uint32_t visitedBuckets[9];
+		int numVisitedBuckets = 0;
+		for (int offsetY = -1; offsetY <= 1; offsetY++) {
+			for (int offsetX = -1; offsetX <= 1; offsetX++) {
+				// two of the cells can share a bucket, their agents must only be counted once
+				const uint32_t bucket = GetBucket(cellX + offsetX, cellY + offsetY);
+				if (std::find(visitedBuckets, visitedBuckets + numVisitedBuckets, bucket) != visitedBuckets + numVisitedBuckets) {
+					continue;
+				}
+				visitedBuckets[numVisitedBuckets++] = bucket;
+
+				AccumulateNeighbours(positionsX.data(), positionsY.data(), velocitiesX.data(), velocitiesY.data(), flockIDs.data(),
+					bucketStarts[bucket], bucketStarts[bucket + 1], x, y, flockIDs[i], neighbourRadiusSquared, separationRadiusSquared, sums);
+			}
+		}
+
+		const int agent = agents[i];
+		const glm::vec2 velocity(velocitiesX[i], velocitiesY[i]);
+		const float maxSpeed = batch.maxSpeeds[agent];
+		const float maxForce = batch.maxForces[agent];
+
+#ifdef USE_SSE2
+		const float numNeighbours = HorizontalSum(sums.numNeighbours);
+		const glm::vec2 offset(HorizontalSum(sums.offsetX), HorizontalSum(sums.offsetY));
+		const glm::vec2 neighbourVelocity(HorizontalSum(sums.velocityX), HorizontalSum(sums.velocityY));
+		const float numSeparated = HorizontalSum(sums.numSeparated);
+		const glm::vec2 separationDirection(HorizontalSum(sums.separationX), HorizontalSum(sums.separationY));
+#else
+		const float numNeighbours = sums.numNeighbours;
+		const glm::vec2 offset(sums.offsetX, sums.offsetY);
+		const glm::vec2 neighbourVelocity(sums.velocityX, sums.velocityY);
+		const float numSeparated = sums.numSeparated;
+		const glm::vec2 separationDirection(sums.separationX, sums.separationY);
+#endif
+
+		// only the directions matter, the sums don't need to be divided into averages
+		glm::vec2 steering(0.0f);
+		if (numNeighbours > 0.0f) {
+			const glm::vec2 alignment = SteerTowards(neighbourVelocity, velocity, maxSpeed, maxForce);
+			const glm::vec2 cohesion = SteerTowards(offset, velocity, maxSpeed, maxForce);
+			steering += alignment * batch.alignmentWeights[agent] + cohesion * batch.cohesionWeights[agent];
+		}
+		if (numSeparated > 0.0f) {
+			const glm::vec2 separation = SteerTowards(separationDirection, velocity, maxSpeed, maxForce);
+			steering += separation * batch.separationWeights[agent];
+		}
+		steering = ClampLength(steering, maxForce);
+
+		batch.steeringsX[agent] = steering.x;
+		batch.steeringsY[agent] = steering.y;
+	}
+}
@@ -0,0 +1,64 @@
+#ifndef FLOCKING_H
+#define FLOCKING_H
+
+#include "../JobSystem/JobSystem.h"
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Flocking agents copied to structure-of-arrays, [vector index = agent].
+/// The steering is written back as an acceleration in pixels per second squared.
+/// </summary>
+struct FlockBatch {
+	std::vector<float> positionsX, positionsY;
+	std::vector<float> velocitiesX, velocitiesY;
+	std::vector<int> flockIDs;
+	std::vector<float> maxSpeeds, maxForces;
+	std::vector<float> separationWeights, alignmentWeights, cohesionWeights;
+
+	std::vector<float> steeringsX, steeringsY;
+
+	void Resize(int numAgents);
+};
+
+/// <summary>
+/// Hashed grid of the agents with cells as large as the neighbour radius, so the neighbours of
+/// an agent are always in the 3x3 cells around it. The agents are copied sorted by bucket, so
+/// the neighbours are read as a few contiguous runs and tested SIMD_WIDTH at a time.
+/// Build() only counts the agents per bucket on one thread, the hashing and the copies are
+/// split between the jobs. Then ComputeSteering() can run on disjoint ranges in parallel.
+/// </summary>
+class FlockGrid {
+private:
+	float cellSize;
+	float inverseCellSize;
+	uint32_t bucketMask;
+	// Agents of bucket b are at [bucketStarts[b], bucketStarts[b + 1]) of the sorted arrays
+	std::vector<int> bucketStarts;
+
+	// Sorted copies, padded to a multiple of SIMD_WIDTH
+	std::vector<float> positionsX, positionsY;
+	std::vector<float> velocitiesX, velocitiesY;
+	std::vector<int> flockIDs;
+	// [sorted index] = agent
+	std::vector<int> agents;
+	// [agent] = bucket, kept from one build to the next so it only allocates when the flock grows
+	std::vector<uint32_t> buckets;
+
+	int GetCellCoordinate(float position) const;
+	uint32_t GetBucket(int cellX, int cellY) const;
+
+public:
+	FlockGrid();
+
+	void Build(const FlockBatch& batch, int numAgents, float neighbourRadius, JobSystem* jobSystem = nullptr);
+
+	int GetNumAgents() const;
+
+	// Computes the steering of the agents at sorted indices [first, last). Agents closer than
+	// separationRadius push each other apart whatever their flock, alignment and cohesion only
+	// follow the neighbours of the same flock.
+	void ComputeSteering(FlockBatch& batch, int first, int last, float separationRadius) const;
+};
+
+#endif // !FLOCKING_H
@@ -0,0 +1,334 @@
+#ifndef COLLISIONSYSTEM_H
+#define COLLISIONSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/CircleColliderComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Collision/Broadphase.h"
+#include "../Collision/SpatialHashBroadphase.h"
+#include "../Collision/SweepAndPruneBroadphase.h"
+#include "../Collision/Narrowphase.h"
+#include "../Collision/ContinuousCollision.h"
+#include "../EventBus/EventBus.h"
+#include "../Events/CollisionEvent.h"
+#include "MovementSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+// Sprites are rotated in degrees, around the center of their destination rectangle
+const float DEGREES_TO_RADIANS = 3.14159265f / 180.0f;
+
+class CollisionSystem : public System {
+private:
+	std::unique_ptr<Broadphase> broadphase;
+	Narrowphase narrowphase;
+
+	// Frame in which each proxy was last updated, to remove the entities that left the system
+	// [vector index = entity ID]
+	std::vector<int> proxyFrames;
+	int frameNumber;
+
+	std::vector<CollisionPair> addedPairs;
+	std::vector<CollisionPair> removedPairs;
+	std::vector<ContactManifold> contacts;
+
+	// Sorted, so the collisions of two frames can be compared in one pass
+	std::vector<CollisionPair> collisions;
+	std::vector<CollisionPair> previousCollisions;
+	std::vector<CollisionPair> collisionsStarted;
+	std::vector<CollisionPair> collisionsEnded;
+
+	// Bodies that move more than their own half size in one frame could jump over a collider,
+	// they are swept from their previous position instead of only tested where they end
+	struct FastMover {
+		Entity entity;
+		AABB startBounds;
+		glm::vec2 motion;
+		SweepHit firstHit;
+		int firstHitEntityID;
+	};
+	std::vector<FastMover> fastMovers;
+	// [vector index = entity ID], -1 when the entity is not a fast mover this frame
+	std::vector<int> fastMoverIndices;
+
+	static CollisionShape GetBoxShape(const TransformComponent& transform, const BoxColliderComponent& collider) {
+		const float angle = static_cast<float>(transform.rotation) * DEGREES_TO_RADIANS;
+		const glm::vec2 size = glm::vec2(collider.width * transform.scale.x, collider.height * transform.scale.y);
+
+		CollisionShape shape;
+		shape.type = SHAPE_BOX;
+		shape.center = transform.position + collider.offset + size * 0.5f;
+		shape.axisX = glm::vec2(std::cos(angle), std::sin(angle));
+		shape.halfExtents = size * 0.5f;
+		shape.radius = 0.0f;
+		return shape;
+	}
+
+	static CollisionShape GetCircleShape(const TransformComponent& transform, const CircleColliderComponent& collider) {
+		const float radius = collider.radius * std::max(transform.scale.x, transform.scale.y);
+
+		CollisionShape shape;
+		shape.type = SHAPE_CIRCLE;
+		shape.center = transform.position + collider.offset + glm::vec2(radius);
+		shape.axisX = glm::vec2(1, 0);
+		shape.halfExtents = glm::vec2(radius);
+		shape.radius = radius;
+		return shape;
+	}
+
+	bool IsFastMover(int entityID) const {
+		return entityID < static_cast<int>(fastMoverIndices.size()) && fastMoverIndices[entityID] >= 0;
+	}
+
+	// Continuous collision: sweeps the fast movers against the candidates that the discrete test
+	// missed, and moves them back to their first time of impact so they never pass through
+	void ResolveFastMovers(MovementSystem& movementSystem) {
+		PROFILE_FUNCTION();
+
+		for (const auto& pair : broadphase->GetPairs()) {
+			const bool isFastA = IsFastMover(pair.entityA);
+			const bool isFastB = IsFastMover(pair.entityB);
+			if ((!isFastA && !isFastB) || std::binary_search(collisions.begin(), collisions.end(), pair)) {
+				continue;
+			}
+
+			// sweep A relative to B, a slow body is considered static for the frame
+			const AABB startA = isFastA ? fastMovers[fastMoverIndices[pair.entityA]].startBounds : narrowphase.GetShape(pair.entityA).GetBounds();
+			const AABB startB = isFastB ? fastMovers[fastMoverIndices[pair.entityB]].startBounds : narrowphase.GetShape(pair.entityB).GetBounds();
+			const glm::vec2 motionA = isFastA ? fastMovers[fastMoverIndices[pair.entityA]].motion : glm::vec2(0);
+			const glm::vec2 motionB = isFastB ? fastMovers[fastMoverIndices[pair.entityB]].motion : glm::vec2(0);
+
+			SweepHit hit;
+			if (!SweepAABB(startA, motionA - motionB, startB, hit)) {
+				continue;
+			}
+
+			for (int entityID : { pair.entityA, pair.entityB }) {
+				if (!IsFastMover(entityID)) {
+					continue;
+				}
+				// the pairs come in the broadphase's order, which depends on its history: equal times
+				// of impact go to the lowest ID, so a restored snapshot resolves them the same way
+				FastMover& fastMover = fastMovers[fastMoverIndices[entityID]];
+				const int otherID = entityID == pair.entityA ? pair.entityB : pair.entityA;
+				const bool isFirstHit = hit.timeOfImpact < fastMover.firstHit.timeOfImpact
+					|| (hit.timeOfImpact == fastMover.firstHit.timeOfImpact && fastMover.firstHitEntityID >= 0 && otherID < fastMover.firstHitEntityID);
+				if (isFirstHit) {
+					fastMover.firstHit = hit;
+					fastMover.firstHitEntityID = otherID;
+					// the hit normal is the face of B, it is stored as seen by the fast mover
+					if (entityID == pair.entityB) {
+						fastMover.firstHit.normal = -hit.normal;
+					}
+				}
+			}
+		}
+
+		for (auto& fastMover : fastMovers) {
+			if (fastMover.firstHitEntityID < 0) {
+				continue;
+			}
+
+			auto& transform = fastMover.entity.GetComponent<TransformComponent>();
+			transform.position -= fastMover.motion * (1.0f - fastMover.firstHit.timeOfImpact);
+
+			// the body stops against the collider and only keeps the velocity that slides along it
+			const glm::vec2 velocity = fastMover.entity.GetComponent<RigidBodyComponent>().velocity;
+			const float normalSpeed = glm::dot(velocity, fastMover.firstHit.normal);
+			if (normalSpeed < 0.0f) {
+				movementSystem.SetVelocity(fastMover.entity, velocity - fastMover.firstHit.normal * normalSpeed);
+			}
+
+			const int entityID = fastMover.entity.GetID();
+			const int otherID = fastMover.firstHitEntityID;
+			const AABB bounds = { fastMover.startBounds.min + fastMover.motion * fastMover.firstHit.timeOfImpact, fastMover.startBounds.max + fastMover.motion * fastMover.firstHit.timeOfImpact };
+
+			// the manifold normal goes from entityA to entityB, and the hit normal points at the fast mover
+			ContactManifold contact;
+			contact.entityA = std::min(entityID, otherID);
+			contact.entityB = std::max(entityID, otherID);
+			contact.normal = entityID == contact.entityA ? -fastMover.firstHit.normal : fastMover.firstHit.normal;
+			contact.penetration = 0.0f;
+			contact.numPoints = 1;
+			contact.points[0] = (bounds.min + bounds.max) * 0.5f - fastMover.firstHit.normal * (bounds.max - bounds.min) * 0.5f;
+			contacts.push_back(contact);
+			collisions.push_back({ contact.entityA, contact.entityB });
+		}
+	}
+
+protected:
+	void OnEntitiesRemapped(const std::vector<int>& newIDs) override {
+		broadphase->RemapProxies(newIDs);
+		narrowphase.RemapShapes(newIDs);
+		RemapEntityVector(proxyFrames, newIDs, 0);
+
+		// the fast movers only live during one update
+		for (const auto& fastMover : fastMovers) {
+			fastMoverIndices[fastMover.entity.GetID()] = -1;
+		}
+		fastMovers.clear();
+		RemapEntityVector(fastMoverIndices, newIDs, -1);
+
+		for (auto& contact : contacts) {
+			const CollisionPair pair = CollisionPair{ contact.entityA, contact.entityB }.Remap(newIDs);
+			if (pair.entityA != newIDs[contact.entityA]) {
+				contact.normal = -contact.normal;
+			}
+			contact.entityA = pair.entityA;
+			contact.entityB = pair.entityB;
+		}
+		for (auto* pairList : { &addedPairs, &removedPairs, &collisions, &previousCollisions, &collisionsStarted, &collisionsEnded }) {
+			for (auto& pair : *pairList) {
+				pair = pair.Remap(newIDs);
+			}
+			std::sort(pairList->begin(), pairList->end());
+		}
+	}
+
+public:
+	CollisionSystem(BroadphaseType broadphaseType = BROADPHASE_SPATIAL_HASH) {
+		// An entity collides with a box or a circle collider, the tiles without any never join the system
+		RequireComponent<TransformComponent>();
+		RequireAnyComponent<BoxColliderComponent>();
+		RequireAnyComponent<CircleColliderComponent>();
+
+		switch (broadphaseType) {
+			case BROADPHASE_SWEEP_AND_PRUNE:
+				broadphase = std::make_unique<SweepAndPruneBroadphase>();
+				break;
+			case BROADPHASE_SPATIAL_HASH:
+			default:
+				broadphase = std::make_unique<SpatialHashBroadphase>();
+				break;
+		}
+		frameNumber = 0;
+	}
+
+	// Runs after the movementSystem's step, the fast movers are swept along the motion it recorded
+	// and the ones that hit something get their velocity corrected through it
+	void Update(MovementSystem& movementSystem) {
+		PROFILE_FUNCTION();
+
+		frameNumber++;
+		for (const auto& fastMover : fastMovers) {
+			fastMoverIndices[fastMover.entity.GetID()] = -1;
+		}
+		fastMovers.clear();
+
+		// Move the proxies, the broadphase only does work for the ones that changed cells
+		for (auto entity : GetSystemEntities()) {
+			const CollisionShape shape = entity.HasComponent<BoxColliderComponent>()
+				? GetBoxShape(entity.GetComponent<TransformComponent>(), entity.GetComponent<BoxColliderComponent>())
+				: GetCircleShape(entity.GetComponent<TransformComponent>(), entity.GetComponent<CircleColliderComponent>());
+
+			const int entityID = entity.GetID();
+			if (entityID >= static_cast<int>(proxyFrames.size())) {
+				proxyFrames.resize(entityID + 1, 0);
+				fastMoverIndices.resize(entityID + 1, -1);
+			}
+
+			AABB bounds = shape.GetBounds();
+			if (entity.HasComponent<RigidBodyComponent>()) {
+				const glm::vec2 motion = movementSystem.GetStepMotion(entityID);
+				const glm::vec2 halfSize = (bounds.max - bounds.min) * 0.5f;
+
+				// most bodies are slow and stay on the discrete test, the fast ones get their swept bounds
+				if (std::fabs(motion.x) > halfSize.x || std::fabs(motion.y) > halfSize.y) {
+					const AABB startBounds = { bounds.min - motion, bounds.max - motion };
+					fastMoverIndices[entityID] = static_cast<int>(fastMovers.size());
+					fastMovers.push_back({ entity, startBounds, motion, { 1.0f, glm::vec2(0) }, -1 });
+					bounds = MergeAABB(startBounds, bounds);
+				}
+			}
+
+			narrowphase.SetShape(entityID, shape);
+			broadphase->UpdateProxy(entityID, bounds);
+			proxyFrames[entityID] = frameNumber;
+		}
+
+		// Any proxy that was not updated this frame belongs to an entity that is gone
+		for (int entityID = 0; entityID < static_cast<int>(proxyFrames.size()); entityID++) {
+			if (proxyFrames[entityID] != 0 && proxyFrames[entityID] != frameNumber) {
+				broadphase->RemoveProxy(entityID);
+				narrowphase.RemoveShape(entityID);
+				proxyFrames[entityID] = 0;
+			}
+		}
+
+		broadphase->UpdatePairs(addedPairs, removedPairs);
+
+		// The bounds of rotated boxes and circles are larger than the shapes, test them exactly
+		narrowphase.Collide(broadphase->GetPairs(), contacts);
+
+		collisions.swap(previousCollisions);
+		collisions.clear();
+		for (const auto& contact : contacts) {
+			collisions.push_back({ contact.entityA, contact.entityB });
+		}
+		std::sort(collisions.begin(), collisions.end());
+
+		if (!fastMovers.empty()) {
+			ResolveFastMovers(movementSystem);
+			std::sort(collisions.begin(), collisions.end());
+			collisions.erase(std::unique(collisions.begin(), collisions.end()), collisions.end());
+		}
+
+		collisionsStarted.clear();
+		collisionsEnded.clear();
+		std::set_difference(collisions.begin(), collisions.end(), previousCollisions.begin(), previousCollisions.end(), std::back_inserter(collisionsStarted));
+		std::set_difference(previousCollisions.begin(), previousCollisions.end(), collisions.begin(), collisions.end(), std::back_inserter(collisionsEnded));
+	}
+
+	// The collisions of the last tick tell which ones start or end during the next one
+	void SaveState(BinaryWriter& writer) const override {
+		writer.WriteVector(collisions);
+	}
+
+	void LoadState(BinaryReader& reader) override {
+		if (!reader.ReadVector(collisions)) {
+			collisions.clear();
+		}
+		previousCollisions.clear();
+		collisionsStarted.clear();
+		collisionsEnded.clear();
+		contacts.clear();
+	}
+
+	// Pairs of entities that collided during the last Update(), entityA is always the lowest ID
+	const std::vector<CollisionPair>& GetCollisions() const {
+		return collisions;
+	}
+
+	// Normal, penetration and contact points of every collision of the last Update()
+	const std::vector<ContactManifold>& GetContacts() const {
+		return contacts;
+	}
+
+	// Pairs that started or stopped colliding during the last Update()
+	const std::vector<CollisionPair>& GetCollisionsStarted() const {
+		return collisionsStarted;
+	}
+
+	const std::vector<CollisionPair>& GetCollisionsEnded() const {
+		return collisionsEnded;
+	}
+
+	// Queues the collisions that started or ended during the last Update()
+	void EmitCollisionEvents(EventBus& eventBus) const {
+		auto& eventQueue = eventBus.GetEventQueue<CollisionEvent>();
+		for (const auto& pair : collisionsStarted) {
+			eventQueue.Emit(CollisionEvent(pair.entityA, pair.entityB, true));
+		}
+		for (const auto& pair : collisionsEnded) {
+			eventQueue.Emit(CollisionEvent(pair.entityA, pair.entityB, false));
+		}
+	}
+};
+
+#endif // !COLLISIONSYSTEM_H
@@ -0,0 +1,95 @@
+#ifndef FLOCKINGSYSTEM_H
+#define FLOCKINGSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/BoidComponent.h"
+#include "../JobSystem/JobSystem.h"
+#include "../Steering/Flocking.h"
+#include "MovementSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+const float DEFAULT_NEIGHBOUR_RADIUS = 64.0f;
+const float DEFAULT_SEPARATION_RADIUS = 24.0f;
+
+// Agents steered by each job of the worker pool
+const int FLOCKING_BATCH_SIZE = 512;
+
+/// <summary>
+/// Steers the boids with separation, alignment and cohesion. The neighbours are gathered from
+/// a grid rebuilt every tick, and the steering of the agents is computed in parallel by the
+/// job system; the velocities are written back on the calling thread.
+/// </summary>
+class FlockingSystem : public System {
+private:
+	float neighbourRadius;
+	float separationRadius;
+
+	FlockBatch batch;
+	FlockGrid grid;
+
+public:
+	FlockingSystem(float neighbourRadius = DEFAULT_NEIGHBOUR_RADIUS, float separationRadius = DEFAULT_SEPARATION_RADIUS) {
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+		RequireComponent<BoidComponent>();
+		this->neighbourRadius = neighbourRadius;
+		// the grid only finds the agents within the neighbour radius
+		this->separationRadius = std::min(separationRadius, neighbourRadius);
+	}
+
+	// Runs before the MovementSystem, the new velocities are integrated in the same tick
+	void Update(double deltaTime, JobSystem& jobSystem, MovementSystem& movementSystem) {
+		PROFILE_FUNCTION();
+
+		const auto& entities = GetSystemEntities();
+		const int numAgents = static_cast<int>(entities.size());
+		if (numAgents == 0) {
+			return;
+		}
+
+		batch.Resize(numAgents);
+		for (int i = 0; i < numAgents; i++) {
+			const auto& transform = entities[i].GetComponent<TransformComponent>();
+			const auto& rigidbody = entities[i].GetComponent<RigidBodyComponent>();
+			const auto& boid = entities[i].GetComponent<BoidComponent>();
+			batch.positionsX[i] = transform.position.x;
+			batch.positionsY[i] = transform.position.y;
+			batch.velocitiesX[i] = rigidbody.velocity.x;
+			batch.velocitiesY[i] = rigidbody.velocity.y;
+			batch.flockIDs[i] = boid.flockID;
+			batch.maxSpeeds[i] = boid.maxSpeed;
+			batch.maxForces[i] = boid.maxForce;
+			batch.separationWeights[i] = boid.separationWeight;
+			batch.alignmentWeights[i] = boid.alignmentWeight;
+			batch.cohesionWeights[i] = boid.cohesionWeight;
+		}
+
+		grid.Build(batch, numAgents, neighbourRadius, &jobSystem);
+
+		jobSystem.ParallelFor(numAgents, FLOCKING_BATCH_SIZE, [this](int first, int last) {
+			PROFILE_SCOPE("FlockingSystem::ComputeSteering");
+			grid.ComputeSteering(batch, first, last, separationRadius);
+		});
+
+		for (int i = 0; i < numAgents; i++) {
+			const glm::vec2 steering(batch.steeringsX[i], batch.steeringsY[i]);
+			if (steering.x == 0.0f && steering.y == 0.0f) {
+				continue;
+			}
+
+			glm::vec2 velocity = glm::vec2(batch.velocitiesX[i], batch.velocitiesY[i]) + steering * static_cast<float>(deltaTime);
+			const float speedSquared = glm::dot(velocity, velocity);
+			if (speedSquared > batch.maxSpeeds[i] * batch.maxSpeeds[i]) {
+				velocity *= batch.maxSpeeds[i] / std::sqrt(speedSquared);
+			}
+			movementSystem.SetVelocity(entities[i], velocity);
+		}
+	}
+};
+
+#endif // !FLOCKINGSYSTEM_H
@@ -0,0 +1,53 @@
+#ifndef KEYBOARDCONTROLSYSTEM_H
+#define KEYBOARDCONTROLSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/KeyboardControlledComponent.h"
+#include "../Input/InputManager.h"
+#include "MovementSystem.h"
+#include <glm/glm.hpp>
+
+/// <summary>
+/// Steers the keyboard controlled entities with the movement actions of their player's input.
+/// The velocity only changes when a movement action is pressed or released, so the entities
+/// keep the velocity given by other systems while the player doesn't touch the keys.
+/// </summary>
+class KeyboardControlSystem : public System {
+public:
+	KeyboardControlSystem() {
+		RequireComponent<KeyboardControlledComponent>();
+		// the same components as the MovementSystem, so every steered entity is one of its bodies
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>();
+	}
+
+	// inputs holds the input of each player for the tick
+	void Update(const InputSnapshot* inputs, int numPlayers, MovementSystem& movementSystem) {
+		PROFILE_FUNCTION();
+
+		const uint32_t movementActions = (1u << ACTION_MOVE_UP) | (1u << ACTION_MOVE_DOWN) | (1u << ACTION_MOVE_LEFT) | (1u << ACTION_MOVE_RIGHT);
+		for (auto entity : GetSystemEntities()) {
+			const auto& keyboardControl = entity.GetComponent<KeyboardControlledComponent>();
+			if (keyboardControl.player < 0 || keyboardControl.player >= numPlayers) {
+				continue;
+			}
+			const InputSnapshot& input = inputs[keyboardControl.player];
+			if (((input.actionsPressed | input.actionsReleased) & movementActions) == 0) {
+				continue;
+			}
+
+			glm::vec2 direction(0);
+			direction.x = static_cast<float>(input.IsDown(ACTION_MOVE_RIGHT)) - static_cast<float>(input.IsDown(ACTION_MOVE_LEFT));
+			direction.y = static_cast<float>(input.IsDown(ACTION_MOVE_DOWN)) - static_cast<float>(input.IsDown(ACTION_MOVE_UP));
+			if (direction.x != 0.0f || direction.y != 0.0f) {
+				direction = glm::normalize(direction);
+			}
+			movementSystem.SetVelocity(entity, direction * keyboardControl.speed);
+		}
+	}
+};
+
+#endif // !KEYBOARDCONTROLSYSTEM_H
@@ -2,31 +2,282 @@
 #define MOVEMENTSYSTEM_H
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
+#include "../Collision/Broadphase.h"
+#include "../Physics/BodyBatch.h"
+#include <algorithm>
+#include <vector>
+
+// A body slower than this (pixels per second) for SLEEP_DELAY seconds falls asleep
+const float SLEEP_VELOCITY_THRESHOLD = 1.0f;
+const float SLEEP_DELAY = 0.5f;
 
 class MovementSystem : public System {
+private:
+	// Awake bodies packed together, so the update never walks over the sleeping ones
+	std::vector<Entity> awakeEntities;
+
+	// [vector index = entity ID], position in awakeEntities or -1 when the body sleeps
+	std::vector<int> awakeIndices;
+	// [vector index = entity ID], to wake bodies that are only known by their ID
+	std::vector<Entity> bodies;
+
+	// How far a body moved during the step it was last updated in, the collisions sweep it along this path
+	struct StepMotion {
+		glm::vec2 motion;
+		int stepNumber;
+	};
+	// [vector index = entity ID]
+	std::vector<StepMotion> stepMotions;
+	int stepNumber;
+
+	// Set when the entities were removed all at once, LoadState() then fills the tables again
+	bool areTablesEmptied;
+
+	// The step is split in substeps, so fast or strongly accelerated bodies stay accurate
+	int numSubsteps;
+	BodyBatch batch;
+
+	void ResizeTables(int numEntities) {
+		if (numEntities > static_cast<int>(bodies.size())) {
+			bodies.resize(numEntities, Entity(-1));
+			awakeIndices.resize(numEntities, -1);
+			stepMotions.resize(numEntities, StepMotion{ glm::vec2(0), 0 });
+		}
+	}
+
+	void RemoveFromAwake(int entityID) {
+		const int index = awakeIndices[entityID];
+		if (index < 0) {
+			return;
+		}
+		awakeEntities[index] = awakeEntities.back();
+		awakeIndices[awakeEntities[index].GetID()] = index;
+		awakeEntities.pop_back();
+		awakeIndices[entityID] = -1;
+	}
+
+protected:
+	void OnEntitiesRemapped(const std::vector<int>& newIDs) override {
+		for (auto& entity : awakeEntities) {
+			entity = RemapEntity(entity, newIDs);
+		}
+		RemapEntityVector(awakeIndices, newIDs, -1);
+		RemapEntityVector(stepMotions, newIDs, StepMotion{ glm::vec2(0), 0 });
+		RemapEntityVector(bodies, newIDs, Entity(-1));
+		for (auto& body : bodies) {
+			if (body.GetID() >= 0) {
+				body = RemapEntity(body, newIDs);
+			}
+		}
+	}
+
 public:
-	MovementSystem() {
+	MovementSystem(int numSubsteps = 1) {
 		RequireComponent<TransformComponent>();
 		RequireComponent<RigidBodyComponent>();
+		this->numSubsteps = numSubsteps > 0 ? numSubsteps : 1;
+		stepNumber = 0;
+		areTablesEmptied = false;
+	}
+
+	void AddEntityToSystem(Entity entity) override {
+		System::AddEntityToSystem(entity);
+
+		const int entityID = entity.GetID();
+		ResizeTables(entityID + 1);
+		bodies[entityID] = entity;
+		WakeUp(entity);
+	}
+
+	void RemoveEntityFromSystem(Entity entity) override {
+		System::RemoveEntityFromSystem(entity);
+		RemoveFromAwake(entity.GetID());
+		bodies[entity.GetID()] = Entity(-1);
+	}
+
+	void RemoveAllEntitiesFromSystem() override {
+		System::RemoveAllEntitiesFromSystem();
+		awakeEntities.clear();
+		std::fill(awakeIndices.begin(), awakeIndices.end(), -1);
+		std::fill(bodies.begin(), bodies.end(), Entity(-1));
+		areTablesEmptied = true;
+	}
+
+	// The awake bodies are saved in the order they are updated, the bodies by ID are rebuilt
+	void SaveState(BinaryWriter& writer) const override {
+		WriteEntityIDs(writer, awakeEntities);
+	}
+
+	// The bodies by ID only change with the entities, the awake ones are loaded every time
+	void LoadState(BinaryReader& reader) override {
+		if (areTablesEmptied) {
+			for (const auto& entity : GetSystemEntities()) {
+				const int entityID = entity.GetID();
+				ResizeTables(entityID + 1);
+				bodies[entityID] = entity;
+			}
+			areTablesEmptied = false;
+		}
+
+		// A rollback mostly restores the bodies that are already awake, in the same order, the list is then kept
+		BinaryReader awakeReader = reader;
+		bool isSame = true;
+		size_t numAwake = 0;
+		const bool isRead = ReadEntityIDs(awakeReader, static_cast<int>(bodies.size()), [&](int firstID, int count) {
+			for (int entityID = firstID; entityID < firstID + count; entityID++) {
+				isSame = isSame && numAwake < awakeEntities.size() && awakeEntities[numAwake].GetID() == entityID;
+				numAwake++;
+			}
+		});
+		if (isRead && isSame && numAwake == awakeEntities.size()) {
+			return;
+		}
+
+		for (const auto& entity : awakeEntities) {
+			awakeIndices[entity.GetID()] = -1;
+		}
+		awakeEntities.clear();
+		ReadEntityIDs(reader, static_cast<int>(bodies.size()), [&](int firstID, int count) {
+			for (int entityID = firstID; entityID < firstID + count; entityID++) {
+				if (bodies[entityID].GetID() < 0 || awakeIndices[entityID] >= 0) {
+					continue;
+				}
+				awakeIndices[entityID] = static_cast<int>(awakeEntities.size());
+				awakeEntities.push_back(bodies[entityID]);
+			}
+		});
 	}
 
-	// Logic that will be called frame by frame
+	// Entities that are not bodies of this system are ignored
+	void WakeUp(Entity entity) {
+		if (!IsBody(entity)) {
+			return;
+		}
+		auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+		rigidbody.isSleeping = false;
+		rigidbody.idleTime = 0.0f;
+
+		if (awakeIndices[entity.GetID()] < 0) {
+			awakeIndices[entity.GetID()] = static_cast<int>(awakeEntities.size());
+			awakeEntities.push_back(entity);
+		}
+	}
+
+	// Writes the velocity and wakes the body, so the new velocity is applied on the next update
+	void SetVelocity(Entity entity, glm::vec2 velocity) {
+		if (!IsBody(entity)) {
+			return;
+		}
+		entity.GetComponent<RigidBodyComponent>().velocity = velocity;
+		WakeUp(entity);
+	}
+
+	// The force is applied during the next step only, then it is cleared
+	void ApplyForce(Entity entity, glm::vec2 force) {
+		if (!IsBody(entity)) {
+			return;
+		}
+		entity.GetComponent<RigidBodyComponent>().force += force;
+		WakeUp(entity);
+	}
+
+	// Changes the velocity right away, in proportion of the mass
+	void ApplyImpulse(Entity entity, glm::vec2 impulse) {
+		if (!IsBody(entity)) {
+			return;
+		}
+		auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+		rigidbody.velocity += impulse * rigidbody.GetInverseMass();
+		WakeUp(entity);
+	}
+
+	// True when the entity was added to the system and not removed since
+	bool IsBody(Entity entity) const {
+		const int entityID = entity.GetID();
+		return entityID >= 0 && entityID < static_cast<int>(bodies.size()) && bodies[entityID].GetID() >= 0;
+	}
+
+	// Wakes the bodies that just started to touch something
+	void WakeUpColliding(const std::vector<CollisionPair>& collisions) {
+		for (const auto& collision : collisions) {
+			for (int entityID : { collision.entityA, collision.entityB }) {
+				if (IsBody(Entity(entityID)) && awakeIndices[entityID] < 0) {
+					WakeUp(bodies[entityID]);
+				}
+			}
+		}
+	}
+
+	int GetNumAwakeBodies() const {
+		return static_cast<int>(awakeEntities.size());
+	}
+
+	// The distance the body travelled during the last Update(), whatever its acceleration, damping,
+	// forces and substeps. Zero when it slept through it or is not a body.
+	glm::vec2 GetStepMotion(int entityID) const {
+		if (entityID < 0 || entityID >= static_cast<int>(stepMotions.size()) || stepMotions[entityID].stepNumber != stepNumber) {
+			return glm::vec2(0);
+		}
+		return stepMotions[entityID].motion;
+	}
+
+	// Advances the awake bodies by one physics step, with a fixed deltaTime so the result
+	// only depends on the number of steps and not on the frame rate
 	void Update(double deltaTime) {
-		// Loop all entities that the system is interested in
-		for (auto entity : GetSystemEntities()) {
-			// Update entity position based on its velocity every frame of the  game
+		PROFILE_FUNCTION();
+
+		stepNumber++;
+		const int numBodies = static_cast<int>(awakeEntities.size());
+		const float substepTime = static_cast<float>(deltaTime) / numSubsteps;
+
+		// Copy the awake bodies to the batch
+		batch.Resize(numBodies);
+		for (int i = 0; i < numBodies; i++) {
+			const Entity entity = awakeEntities[i];
+			const auto& transform = entity.GetComponent<TransformComponent>();
+			const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+			const glm::vec2 acceleration = rigidbody.acceleration + rigidbody.force * rigidbody.GetInverseMass();
+
+			batch.positionsX[i] = transform.position.x;
+			batch.positionsY[i] = transform.position.y;
+			batch.velocitiesX[i] = rigidbody.velocity.x;
+			batch.velocitiesY[i] = rigidbody.velocity.y;
+			batch.accelerationsX[i] = acceleration.x;
+			batch.accelerationsY[i] = acceleration.y;
+			batch.dampings[i] = 1.0f / (1.0f + substepTime * rigidbody.linearDamping);
+		}
+
+		IntegrateBodies(batch, numBodies, static_cast<float>(deltaTime), numSubsteps);
+
+		// Copy the results back, and put to sleep the bodies that stayed still long enough.
+		// The bodies are visited backwards, so a body that falls asleep is swapped with one already done.
+		const float sleepVelocitySquared = SLEEP_VELOCITY_THRESHOLD * SLEEP_VELOCITY_THRESHOLD;
+		for (int i = numBodies - 1; i >= 0; i--) {
+			const Entity entity = awakeEntities[i];
 			auto& transform = entity.GetComponent<TransformComponent>();
-			const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+			auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+
+			const glm::vec2 position(batch.positionsX[i], batch.positionsY[i]);
+			stepMotions[entity.GetID()] = { position - transform.position, stepNumber };
+			transform.position = position;
+			rigidbody.velocity = glm::vec2(batch.velocitiesX[i], batch.velocitiesY[i]);
+			rigidbody.force = glm::vec2(0);
 
-			transform.position.x += rigidbody.velocity.x * deltaTime;
-			transform.position.y += rigidbody.velocity.y * deltaTime;
+			// a body that is pushed or accelerated is never idle, even if it is slow right now
+			if (glm::dot(rigidbody.velocity, rigidbody.velocity) >= sleepVelocitySquared || batch.accelerationsX[i] != 0.0f || batch.accelerationsY[i] != 0.0f) {
+				rigidbody.idleTime = 0.0f;
+				continue;
+			}
 
-			Logger::Log("Entity ID = " + std::to_string(entity.GetID()) 
-				+ " position is not (" + std::to_string(transform.position.x) 
-				+ ", " + std::to_string(transform.position.y) + ")"
-			);
+			rigidbody.idleTime += static_cast<float>(deltaTime);
+			if (rigidbody.idleTime >= SLEEP_DELAY) {
+				rigidbody.isSleeping = true;
+				rigidbody.velocity = glm::vec2(0);
+				RemoveFromAwake(entity.GetID());
+			}
 		}
 	}
 };
@@ -2,6 +2,7 @@
 #define RENDERSYSTEM_H
 
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/SpriteComponent.h"
 #include "../AssetManager/AssetManager.h"
@@ -17,6 +18,8 @@ public:
 	}
 
 	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager) {
+		PROFILE_FUNCTION();
+
 		// sort all entities of the system by z-index
 		struct RenderableEntity {
 			TransformComponent transformComponent;
@@ -55,7 +58,7 @@ public:
 			// draw the PNG texture
 			SDL_RenderCopyEx(
 				renderer, 
-				assetManager->GetTexture(sprite.assetID),
+				assetManager->GetTexture(GetAssetID(sprite.assetHandle)),
 				&srcRect,
 				&dstRect,
 				transform.rotation,
@@ -0,0 +1,106 @@
+#ifndef RENDERTEXTSYSTEM_H
+#define RENDERTEXTSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TextLabelComponent.h"
+#include "../AssetManager/AssetManager.h"
+#include "../AssetManager/GlyphAtlas.h"
+#include <SDL.h>
+#include <unordered_map>
+
+class RenderTextSystem : public System {
+private:
+	// All the quads that use the same glyph atlas are drawn with a single call
+	struct TextBatch {
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	// Kept between frames so the vectors don't need to allocate again
+	std::unordered_map<GlyphAtlas*, TextBatch> batches;
+
+public:
+	RenderTextSystem() {
+		RequireComponent<TextLabelComponent>();
+	}
+
+	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetManager>& assetManager) {
+		PROFILE_FUNCTION();
+
+		for (auto& batch : batches) {
+			batch.second.vertices.clear();
+			batch.second.indices.clear();
+		}
+
+		const std::string* lastAssetID = nullptr;
+		GlyphAtlas* glyphAtlas = nullptr;
+
+		for (auto entity : GetSystemEntities()) {
+			const auto& textLabel = entity.GetComponent<TextLabelComponent>();
+
+			// consecutive labels usually share the same font
+			if (!lastAssetID || *lastAssetID != textLabel.assetID) {
+				glyphAtlas = assetManager->GetGlyphAtlas(textLabel.assetID);
+				lastAssetID = &textLabel.assetID;
+			}
+			if (!glyphAtlas) {
+				continue;
+			}
+
+			const TextLayout& layout = glyphAtlas->GetLayout(textLabel.text);
+			TextBatch& batch = batches[glyphAtlas];
+
+			// emit one quad per glyph, texture coordinates stay in pixels until the atlas size is final
+			for (const auto& quad : layout.quads) {
+				const int firstVertex = static_cast<int>(batch.vertices.size());
+				const float left = textLabel.position.x + quad.x;
+				const float top = textLabel.position.y + quad.y;
+				const float right = left + quad.width;
+				const float bottom = top + quad.height;
+				const float srcLeft = static_cast<float>(quad.srcRect.x);
+				const float srcTop = static_cast<float>(quad.srcRect.y);
+				const float srcRight = static_cast<float>(quad.srcRect.x + quad.srcRect.w);
+				const float srcBottom = static_cast<float>(quad.srcRect.y + quad.srcRect.h);
+
+				batch.vertices.push_back({ { left, top }, textLabel.color, { srcLeft, srcTop } });
+				batch.vertices.push_back({ { right, top }, textLabel.color, { srcRight, srcTop } });
+				batch.vertices.push_back({ { right, bottom }, textLabel.color, { srcRight, srcBottom } });
+				batch.vertices.push_back({ { left, bottom }, textLabel.color, { srcLeft, srcBottom } });
+
+				batch.indices.push_back(firstVertex);
+				batch.indices.push_back(firstVertex + 1);
+				batch.indices.push_back(firstVertex + 2);
+				batch.indices.push_back(firstVertex);
+				batch.indices.push_back(firstVertex + 2);
+				batch.indices.push_back(firstVertex + 3);
+			}
+		}
+
+		// draw each batch with a single call
+		for (auto& batch : batches) {
+			if (batch.second.indices.empty()) {
+				continue;
+			}
+
+			GlyphAtlas* atlas = batch.first;
+			const float inverseWidth = 1.0f / atlas->GetWidth();
+			const float inverseHeight = 1.0f / atlas->GetHeight();
+			for (auto& vertex : batch.second.vertices) {
+				vertex.tex_coord.x *= inverseWidth;
+				vertex.tex_coord.y *= inverseHeight;
+			}
+
+			SDL_RenderGeometry(
+				renderer,
+				atlas->GetTexture(renderer),
+				batch.second.vertices.data(),
+				static_cast<int>(batch.second.vertices.size()),
+				batch.second.indices.data(),
+				static_cast<int>(batch.second.indices.size())
+			);
+		}
+	}
+};
+
+#endif // !RENDERTEXTSYSTEM_H
@@ -0,0 +1,85 @@
+#ifndef SPATIALQUERYSYSTEM_H
+#define SPATIALQUERYSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Collision/SpatialIndex.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// Answers "which entities are near this point" for gameplay code, from the positions of the
+/// last Update(). The queries can run from several threads at the same time.
+/// </summary>
+class SpatialQuerySystem : public System {
+private:
+	// Built by the first query after the entities were loaded or remapped. A rollback loads a
+	// snapshot and simulates ticks again, their Update() builds it before anyone asks.
+	mutable SpatialIndex spatialIndex;
+	mutable std::vector<SpatialEntry> points;
+	mutable std::atomic<bool> isIndexOutdated;
+	mutable std::mutex buildMutex;
+
+	void Build() const {
+		PROFILE_FUNCTION();
+
+		const auto& entities = GetSystemEntities();
+		points.resize(entities.size());
+		for (size_t i = 0; i < entities.size(); i++) {
+			points[i] = { entities[i].GetID(), entities[i].GetComponent<TransformComponent>().position };
+		}
+		spatialIndex.Build(points);
+	}
+
+	// Only the first of the threads that query at once builds the index, the others wait for it
+	void BuildIfOutdated() const {
+		if (!isIndexOutdated.load(std::memory_order_acquire)) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(buildMutex);
+		if (isIndexOutdated.load(std::memory_order_relaxed)) {
+			Build();
+			isIndexOutdated.store(false, std::memory_order_release);
+		}
+	}
+
+protected:
+	// the index holds the old IDs, it is built again before the next query
+	void OnEntitiesRemapped(const std::vector<int>& /*newIDs*/) override {
+		isIndexOutdated.store(true, std::memory_order_release);
+	}
+
+public:
+	SpatialQuerySystem(float cellSize = DEFAULT_SPATIAL_INDEX_CELL_SIZE) : spatialIndex(cellSize), isIndexOutdated(false) {
+		RequireComponent<TransformComponent>();
+	}
+
+	void Update() {
+		Build();
+		isIndexOutdated.store(false, std::memory_order_release);
+	}
+
+	// The index is only derived from the positions, so it is not in the snapshots but built again
+	void LoadState(BinaryReader& /*reader*/) override {
+		isIndexOutdated.store(true, std::memory_order_release);
+	}
+
+	int QueryRadius(const glm::vec2& center, float radius, int* entityIDs, int maxResults) const {
+		BuildIfOutdated();
+		return spatialIndex.QueryRadius(center, radius, entityIDs, maxResults);
+	}
+
+	int QueryAABB(const AABB& bounds, int* entityIDs, int maxResults) const {
+		BuildIfOutdated();
+		return spatialIndex.QueryAABB(bounds, entityIDs, maxResults);
+	}
+
+	int QueryNearest(const glm::vec2& point, int k, int* entityIDs, float maxDistance = FLT_MAX) const {
+		BuildIfOutdated();
+		return spatialIndex.QueryNearest(point, k, entityIDs, maxDistance);
+	}
+};
+
+#endif // !SPATIALQUERYSYSTEM_H
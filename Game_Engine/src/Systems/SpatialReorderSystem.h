@@ -0,0 +1,78 @@
+#ifndef SPATIALREORDERSYSTEM_H
+#define SPATIALREORDERSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Components/TransformComponent.h"
+#include "../Utils/Morton.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Gives the entities new IDs in the Z-order of their position, so entities that are close in
+/// the world are also close in the component pools and the systems visit memory in order.
+/// Entities without a transform keep their relative order after the others.
+/// </summary>
+class SpatialReorderSystem : public System {
+private:
+	struct MortonKey {
+		uint32_t code;
+		int entityID;
+
+		bool operator < (const MortonKey& other) const { return code < other.code || (code == other.code && entityID < other.entityID); }
+	};
+
+	std::vector<MortonKey> keys;
+	std::vector<int> newIDs;
+
+public:
+	SpatialReorderSystem() {
+		RequireComponent<TransformComponent>();
+	}
+
+	// Reorders every entity of the registry, must run between ticks
+	void Update(Registry& registry) {
+		PROFILE_FUNCTION();
+
+		const auto& entities = GetSystemEntities();
+		if (entities.empty()) {
+			return;
+		}
+
+		glm::vec2 minPosition = entities[0].GetComponent<TransformComponent>().position;
+		glm::vec2 maxPosition = minPosition;
+		for (const auto& entity : entities) {
+			const glm::vec2 position = entity.GetComponent<TransformComponent>().position;
+			minPosition = glm::min(minPosition, position);
+			maxPosition = glm::max(maxPosition, position);
+		}
+
+		// quantize the positions to 16 bits per axis over the occupied area
+		const glm::vec2 extent = glm::max(maxPosition - minPosition, glm::vec2(1.0f));
+		const glm::vec2 scale = glm::vec2(65535.0f) / extent;
+
+		keys.clear();
+		for (const auto& entity : entities) {
+			const glm::vec2 cell = (entity.GetComponent<TransformComponent>().position - minPosition) * scale;
+			keys.push_back({ EncodeMorton(static_cast<uint32_t>(cell.x), static_cast<uint32_t>(cell.y)), entity.GetID() });
+		}
+		std::sort(keys.begin(), keys.end());
+
+		const int numEntities = registry.GetNumEntities();
+		newIDs.assign(numEntities, -1);
+		int nextID = 0;
+		for (const auto& key : keys) {
+			newIDs[key.entityID] = nextID++;
+		}
+		for (int entityID = 0; entityID < numEntities; entityID++) {
+			if (newIDs[entityID] < 0) {
+				newIDs[entityID] = nextID++;
+			}
+		}
+
+		registry.ReorderEntities(newIDs);
+	}
+};
+
+#endif // !SPATIALREORDERSYSTEM_H
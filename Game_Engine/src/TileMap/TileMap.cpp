@@ -0,0 +1,178 @@
+#include "TileMap.h"
+#include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+TileMap::TileMap() {
+	numCols = 0;
+	numRows = 0;
+	tileSize = 1.0f;
+	inverseTileSize = 1.0f;
+}
+
+bool TileMap::LoadMap(const std::string& filePath, int numCols, int numRows, float tileSize) {
+	std::ifstream mapFile(filePath);
+	if (!mapFile) {
+		Logger::Err("Could not open the map file " + filePath);
+		return false;
+	}
+
+	this->numCols = numCols;
+	this->numRows = numRows;
+	this->tileSize = tileSize;
+	this->inverseTileSize = 1.0f / tileSize;
+	tileIDs.assign(numCols * numRows, 0);
+
+	for (int row = 0; row < numRows; row++) {
+		for (int col = 0; col < numCols; col++) {
+			char tileRow, tileCol;
+			mapFile.get(tileRow);
+			mapFile.get(tileCol);
+			mapFile.ignore();
+			if (!mapFile) {
+				Logger::Err("The map file " + filePath + " has less tiles than expected");
+				return false;
+			}
+			tileIDs[row * numCols + col] = static_cast<uint8_t>((tileRow - '0') * TILESET_NUM_COLS + (tileCol - '0'));
+		}
+	}
+
+	UpdateSolidTiles();
+	return true;
+}
+
+void TileMap::SetSolidTileIDs(const std::vector<int>& tileIDs) {
+	solidTileIDs.reset();
+	for (int tileID : tileIDs) {
+		if (tileID >= 0 && tileID < MAX_TILE_IDS) {
+			solidTileIDs.set(tileID);
+		}
+	}
+	UpdateSolidTiles();
+}
+
+void TileMap::UpdateSolidTiles() {
+	solidTiles.assign((tileIDs.size() + 63) / 64, 0);
+	for (size_t index = 0; index < tileIDs.size(); index++) {
+		if (solidTileIDs.test(tileIDs[index])) {
+			solidTiles[index >> 6] |= uint64_t(1) << (index & 63);
+		}
+	}
+}
+
+bool TileMap::IsSolidAt(const glm::vec2& position) const {
+	return IsSolidTile(static_cast<int>(std::floor(position.x * inverseTileSize)), static_cast<int>(std::floor(position.y * inverseTileSize)));
+}
+
+bool TileMap::OverlapsSolid(const AABB& bounds) const {
+	// the max edge is excluded, a box that ends exactly on a tile border doesn't touch the next tile
+	const int minCol = static_cast<int>(std::floor(bounds.min.x * inverseTileSize));
+	const int minRow = static_cast<int>(std::floor(bounds.min.y * inverseTileSize));
+	const int maxCol = static_cast<int>(std::ceil(bounds.max.x * inverseTileSize)) - 1;
+	const int maxRow = static_cast<int>(std::ceil(bounds.max.y * inverseTileSize)) - 1;
+
+	for (int row = minRow; row <= maxRow; row++) {
+		for (int col = minCol; col <= maxCol; col++) {
+			if (IsSolidTile(col, row)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool TileMap::SweepAABB(const AABB& bounds, const glm::vec2& motion, SweepHit& hit) const {
+	// only the tiles under the swept area can be touched
+	const AABB sweptBounds = MergeAABB(bounds, { bounds.min + motion, bounds.max + motion });
+	const int minCol = std::max(static_cast<int>(std::floor(sweptBounds.min.x * inverseTileSize)), 0);
+	const int minRow = std::max(static_cast<int>(std::floor(sweptBounds.min.y * inverseTileSize)), 0);
+	const int maxCol = std::min(static_cast<int>(std::floor(sweptBounds.max.x * inverseTileSize)), numCols - 1);
+	const int maxRow = std::min(static_cast<int>(std::floor(sweptBounds.max.y * inverseTileSize)), numRows - 1);
+
+	hit.timeOfImpact = std::numeric_limits<float>::max();
+	SweepHit tileHit;
+	for (int row = minRow; row <= maxRow; row++) {
+		for (int col = minCol; col <= maxCol; col++) {
+			if (!IsSolidTile(col, row)) {
+				continue;
+			}
+
+			const AABB tileBounds = { glm::vec2(col, row) * tileSize, glm::vec2(col + 1, row + 1) * tileSize };
+			if (::SweepAABB(bounds, motion, tileBounds, tileHit) && tileHit.timeOfImpact < hit.timeOfImpact) {
+				hit = tileHit;
+			}
+		}
+	}
+	return hit.timeOfImpact <= 1.0f;
+}
+
+bool TileMap::Raycast(const TileRay& ray, TileRayHit& hit) const {
+	hit.isHit = false;
+
+	const float length = glm::length(ray.direction);
+	if (length <= 0.0f) {
+		return false;
+	}
+	const glm::vec2 direction = ray.direction / length;
+
+	// Amanatides & Woo: step to the next vertical or horizontal tile border, whichever is closest
+	int col = static_cast<int>(std::floor(ray.origin.x * inverseTileSize));
+	int row = static_cast<int>(std::floor(ray.origin.y * inverseTileSize));
+	const int stepCol = direction.x > 0.0f ? 1 : -1;
+	const int stepRow = direction.y > 0.0f ? 1 : -1;
+
+	const float infinity = std::numeric_limits<float>::infinity();
+	const float deltaX = direction.x != 0.0f ? std::fabs(tileSize / direction.x) : infinity;
+	const float deltaY = direction.y != 0.0f ? std::fabs(tileSize / direction.y) : infinity;
+	const float borderX = (stepCol > 0 ? col + 1 : col) * tileSize;
+	const float borderY = (stepRow > 0 ? row + 1 : row) * tileSize;
+	float nextX = direction.x != 0.0f ? (borderX - ray.origin.x) / direction.x : infinity;
+	float nextY = direction.y != 0.0f ? (borderY - ray.origin.y) / direction.y : infinity;
+
+	float distance = 0.0f;
+	glm::vec2 normal = glm::vec2(0);
+
+	while (distance <= ray.maxDistance) {
+		if (IsSolidTile(col, row)) {
+			hit.isHit = true;
+			hit.distance = distance;
+			hit.point = ray.origin + direction * distance;
+			hit.normal = normal;
+			hit.col = col;
+			hit.row = row;
+			return true;
+		}
+
+		// the ray can't come back once it left the map
+		if ((col < 0 && stepCol < 0) || (col >= numCols && stepCol > 0) || (row < 0 && stepRow < 0) || (row >= numRows && stepRow > 0)) {
+			return false;
+		}
+
+		if (nextX < nextY) {
+			distance = nextX;
+			nextX += deltaX;
+			col += stepCol;
+			normal = glm::vec2(static_cast<float>(-stepCol), 0.0f);
+		}
+		else {
+			distance = nextY;
+			nextY += deltaY;
+			row += stepRow;
+			normal = glm::vec2(0.0f, static_cast<float>(-stepRow));
+		}
+	}
+	return false;
+}
+
+void TileMap::RaycastBatch(const std::vector<TileRay>& rays, std::vector<TileRayHit>& hits) const {
+	PROFILE_FUNCTION();
+
+	// the whole solidity grid is a few kilobytes, so it stays in the cache for all the rays
+	hits.resize(rays.size());
+	for (size_t i = 0; i < rays.size(); i++) {
+		Raycast(rays[i], hits[i]);
+	}
+}
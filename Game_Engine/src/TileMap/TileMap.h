@@ -0,0 +1,88 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "../Collision/Broadphase.h"
+#include "../Collision/ContinuousCollision.h"
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Tile IDs are two digits in the map file: the row then the column of the tile in the tileset
+const int MAX_TILE_IDS = 100;
+const int TILESET_NUM_COLS = 10;
+
+/// <summary>
+/// A ray against the solid tiles, and where it stopped
+/// </summary>
+struct TileRay {
+	glm::vec2 origin;
+	glm::vec2 direction;
+	float maxDistance;
+};
+
+struct TileRayHit {
+	bool isHit;
+	float distance;
+	glm::vec2 point;
+	// Normal of the side of the tile that was hit
+	glm::vec2 normal;
+	int col;
+	int row;
+};
+
+/// <summary>
+/// Collision layer of the static terrain, kept out of the ECS: the tile IDs of the map in
+/// a dense grid, and one bit per tile telling if it is solid. Point queries are a single
+/// bit test, and rays walk the grid cell by cell (DDA) instead of testing entities.
+/// </summary>
+class TileMap {
+private:
+	int numCols;
+	int numRows;
+	// Size of a tile in world coordinates, once scaled
+	float tileSize;
+	float inverseTileSize;
+
+	// [vector index = row * numCols + col]
+	std::vector<uint8_t> tileIDs;
+	// Bit (row * numCols + col) is set when the tile is solid
+	std::vector<uint64_t> solidTiles;
+	std::bitset<MAX_TILE_IDS> solidTileIDs;
+
+	void UpdateSolidTiles();
+
+public:
+	TileMap();
+
+	// Reads the tile IDs of a map file, "RC" pairs separated by commas with one line per row
+	bool LoadMap(const std::string& filePath, int numCols, int numRows, float tileSize);
+	void SetSolidTileIDs(const std::vector<int>& tileIDs);
+
+	int GetNumCols() const { return numCols; }
+	int GetNumRows() const { return numRows; }
+	float GetTileSize() const { return tileSize; }
+	int GetTileID(int col, int row) const { return tileIDs[row * numCols + col]; }
+
+	// The outside of the map is never solid
+	bool IsSolidTile(int col, int row) const {
+		if (col < 0 || row < 0 || col >= numCols || row >= numRows) {
+			return false;
+		}
+		const int index = row * numCols + col;
+		return (solidTiles[index >> 6] >> (index & 63)) & 1;
+	}
+
+	bool IsSolidAt(const glm::vec2& position) const;
+	bool OverlapsSolid(const AABB& bounds) const;
+
+	// Moves bounds by motion and finds the first solid tile it touches on the way
+	bool SweepAABB(const AABB& bounds, const glm::vec2& motion, SweepHit& hit) const;
+
+	// direction does not need to be normalized, the distances are along the normalized direction
+	bool Raycast(const TileRay& ray, TileRayHit& hit) const;
+	void RaycastBatch(const std::vector<TileRay>& rays, std::vector<TileRayHit>& hits) const;
+};
+
+#endif // !TILEMAP_H
@@ -0,0 +1,177 @@
+#ifndef BINARYSTREAM_H
+#define BINARYSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Bytes gathered by a BinaryWriter before they are appended to its buffer
+const size_t BINARY_WRITER_BLOCK_SIZE = 4096;
+
+/// <summary>
+/// Appends values to a byte buffer, in native (little) endian. Only plain values are written
+/// byte for byte, anything that owns memory is written field by field. The small values are
+/// gathered in a block that is appended at once, the rest when the writer is destroyed.
+/// </summary>
+class BinaryWriter {
+private:
+	std::vector<uint8_t>& buffer;
+	uint8_t block[BINARY_WRITER_BLOCK_SIZE];
+	size_t blockSize;
+
+public:
+	BinaryWriter(std::vector<uint8_t>& buffer) : buffer(buffer), blockSize(0) {}
+
+	~BinaryWriter() {
+		Flush();
+	}
+
+	BinaryWriter(const BinaryWriter&) = delete;
+	BinaryWriter& operator = (const BinaryWriter&) = delete;
+
+	// Appends the gathered bytes to the buffer, without zeroing the new bytes first
+	void Flush() {
+		buffer.insert(buffer.end(), block, block + blockSize);
+		blockSize = 0;
+	}
+
+	size_t GetSize() const {
+		return buffer.size() + blockSize;
+	}
+
+	void WriteBytes(const void* bytes, size_t numBytes) {
+		if (blockSize + numBytes > BINARY_WRITER_BLOCK_SIZE) {
+			Flush();
+			if (numBytes > BINARY_WRITER_BLOCK_SIZE / 2) {
+				const uint8_t* first = static_cast<const uint8_t*>(bytes);
+				buffer.insert(buffer.end(), first, first + numBytes);
+				return;
+			}
+		}
+		if (numBytes > 0) {
+			std::memcpy(block + blockSize, bytes, numBytes);
+			blockSize += numBytes;
+		}
+	}
+
+	template <typename T>
+	void Write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written byte for byte");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	// Writes over a value written earlier, for sizes that are only known once what follows is written
+	template <typename T>
+	void WriteAt(size_t position, const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written byte for byte");
+		Flush();
+		std::memcpy(buffer.data() + position, &value, sizeof(T));
+	}
+
+	void WriteString(const std::string& value) {
+		Write(static_cast<uint32_t>(value.size()));
+		WriteBytes(value.data(), value.size());
+	}
+
+	// The count, then the values in one copy
+	template <typename T>
+	void WriteVector(const std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written byte for byte");
+		Write(static_cast<uint32_t>(values.size()));
+		WriteBytes(values.data(), values.size() * sizeof(T));
+	}
+};
+
+/// <summary>
+/// Reads back what a BinaryWriter wrote. Reading past the end fails instead of crashing,
+/// and every later read fails too, so the caller only checks IsValid() at the end.
+/// </summary>
+class BinaryReader {
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t position;
+	bool isValid;
+
+public:
+	BinaryReader(const uint8_t* data, size_t size) : data(data), size(size), position(0), isValid(true) {}
+
+	bool IsValid() const {
+		return isValid;
+	}
+
+	size_t GetPosition() const {
+		return position;
+	}
+
+	// For the values that were read fine but make no sense, every later read fails too
+	void SetInvalid() {
+		isValid = false;
+	}
+
+	bool ReadBytes(void* bytes, size_t numBytes) {
+		if (!isValid || numBytes > size - position) {
+			isValid = false;
+			return false;
+		}
+		if (numBytes > 0) {
+			std::memcpy(bytes, data + position, numBytes);
+		}
+		position += numBytes;
+		return true;
+	}
+
+	// Skips the bytes and returns where they are, nullptr when there are not enough of them
+	const uint8_t* SkipBytes(size_t numBytes) {
+		if (!isValid || numBytes > size - position) {
+			isValid = false;
+			return nullptr;
+		}
+		const uint8_t* bytes = data + position;
+		position += numBytes;
+		return bytes;
+	}
+
+	template <typename T>
+	bool Read(T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read byte for byte");
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	bool ReadString(std::string& value) {
+		uint32_t length = 0;
+		if (!Read(length)) {
+			return false;
+		}
+		const uint8_t* bytes = SkipBytes(length);
+		if (!bytes) {
+			return false;
+		}
+		value.assign(reinterpret_cast<const char*>(bytes), length);
+		return true;
+	}
+
+	// The vector keeps its capacity, it only allocates when it has to grow
+	template <typename T>
+	bool ReadVector(std::vector<T>& values) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read byte for byte");
+		uint32_t count = 0;
+		if (!Read(count)) {
+			return false;
+		}
+		const uint8_t* bytes = SkipBytes(static_cast<size_t>(count) * sizeof(T));
+		if (!bytes) {
+			return false;
+		}
+		values.resize(count);
+		if (count > 0) {
+			std::memcpy(values.data(), bytes, static_cast<size_t>(count) * sizeof(T));
+		}
+		return true;
+	}
+};
+
+#endif // !BINARYSTREAM_H
@@ -0,0 +1,114 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// Packs values on the number of bits they need into a fixed buffer, for the network packets.
+/// Writing past the end of the buffer fails instead of crashing, the caller checks
+/// IsOverflowed() or rewinds to a position it saved before writing a value that may not fit.
+/// </summary>
+class BitWriter {
+private:
+	uint8_t* data;
+	size_t capacity;
+	size_t numBitsWritten;
+	bool isOverflowed;
+
+public:
+	BitWriter(uint8_t* data, size_t capacity) : data(data), capacity(capacity), numBitsWritten(0), isOverflowed(false) {}
+
+	bool IsOverflowed() const {
+		return isOverflowed;
+	}
+
+	size_t GetNumBits() const {
+		return numBitsWritten;
+	}
+
+	size_t GetNumBytes() const {
+		return (numBitsWritten + 7) / 8;
+	}
+
+	// Writes the low numBits bits of value, up to 32
+	void WriteBits(uint32_t value, int numBits) {
+		while (numBits > 0) {
+			const size_t byteIndex = numBitsWritten >> 3;
+			const int bitOffset = static_cast<int>(numBitsWritten & 7);
+			if (byteIndex >= capacity) {
+				isOverflowed = true;
+				return;
+			}
+			if (bitOffset == 0) {
+				data[byteIndex] = 0;
+			}
+			const int numBitsInByte = std::min(8 - bitOffset, numBits);
+			data[byteIndex] |= static_cast<uint8_t>((value & ((1u << numBitsInByte) - 1)) << bitOffset);
+			value >>= numBitsInByte;
+			numBits -= numBitsInByte;
+			numBitsWritten += numBitsInByte;
+		}
+	}
+
+	void WriteBool(bool value) {
+		WriteBits(value ? 1 : 0, 1);
+	}
+
+	// Drops what was written after numBits, to take back a value that didn't fit
+	void Rewind(size_t numBits) {
+		if (numBits >= numBitsWritten) {
+			return;
+		}
+		numBitsWritten = numBits;
+		if (numBits & 7) {
+			data[numBits >> 3] &= static_cast<uint8_t>((1u << (numBits & 7)) - 1);
+		}
+		isOverflowed = false;
+	}
+};
+
+/// <summary>
+/// Reads back what a BitWriter wrote. Reading past the end fails instead of crashing,
+/// and every later read fails too, so the caller only checks IsValid() at the end.
+/// </summary>
+class BitReader {
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t numBitsRead;
+	bool isValid;
+
+public:
+	BitReader(const uint8_t* data, size_t size) : data(data), size(size), numBitsRead(0), isValid(true) {}
+
+	bool IsValid() const {
+		return isValid;
+	}
+
+	uint32_t ReadBits(int numBits) {
+		uint32_t value = 0;
+		int numBitsDone = 0;
+		while (numBitsDone < numBits) {
+			const size_t byteIndex = numBitsRead >> 3;
+			const int bitOffset = static_cast<int>(numBitsRead & 7);
+			if (!isValid || byteIndex >= size) {
+				isValid = false;
+				return 0;
+			}
+			const int numBitsInByte = std::min(8 - bitOffset, numBits - numBitsDone);
+			const uint32_t bits = (data[byteIndex] >> bitOffset) & ((1u << numBitsInByte) - 1);
+			value |= bits << numBitsDone;
+			numBitsDone += numBitsInByte;
+			numBitsRead += numBitsInByte;
+		}
+		return value;
+	}
+
+	bool ReadBool() {
+		return ReadBits(1) != 0;
+	}
+};
+
+#endif // !BITSTREAM_H
@@ -0,0 +1,91 @@
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// <summary>
+/// Bounded queue that many threads can push to and pop from without locks.
+/// Every cell has a sequence number that tells if it is ready to be written or read,
+/// so producers and consumers only compete on an atomic index.
+/// </summary>
+template <typename T, size_t Capacity>
+class LockFreeQueue {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "LockFreeQueue capacity must be a power of two");
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+
+	// Keep the indices on different cache lines, so producers and consumers don't slow down each other
+	alignas(64) std::atomic<size_t> pushPosition;
+	alignas(64) std::atomic<size_t> popPosition;
+
+public:
+	LockFreeQueue() : cells(new Cell[Capacity]) {
+		for (size_t i = 0; i < Capacity; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		pushPosition.store(0, std::memory_order_relaxed);
+		popPosition.store(0, std::memory_order_relaxed);
+	}
+
+	LockFreeQueue(const LockFreeQueue&) = delete;
+	LockFreeQueue& operator = (const LockFreeQueue&) = delete;
+
+	// Returns false if the queue is full, it never waits
+	bool Push(const T& item) {
+		size_t position = pushPosition.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = cells[position & (Capacity - 1)];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0) {
+				if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.data = item;
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0) {
+				return false;
+			}
+			else {
+				position = pushPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Returns false if the queue is empty, it never waits
+	bool Pop(T& item) {
+		size_t position = popPosition.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = cells[position & (Capacity - 1)];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+			if (difference == 0) {
+				if (popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					item = cell.data;
+					cell.sequence.store(position + Capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0) {
+				return false;
+			}
+			else {
+				position = popPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+};
+
+#endif // !LOCKFREEQUEUE_H
@@ -0,0 +1,21 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+#include <cstdint>
+
+// Spreads the 16 bits of value to the even bits of the result
+inline uint32_t SpreadMortonBits(uint32_t value) {
+	value &= 0x0000FFFF;
+	value = (value | (value << 8)) & 0x00FF00FF;
+	value = (value | (value << 4)) & 0x0F0F0F0F;
+	value = (value | (value << 2)) & 0x33333333;
+	value = (value | (value << 1)) & 0x55555555;
+	return value;
+}
+
+// Z-order curve: points close in 2D mostly get close codes, so sorting by code keeps neighbours together
+inline uint32_t EncodeMorton(uint32_t x, uint32_t y) {
+	return SpreadMortonBits(x) | (SpreadMortonBits(y) << 1);
+}
+
+#endif // !MORTON_H
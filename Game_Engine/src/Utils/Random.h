@@ -0,0 +1,65 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+/// <summary>
+/// Random numbers of the simulation (PCG32). Unlike rand(), the sequence only depends on the
+/// seed and the number of calls, on every platform, so a recorded session replays the same way.
+/// </summary>
+class Random {
+private:
+	uint64_t state;
+	uint64_t seed;
+
+public:
+	Random(uint64_t seed = 0) {
+		Seed(seed);
+	}
+
+	void Seed(uint64_t seed) {
+		this->seed = seed;
+		state = 0;
+		NextUInt();
+		state += seed;
+		NextUInt();
+	}
+
+	uint64_t GetSeed() const {
+		return seed;
+	}
+
+	// Position in the sequence, saved with the snapshots of the simulation
+	uint64_t GetState() const {
+		return state;
+	}
+
+	void SetState(uint64_t state) {
+		this->state = state;
+	}
+
+	uint32_t NextUInt() {
+		const uint64_t previousState = state;
+		state = previousState * 6364136223846793005ULL + 1442695040888963407ULL;
+		const uint32_t xorShifted = static_cast<uint32_t>(((previousState >> 18u) ^ previousState) >> 27u);
+		const uint32_t rotation = static_cast<uint32_t>(previousState >> 59u);
+		return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+	}
+
+	// In [0, 1)
+	float NextFloat() {
+		return static_cast<float>(NextUInt() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// In [min, max]
+	int Range(int min, int max) {
+		const uint32_t range = static_cast<uint32_t>(max - min) + 1;
+		return range == 0 ? static_cast<int>(NextUInt()) : min + static_cast<int>(NextUInt() % range);
+	}
+
+	float Range(float min, float max) {
+		return min + (max - min) * NextFloat();
+	}
+};
+
+#endif // !RANDOM_H
@@ -0,0 +1,14 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// SSE2 is always available on x64, and on x86 when the compiler targets it.
+// Code using the intrinsics keeps a scalar path for the other platforms.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+// Number of floats processed together by one SIMD instruction
+const int SIMD_WIDTH = 4;
+
+#endif // !SIMD_H